@@ -0,0 +1,75 @@
+#pragma once
+#ifndef COMPONENTPOOL_H
+#define COMPONENTPOOL_H
+
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief Fixed size block allocator backing the components of one type.
+	 *
+	 * Blocks are carved out of large slabs, so components of the same type that are loaded
+	 * together sit next to each other in memory. Freed blocks go on a free list and are
+	 * reused; once every block of the pool is free (e.g. a whole scene was torn down) all
+	 * slabs but the first are handed back to the heap at once. The first stays, so creating
+	 * and destroying a lone component over and over doesn't allocate.
+	 *
+	 * Components use it through the operator new/delete that SET_COMPONENT_TYPENAME declares,
+	 * so factories keep writing plain `new` and ISystem keeps owning them through unique_ptr.
+	 */
+	class ComponentPool {
+	public:
+		/**
+		 * \brief Gets the pool for a component type.
+		 *
+		 * A type gets one pool per object size, so a subclass that doesn't declare its own
+		 * type name still gets blocks of the right size. Pools are never destroyed.
+		 * \param[in] ComponentID type The type ID of the component
+		 * \param[in] size_t size The size of the component object
+		 * \return ComponentPool& The pool to allocate from
+		 */
+		DLL_EXPORT static ComponentPool& Get(ComponentID type, size_t size);
+
+		/**
+		 * \brief Allocates one block of this pool's size.
+		 *
+		 * \return void* The block, never null (throws std::bad_alloc like operator new)
+		 */
+		DLL_EXPORT void* Allocate();
+
+		/**
+		 * \brief Returns a block obtained from Allocate.
+		 *
+		 * \param[in] void* block The block to free; null is ignored
+		 */
+		DLL_EXPORT void Free(void* block);
+
+		size_t BlockSize() const { return this->blockSize; }
+		size_t LiveCount() const { return this->live; }
+		size_t SlabCount() const { return this->slabs.size(); }
+	private:
+		ComponentPool(size_t size);
+		ComponentPool(const ComponentPool&);
+		ComponentPool& operator=(const ComponentPool&);
+
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+
+		void AddSlab();
+		void ThreadSlab(char* slab, size_t blocks);
+		void ReleaseSlabs();
+
+		std::mutex lock;
+		size_t blockSize; // size rounded up to the alignment of any object
+		size_t slabBlocks; // number of blocks in the next slab, grows with each slab
+		size_t live; // blocks handed out and not yet freed
+		FreeBlock* freeList;
+		std::vector<char*> slabs;
+	};
+}
+
+#endif // COMPONENTPOOL_H
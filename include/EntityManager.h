@@ -0,0 +1,125 @@
+#pragma once
+#ifndef ENTITYMANAGER_H
+#define ENTITYMANAGER_H
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "ISystem.h"
+#include "Property.h"
+#include "Sigma.h"
+
+namespace Sigma {
+	class NoSuchEntityException : public std::runtime_error {
+	public:
+		NoSuchEntityException(id_t entityID)
+			: std::runtime_error("no entity " + std::to_string(entityID) + " in the current context") { }
+	};
+
+	class NoSuchContextException : public std::runtime_error {
+	public:
+		NoSuchContextException(unsigned int context)
+			: std::runtime_error("no context " + std::to_string(context)) { }
+	};
+
+	/**
+	 * \brief Tracks the entities of the running game, grouped into contexts.
+	 *
+	 * An entity ID holds an index into the entity table and the generation of that slot (see
+	 * EntityIndex). Deleting an entity bumps the generation of its slot, so an ID kept after its
+	 * entity was deleted no longer matches, even once the slot has been reused. Creating and
+	 * deleting entities is O(1); deleted slots are reused through a free list.
+	 *
+	 * A context (a level, a menu) owns the entities created while it is current. Only the entities
+	 * of the current context are visible to EntityExists, DeleteEntity and AddComponent, but IDs
+	 * are unique across contexts, as the systems store components of every context together.
+	 * Context 0 always exists.
+	 *
+	 * Not thread safe; use it from the thread running the systems.
+	 */
+	class EntityManager {
+	public:
+		typedef unsigned int ContextID;
+
+		/**
+		 * \brief Creates an empty context.
+		 *
+		 * \return ContextID The ID of the new context. It does not become current.
+		 */
+		DLL_EXPORT static ContextID CreateContext();
+
+		/**
+		 * \brief Makes a context current.
+		 *
+		 * \param[in] ContextID context The context to use.
+		 * \exception NoSuchContextException if the context was never created.
+		 */
+		DLL_EXPORT static void UseContext(ContextID context);
+
+		DLL_EXPORT static ContextID CurrentContext();
+
+		/**
+		 * \brief Creates an entity with a new ID in the current context.
+		 *
+		 * \return id_t The ID of the new entity.
+		 */
+		DLL_EXPORT static id_t CreateEntity();
+
+		/**
+		 * \brief Creates an entity with a given ID in the current context.
+		 *
+		 * Used for the entities of scene files, which bring their own IDs. The ID must carry the
+		 * generation its slot is at, so the ID of a deleted entity can't be created again.
+		 * \param[in] id_t entityID The ID of the new entity.
+		 * \return bool true if the ID was already in use (in any context), in which case nothing is created.
+		 * false if the entity was created, or if its slot is at another generation, in which case nothing is created and a warning is logged.
+		 */
+		DLL_EXPORT static bool CreateEntity(id_t entityID);
+
+		/**
+		 * \brief Checks whether an entity exists in the current context.
+		 *
+		 * \param[in] id_t entityID The entity to check. IDs of deleted entities don't exist, even if their slot was reused.
+		 * \return bool true if the entity exists.
+		 */
+		DLL_EXPORT static bool EntityExists(id_t entityID);
+
+		/**
+		 * \brief Deletes an entity of the current context and all its components.
+		 *
+		 * The components are removed from every system registered with RegisterSystem.
+		 * \param[in] id_t entityID The entity to delete.
+		 * \return bool true if the entity existed.
+		 */
+		DLL_EXPORT static bool DeleteEntity(id_t entityID);
+
+		/**
+		 * \brief Creates a component for an entity of the current context.
+		 *
+		 * \param[in] id_t entityID The entity the component belongs to.
+		 * \param[in] const std::string & type The component type, passed to FactorySystem::create.
+		 * \param[in] const std::vector<Property> & properties The properties of the component.
+		 * \return IComponent* The new component, nullptr if the factory couldn't create it.
+		 * \exception NoSuchEntityException if the entity doesn't exist in the current context.
+		 */
+		DLL_EXPORT static IComponent* AddComponent(id_t entityID, const std::string& type, const std::vector<Property>& properties);
+
+		/**
+		 * \brief The entities of the current context, in no particular order.
+		 */
+		DLL_EXPORT static const std::vector<id_t>& Entities();
+
+		/**
+		 * \brief Registers a system whose components are removed when their entity is deleted.
+		 *
+		 * \param[in] ISystemBase & system The system, which must stay alive until it is unregistered.
+		 */
+		DLL_EXPORT static void RegisterSystem(ISystemBase& system);
+
+		DLL_EXPORT static void UnregisterSystem(ISystemBase& system);
+	private:
+		EntityManager();
+	};
+}
+
+#endif // ENTITYMANAGER_H
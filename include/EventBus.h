@@ -0,0 +1,146 @@
+#pragma once
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include <atomic>
+#include <functional>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Sigma.h"
+#include "IComponent.h"
+
+// Gives an event struct its type name and its integer type ID, a hash of the name computed
+// at compile time like a component's, so the engine and a module built separately agree on it.
+#define SET_EVENT_TYPENAME(NAME)                                \
+static const char* getStaticEventTypeName() {return NAME;}\
+static SIGMA_CONSTEXPR Sigma::EventID getStaticEventTypeID() {return Sigma::ComponentTypeHash(NAME);}
+
+namespace Sigma {
+	typedef uint32_t EventID; // See SET_EVENT_TYPENAME
+
+	/**
+	 * \brief Carries typed events between systems, whatever thread they run on.
+	 *
+	 * Any thread can Publish an event at any time without taking a lock: each publishing
+	 * thread has its own queue, which only it pushes to. The events wait there until Dispatch
+	 * drains every queue in one batch and calls the handlers subscribed to each event type,
+	 * on the thread calling Dispatch. The main loop dispatches between frames, when no system
+	 * is running, so handlers can safely change any system.
+	 *
+	 * Events from one thread are handled in the order they were published; there is no order
+	 * between threads. Events published while Dispatch runs, e.g. by a handler, wait for the
+	 * next Dispatch.
+	 *
+	 * Event nodes are pooled per queue: Dispatch hands each handled node back to the queue
+	 * it came from, and the publishing thread reuses it for a later event of a similar size.
+	 *
+	 * Event types are structs declaring SET_EVENT_TYPENAME. Subscribe and Dispatch must be
+	 * called from one thread at a time, and Subscribe not while Dispatch runs.
+	 */
+	class EventBus {
+	public:
+		DLL_EXPORT EventBus();
+		DLL_EXPORT ~EventBus();
+
+		/**
+		 * \brief Queues an event for the next Dispatch. Lock free, from any thread.
+		 *
+		 * \param[in] const E & event The event, copied into the queue.
+		 */
+		template<typename E>
+		void Publish(const E& event) {
+			ProducerQueue* queue = QueueOfThisThread();
+			const unsigned int sizeClass = SizeClassOf(sizeof(TypedEvent<E>));
+			Push(queue, new (Allocate(queue, sizeof(TypedEvent<E>), sizeClass)) TypedEvent<E>(event, sizeClass));
+		}
+
+		/**
+		 * \brief Calls a handler for each dispatched event of a type.
+		 *
+		 * Handlers of a type are called in the order they subscribed.
+		 * \param[in] std::function<void(const E&)> handler The handler.
+		 */
+		template<typename E>
+		void Subscribe(std::function<void(const E&)> handler) {
+			AddHandler(E::getStaticEventTypeID(), [handler] (const void* event) { handler(*static_cast<const E*>(event)); });
+		}
+
+		/**
+		 * \brief Handles every event published so far.
+		 *
+		 * \return size_t The number of events handled.
+		 */
+		DLL_EXPORT size_t Dispatch();
+	private:
+		EventBus(const EventBus&);
+		EventBus& operator=(const EventBus&);
+
+		struct Event {
+			Event(EventID type, unsigned int sizeClass) : type(type), sizeClass(sizeClass), next(nullptr) { }
+			virtual ~Event() { }
+			virtual const void* Data() const = 0;
+			EventID type;
+			unsigned int sizeClass; // of its node, see SizeClassOf
+			std::atomic<Event*> next;
+		};
+
+		template<typename E>
+		struct TypedEvent : public Event {
+			TypedEvent(const E& event, unsigned int sizeClass) : Event(E::getStaticEventTypeID(), sizeClass), event(event) { }
+			const void* Data() const { return &this->event; }
+			E event;
+		};
+
+		struct Stub : public Event {
+			Stub() : Event(0, 0) { }
+			const void* Data() const { return nullptr; }
+		};
+
+		// Nodes of 64 bytes, doubling up to 2048; bigger events aren't pooled
+		static const unsigned int SIZE_CLASSES = 6;
+		static const size_t SMALLEST_NODE = 64;
+
+		// A free node, reused as raw memory
+		struct FreeNode {
+			FreeNode* next;
+		};
+
+		// A queue only one thread pushes to, a linked list ending at tail
+		struct ProducerQueue {
+			ProducerQueue(std::thread::id owner);
+			std::thread::id owner;
+			Stub stub; // the list starts with it, so it is never empty
+			Event* head; // the last event handled; only Dispatch touches it
+			std::atomic<Event*> tail; // the last event pushed; only the owner writes it
+			ProducerQueue* next; // in the list of queues
+			// Free nodes by size class. Only Dispatch pushes to returned; the owner takes
+			// them all at once when spare runs out, and only it touches spare.
+			std::atomic<FreeNode*> returned[SIZE_CLASSES];
+			FreeNode* spare[SIZE_CLASSES];
+		};
+
+		typedef std::function<void(const void*)> Handler;
+
+		static unsigned int SizeClassOf(size_t size) {
+			unsigned int sizeClass = 0;
+			while (sizeClass < SIZE_CLASSES && (SMALLEST_NODE << sizeClass) < size) {
+				++sizeClass;
+			}
+			return sizeClass; // SIZE_CLASSES if too big to pool
+		}
+
+		DLL_EXPORT static void* Allocate(ProducerQueue* queue, size_t size, unsigned int sizeClass);
+		static void Free(ProducerQueue* queue, Event* event);
+		DLL_EXPORT void Push(ProducerQueue* queue, Event* event);
+		DLL_EXPORT void AddHandler(EventID type, Handler handler);
+		DLL_EXPORT ProducerQueue* QueueOfThisThread();
+
+		const unsigned int serial; // tells the buses apart in each thread's cached queue
+		std::atomic<ProducerQueue*> queues; // newest first
+		std::unordered_map<EventID, std::vector<Handler>> handlers;
+	};
+}
+
+#endif // EVENTBUS_H
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef FIXEDSTEPCLOCK_H
+#define FIXEDSTEPCLOCK_H
+
+#include <stdint.h>
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief Turns variable frame times into a whole number of fixed simulation steps.
+	 *
+	 * Each frame Advance adds the frame's time and says how many steps of StepTime() the
+	 * simulation should run to catch up; the time left over, as a fraction of a step, is
+	 * Alpha(), which rendering uses to blend the last two simulated states. The simulation
+	 * then costs the same per simulated second however fast the main loop runs.
+	 *
+	 * When a frame would need more than the maximum number of steps, e.g. after a hitch, the
+	 * extra time is dropped and the simulation slows down instead of spiraling.
+	 */
+	class FixedStepClock {
+	public:
+		/**
+		 * \param[in] double rate The number of simulation steps per second.
+		 * \param[in] unsigned int maxSteps The most steps a single frame may run.
+		 */
+		DLL_EXPORT explicit FixedStepClock(double rate = 60.0, unsigned int maxSteps = 5);
+
+		/**
+		 * \brief Adds a frame's time and returns the number of steps to simulate.
+		 *
+		 * \param[in] double delta The time since the last frame in seconds.
+		 * \return unsigned int The number of steps, at most the maximum.
+		 */
+		DLL_EXPORT unsigned int Advance(double delta);
+
+		/**
+		 * \brief Changes the number of simulation steps per second.
+		 *
+		 * Time already accumulated carries over.
+		 */
+		DLL_EXPORT void SetRate(double rate);
+		void SetMaxSteps(unsigned int maxSteps) { this->maxSteps = maxSteps; }
+
+		// The length of a step in seconds
+		double StepTime() const { return this->step; }
+		// The steps returned by the last Advance
+		unsigned int Steps() const { return this->steps; }
+		// The steps run since the clock was made, to tell simulated states apart
+		uint64_t TotalSteps() const { return this->totalSteps; }
+		// How far the frame is past the last step, from 0 up to but excluding 1
+		float Alpha() const { return static_cast<float>(this->accumulator / this->step); }
+		// The time dropped by catching up at most the maximum number of steps, in seconds
+		double DroppedTime() const { return this->dropped; }
+	private:
+		double step;
+		unsigned int maxSteps;
+		double accumulator; // time not simulated yet, less than a step after Advance
+		unsigned int steps;
+		uint64_t totalSteps;
+		double dropped;
+	};
+}
+
+#endif // FIXEDSTEPCLOCK_H
@@ -0,0 +1,73 @@
+#pragma once
+#ifndef FRAMEALLOCATOR_H
+#define FRAMEALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief A bump allocator for scratch memory that lives for one frame.
+	 *
+	 * Allocating moves a pointer through a block; nothing is freed on its own, Reset releases
+	 * everything at once. When a frame needs more than the block holds, more blocks are
+	 * added, and the next Reset merges them so later frames fit in one block.
+	 *
+	 * Not thread safe; JobSystem keeps one per thread.
+	 */
+	class FrameAllocator {
+	public:
+		/**
+		 * \param[in] size_t capacity The size in bytes of the first block.
+		 */
+		DLL_EXPORT explicit FrameAllocator(size_t capacity = 64 * 1024);
+
+		/**
+		 * \brief Allocates uninitialized memory, valid until the next Reset.
+		 *
+		 * \param[in] size_t bytes The number of bytes.
+		 * \param[in] size_t alignment A power of two, 16 suits any scalar or SIMD type.
+		 * \return void* The memory.
+		 */
+		DLL_EXPORT void* Allocate(size_t bytes, size_t alignment = 16);
+
+		/**
+		 * \brief Allocates an array of count value-initialized Ts, valid until the next Reset.
+		 *
+		 * T's destructor is never called, so T should be trivially destructible.
+		 */
+		template <class T>
+		T* Allocate(size_t count) {
+			T* items = static_cast<T*>(Allocate(count * sizeof(T), std::alignment_of<T>::value));
+			for (size_t i = 0; i < count; ++i) {
+				new (items + i) T();
+			}
+			return items;
+		}
+
+		/**
+		 * \brief Releases everything allocated since the last Reset.
+		 */
+		DLL_EXPORT void Reset();
+
+		size_t Capacity() const { return this->capacity; }
+		size_t Used() const { return this->used; }
+	private:
+		FrameAllocator(const FrameAllocator&);
+		FrameAllocator& operator=(const FrameAllocator&);
+
+		void AddBlock(size_t bytes);
+
+		std::vector<std::unique_ptr<char[]>> blocks; // the last one is being filled
+		size_t blockSize; // of the last block
+		size_t offset; // into the last block
+		size_t capacity; // of all blocks
+		size_t used; // bytes handed out since the last Reset
+	};
+}
+
+#endif // FRAMEALLOCATOR_H
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <chrono>
+#include <functional>
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief Holds the main loop to a frame rate without keeping a core busy.
+	 *
+	 * Wait blocks until the next frame is due: it sleeps for most of the time, through a wait
+	 * function that can also wake up for OS events, then spins for the last moment to start
+	 * the frame on time. How long it spins follows how much the sleeps have overshot.
+	 *
+	 * With vsync on, swapping the buffers already waits for the display, so Wait only keeps
+	 * the loop from running faster than the refresh rate and never spins, which would only
+	 * risk missing a vertical blank.
+	 */
+	class FramePacer {
+	public:
+		typedef std::chrono::steady_clock Clock;
+		// Blocks for up to the given seconds, returning early is fine (e.g. on input events)
+		typedef std::function<void(double seconds)> WaitFunction;
+		// The current time, e.g. of a simulated clock in tests
+		typedef std::function<Clock::time_point()> NowFunction;
+
+		/**
+		 * \param[in] double rate The frames per second to hold to, 0 to not limit the rate.
+		 */
+		DLL_EXPORT explicit FramePacer(double rate = 60.0);
+
+		/**
+		 * \brief Waits until the next frame is due.
+		 *
+		 * Call once per frame, at the start of the frame. If a frame ran late by more than a
+		 * whole frame the schedule starts over, rather than running frames back to back to catch up.
+		 */
+		DLL_EXPORT void Wait();
+
+		/**
+		 * \brief Sets the frames per second, 0 to not limit the rate.
+		 */
+		DLL_EXPORT void SetRate(double rate);
+
+		/**
+		 * \brief Sets whether the buffer swap waits for the display's vertical blank.
+		 *
+		 * Set the rate to the display's refresh rate too.
+		 */
+		void SetVSync(bool vsync) { this->vsync = vsync; }
+
+		/**
+		 * \brief Sets how to sleep, e.g. OS::WaitEvents to handle input while idle.
+		 *
+		 * \param[in] WaitFunction wait The wait function, nullptr to just sleep.
+		 */
+		void SetWaitFunction(WaitFunction wait) { this->wait = wait; }
+
+		/**
+		 * \brief Sets the clock to pace by, and starts the schedule and the stats over.
+		 *
+		 * \param[in] NowFunction now The clock, nullptr for the steady clock.
+		 */
+		DLL_EXPORT void SetClock(NowFunction now);
+
+		// Seconds spent waiting in the last Wait
+		double LastIdle() const { return this->lastIdle; }
+		// Seconds spent waiting since the stats were reset
+		double IdleTime() const { return this->idle; }
+		// Seconds since the stats were reset
+		DLL_EXPORT double ElapsedTime() const;
+		// The part of the elapsed time spent waiting, from 0 to 1
+		DLL_EXPORT double IdleFraction() const;
+		DLL_EXPORT void ResetStats();
+	private:
+		Clock::time_point Now() const { return this->clockNow ? this->clockNow() : Clock::now(); }
+
+		std::chrono::duration<double> period; // zero when not limiting
+		bool vsync;
+		WaitFunction wait;
+		NowFunction clockNow; // nullptr for the steady clock
+		Clock::time_point next; // when the next frame is due
+		double spin; // seconds to spin before a deadline instead of sleeping
+
+		Clock::time_point statsStart;
+		double idle;
+		double lastIdle;
+	};
+}
+
+#endif // FRAMEPACER_H
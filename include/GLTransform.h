@@ -2,8 +2,15 @@
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
+#include "TransformStore.h"
 
 namespace Sigma {
+	/**
+	 * \brief A position, orientation and scale, relative to an optional parent transform.
+	 *
+	 * The data and the matrices live in the TransformStore, laid out for batch updates; a
+	 * GLTransform is a handle to its slot plus the Euler angles it was rotated by.
+	 */
 	class GLTransform {
 	public:
 
@@ -11,26 +18,36 @@ namespace Sigma {
 		const static glm::vec3 UP_VECTOR;
 		const static glm::vec3 RIGHT_VECTOR;
 
-		GLTransform() : orientation(glm::quat(1,0,0,0)), 
-						position(glm::vec3(0,0,0)), 
-						rotation(glm::vec3(0,0,0)), 
-						scale(glm::vec3(0,0,0)),
-						translateMatrix(glm::mat4(1.0f)),
-						rotateMatrix(glm::mat4(1.0f)),
-						scaleMatrix(glm::mat4(1.0f)),
-						Euler(false),
-						parentTransform(0) {}
+		GLTransform() : handle(TransformStore::Instance().Create()),
+						rotation(glm::vec3(0,0,0)),
+						maxRotation(glm::vec3(-1,-1,-1)), // unrestricted
+						Euler(false) {}
+
+		GLTransform(const GLTransform& other) : handle(TransformStore::Instance().Create()),
+						rotation(other.rotation),
+						maxRotation(other.maxRotation),
+						Euler(other.Euler) {
+			TransformStore::Instance().Copy(other.handle, this->handle);
+		}
+
+		GLTransform& operator=(const GLTransform& other) {
+			TransformStore::Instance().Copy(other.handle, this->handle);
+			this->rotation = other.rotation;
+			this->maxRotation = other.maxRotation;
+			this->Euler = other.Euler;
+			return *this;
+		}
+
+		~GLTransform() {
+			TransformStore::Instance().Destroy(this->handle);
+		}
 
 		void Translate(float x, float y, float z) {
-			this->position += glm::vec3(x, y, z);
-			this->translateMatrix = glm::translate(glm::mat4(1.0f), this->position);
-			this->MMhasChanged = true;
+			TranslateTo(GetPosition() + glm::vec3(x, y, z));
 		}
 
 		void TranslateTo(float x, float y, float z) {
-			this->position = glm::vec3(x, y, z);
-			this->translateMatrix = glm::translate(glm::vec3(x, y, z));
-			this->MMhasChanged = true;
+			TransformStore::Instance().SetPosition(this->handle, x, y, z);
 		}
 
 		// Helper functions.
@@ -45,21 +62,20 @@ namespace Sigma {
 		void Rotate(float x, float y, float z) {
 			this->rotation += glm::vec3(x, y, z);
 
+			glm::quat orientation;
 			if(this->Euler) {
-				this->rotateMatrix = glm::rotate(glm::mat4(1.0f), this->rotation.y, UP_VECTOR);
-				this->rotateMatrix = glm::rotate(this->rotateMatrix, this->rotation.x, RIGHT_VECTOR);
-				this->rotateMatrix = glm::rotate(this->rotateMatrix, this->rotation.z, FORWARD_VECTOR);
+				orientation = glm::angleAxis(this->rotation.y, UP_VECTOR) *
+					glm::angleAxis(this->rotation.x, RIGHT_VECTOR) *
+					glm::angleAxis(this->rotation.z, FORWARD_VECTOR);
 			}
 			else {
 				glm::quat qX = glm::angleAxis(x, RIGHT_VECTOR);
 				glm::quat qY = glm::angleAxis(y, UP_VECTOR);
 				glm::quat qZ = glm::angleAxis(z, FORWARD_VECTOR);
 				glm::quat change = qX * qY * qZ;
-				this->orientation = glm::normalize(change * this->orientation);
-				this->rotateMatrix = glm::mat4_cast(this->orientation);
+				orientation = glm::normalize(change * GetOrientation());
 			}
-		
-			this->MMhasChanged = true;
+			TransformStore::Instance().SetOrientation(this->handle, orientation.x, orientation.y, orientation.z, orientation.w);
 		}
 
 		void Rotate(glm::vec3 rot) {
@@ -67,9 +83,10 @@ namespace Sigma {
 		}
 
 		void Scale(float x, float y, float z) {
-			this->scale = this->scale*glm::vec3(x, y, z);
-			this->scaleMatrix = glm::scale(this->scaleMatrix, glm::vec3(x, y, z));
-			this->MMhasChanged = true;
+			TransformStore& store = TransformStore::Instance();
+			const TransformStore::Page& page = store.PageOf(this->handle);
+			const size_t slot = TransformStore::Slot(this->handle);
+			store.SetScale(this->handle, page.sx[slot] * x, page.sy[slot] * y, page.sz[slot] * z);
 		}
 
 		void Scale(glm::vec3 scale) {
@@ -92,19 +109,19 @@ namespace Sigma {
 
 		// NOTE:  These methods only work if the transform's scale is uniform
 		glm::vec3 GetRight() {
-			glm::mat4 currTransform = this->GetMatrix();
+			const glm::mat4& currTransform = this->GetMatrix();
 			glm::vec3 right_vector(currTransform[0][0], currTransform[0][1], currTransform[0][2]);
 			return glm::normalize(right_vector);
 		}
 	
 		glm::vec3 GetUp() {
-			glm::mat4 currTransform = this->GetMatrix();
+			const glm::mat4& currTransform = this->GetMatrix();
 			glm::vec3 up_vector(currTransform[1][0], currTransform[1][1], currTransform[1][2]);
 			return glm::normalize(up_vector);
 		}
 
 		glm::vec3 GetForward() {
-			glm::mat4 currTransform = this->GetMatrix();
+			const glm::mat4& currTransform = this->GetMatrix();
 			glm::vec3 back_vector(currTransform[2][0], currTransform[2][1], currTransform[2][2]);
 			return -1.0f * glm::normalize(back_vector);
 		}
@@ -126,17 +143,14 @@ namespace Sigma {
 			this->Move(vec.x, vec.y, vec.z);
 		}
 
+		/**
+		 * \brief Returns the world matrix, updating it and its parents' first if needed.
+		 *
+		 * Only composes and multiplies matrices that changed, so it is cheap to call repeatedly.
+		 * TransformStore::Update brings every transform up to date at once.
+		 */
 		const glm::mat4 GetMatrix() {
-			if (this->MMhasChanged) {
-				this->transformMatrix =  this->translateMatrix * this->rotateMatrix * this->scaleMatrix;
-				this->MMhasChanged = false;
-			}
-
-			if(this->parentTransform) {
-				return this->parentTransform->GetMatrix() * this->transformMatrix;
-			}
-
-			return this->transformMatrix;
+			return glm::make_mat4(TransformStore::Instance().GetWorldMatrix(this->handle));
 		}
 
 		const glm::mat4 GetMatrixInverse() {
@@ -144,7 +158,9 @@ namespace Sigma {
 		}
 
 		const glm::vec3 GetPosition() const {
-			return this->position;
+			const TransformStore::Page& page = TransformStore::Instance().PageOf(this->handle);
+			const size_t slot = TransformStore::Slot(this->handle);
+			return glm::vec3(page.px[slot], page.py[slot], page.pz[slot]);
 		}
 
 		/**
@@ -154,7 +170,7 @@ namespace Sigma {
 		 * \returns the vec3 position vector
 		 */
 		glm::vec3 ExtractPosition() {
-			glm::mat4 matrix = this->GetMatrix();
+			const glm::mat4& matrix = this->GetMatrix();
 
 			return glm::vec3(matrix[3][0], matrix[3][1], matrix[3][2]);
 		}
@@ -166,12 +182,14 @@ namespace Sigma {
 		 * \returns the vec3 direction vector
 		 */
 		glm::vec3 ExtractDirection() {
-			glm::mat4 curTransform = this->GetMatrix();
+			const glm::mat4& curTransform = this->GetMatrix();
 			return -1.0f * glm::normalize(glm::vec3(curTransform[2][0], curTransform[2][1], curTransform[2][2]));
 		}
 
 		const glm::quat GetOrientation() const {
-			return this->orientation;
+			const TransformStore::Page& page = TransformStore::Instance().PageOf(this->handle);
+			const size_t slot = TransformStore::Slot(this->handle);
+			return glm::quat(page.qw[slot], page.qx[slot], page.qy[slot], page.qz[slot]);
 		}
 
 		void SetEuler(const bool euler) {
@@ -232,24 +250,51 @@ namespace Sigma {
 			return rot;
 		}
 
-		void SetParentTransform(GLTransform *trans) { this->parentTransform = trans; }
-
-	private:
-		glm::quat orientation;
-		glm::vec3 position;
-		glm::vec3 rotation;
-		glm::vec3 scale;
+		void SetParentTransform(GLTransform *trans) {
+			TransformStore::Instance().SetParent(this->handle, trans ? trans->handle : TransformStore::NONE);
+		}
 
-		glm::mat4 transformMatrix;
-		glm::mat4 scaleMatrix;
-		glm::mat4 rotateMatrix;
-		glm::mat4 translateMatrix;
+		TransformStore::Handle GetHandle() const { return this->handle; }
 
+	private:
+		TransformStore::Handle handle; // position, orientation, scale and matrices in the TransformStore
+		glm::vec3 rotation; // the Euler angles rotated by so far
 		glm::vec3 maxRotation;
-
-		GLTransform *parentTransform;
-
-		bool MMhasChanged; // Set to true if the modelMatrix has changed and needs to be updated
 		bool Euler; // Set to true to toggle rotation matrix construction between quaternions and euler angles
 	};
+
+	/**
+	 * \brief Blends two model matrices, e.g. the last two simulated states of a transform.
+	 *
+	 * Translation and scale are blended linearly and rotation spherically, so the result stays
+	 * a rotation, translation and scale, unlike blending the matrices element by element.
+	 * \param[in] const glm::mat4 & from The matrix at alpha 0.
+	 * \param[in] const glm::mat4 & to The matrix at alpha 1.
+	 * \param[in] float alpha How far to blend, from 0 to 1.
+	 * \return glm::mat4 The blended matrix.
+	 */
+	inline glm::mat4 InterpolateMatrix(const glm::mat4& from, const glm::mat4& to, float alpha) {
+		if (from == to) {
+			return to; // the common case of something that didn't move
+		}
+		glm::vec3 fromScale(glm::length(glm::vec3(from[0])), glm::length(glm::vec3(from[1])), glm::length(glm::vec3(from[2])));
+		glm::vec3 toScale(glm::length(glm::vec3(to[0])), glm::length(glm::vec3(to[1])), glm::length(glm::vec3(to[2])));
+		if (fromScale.x == 0.0f || fromScale.y == 0.0f || fromScale.z == 0.0f ||
+				toScale.x == 0.0f || toScale.y == 0.0f || toScale.z == 0.0f) {
+			return alpha < 0.5f ? from : to; // no rotation to blend
+		}
+
+		glm::mat4 fromRotation = from, toRotation = to;
+		for (int c = 0; c < 3; ++c) {
+			fromRotation[c] = fromRotation[c] * (1.0f / fromScale[c]);
+			toRotation[c] = toRotation[c] * (1.0f / toScale[c]);
+		}
+		glm::mat4 blended = glm::mat4_cast(glm::slerp(glm::quat_cast(fromRotation), glm::quat_cast(toRotation), alpha));
+		glm::vec3 scale = glm::mix(fromScale, toScale, alpha);
+		for (int c = 0; c < 3; ++c) {
+			blended[c] = blended[c] * scale[c];
+		}
+		blended[3] = glm::mix(from[3], to[3], alpha);
+		return blended;
+	}
 }
@@ -8,7 +8,8 @@
 namespace Sigma{
 	class IBulletShape : public IComponent {
 	public:
-		IBulletShape(const id_t entityID = 0) : IComponent(entityID) { }
+		IBulletShape(const id_t entityID = 0)
+			: IComponent(entityID), shape(nullptr), body(nullptr), motionState(nullptr) { }
 		virtual ~IBulletShape() {
 			if (this->body != nullptr) {
 				delete this->body;
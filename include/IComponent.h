@@ -4,19 +4,41 @@
 
 #include <string>
 #include "Sigma.h"
+#include "ComponentPool.h"
 
-#define SET_COMPONENT_TYPENAME(ID)                                \
-static const Sigma::IComponent::ComponentID getStaticComponentTypeName() {return ID;}\
-virtual const Sigma::IComponent::ComponentID getComponentTypeName() override{return getStaticComponentTypeName();}
+// Gives a component class its type name (used for scene files and logging) and its
+// integer type ID (used for all lookups), which is a hash of the name computed at compile time.
+// Heap allocated components of the class come from the ComponentPool of that type.
+#define SET_COMPONENT_TYPENAME(NAME)                                \
+static const char* getStaticComponentTypeName() {return NAME;}\
+static SIGMA_CONSTEXPR Sigma::IComponent::ComponentID getStaticComponentTypeID() {return Sigma::ComponentTypeHash(NAME);}\
+virtual const char* getComponentTypeName() override{return getStaticComponentTypeName();}\
+virtual Sigma::IComponent::ComponentID getComponentTypeID() override{return getStaticComponentTypeID();}\
+static void* operator new(size_t size) {return Sigma::ComponentPool::Get(getStaticComponentTypeID(), size).Allocate();}\
+static void operator delete(void* p, size_t size) {Sigma::ComponentPool::Get(getStaticComponentTypeID(), size).Free(p);}
 
 namespace Sigma{
+    /**
+     * \brief Hashes a component type name into a component type ID.
+     *
+     * 32 bit FNV-1a, written as a single expression so it can be evaluated at compile time.
+     * \param[in] const char* name The type name to hash
+     * \param[in] uint32_t hash The hash of the characters before name
+     * \return ComponentID The type ID for name
+     */
+    inline SIGMA_CONSTEXPR ComponentID ComponentTypeHash(const char* name, uint32_t hash = 2166136261u) {
+        return (*name == '\0') ? hash :
+            ComponentTypeHash(name + 1, (hash ^ static_cast<uint32_t>(static_cast<unsigned char>(*name))) * 16777619u);
+    }
+
     class IComponent {
     public:
-        typedef std::string ComponentID;
+        typedef Sigma::ComponentID ComponentID;
         IComponent(const id_t id = 0) : entityID(id) {}
         virtual ~IComponent() {}
         int GetEntityID() { return this->entityID; }
-        virtual const ComponentID getComponentTypeName()=0;
+        virtual const char* getComponentTypeName()=0;
+        virtual ComponentID getComponentTypeID()=0;
     private:
         const id_t entityID; // The entity that owns this component.
 
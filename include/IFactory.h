@@ -14,6 +14,7 @@ namespace Sigma {
     public:
         typedef std::function<IComponent*(const id_t,
                                     const std::vector<Property>&)> FactoryFunction;
+        typedef std::function<void(const std::vector<Property>&)> PreloadFunction;
         IFactory(){};
         virtual ~IFactory(){};
         /**
@@ -24,6 +25,20 @@ namespace Sigma {
          */
         virtual std::map<std::string,FactoryFunction>
                 getFactoryFunctions() = 0;
+
+        /**
+         * \brief Returns the functions that prepare the resources of a component type
+         *
+         * A preload function is called with the same properties as the factory function,
+         * on a worker thread, before the component is created. It does the slow CPU work
+         * (file I/O, parsing, decoding) into caches the factory function reads, and must not
+         * touch the OpenGL or OpenAL context or the system's components.
+         * \return std::map<std::string, PreloadFunction> Preload functions by component type, empty by default
+         */
+        virtual std::map<std::string,PreloadFunction>
+                getPreloadFunctions() {
+            return std::map<std::string,PreloadFunction>();
+        }
     protected:
     private:
     };
@@ -12,6 +12,7 @@
 #include "systems/GLSLShader.h"
 #include <unordered_map>
 #include <memory>
+#include <cstring>
 #include "Sigma.h"
 
 namespace Sigma {
@@ -50,6 +51,10 @@ namespace Sigma {
             tr = 1.0f;
             hardness = 64.0f;
             illum = 1;
+            ambientMap = 0;
+            diffuseMap = 0;
+            specularMap = 0;
+            normalMap = 0;
         }
         float ka[3];
         float kd[3];
@@ -69,9 +74,13 @@ namespace Sigma {
 		SET_COMPONENT_TYPENAME("IGLComponent");
 
 		IGLComponent()
-			: lightingEnabled(true), SpatialComponent(0) {} // Default ctor setting entity ID to 0.
+			: lightingEnabled(true), SpatialComponent(0), vao(0) { // Default ctor setting entity ID to 0.
+			memset(this->buffers, 0, sizeof(this->buffers));
+		}
 		IGLComponent(const id_t entityID)
-			: lightingEnabled(true), SpatialComponent(entityID) {} // Ctor that sets the entity ID.
+			: lightingEnabled(true), SpatialComponent(entityID), vao(0) { // Ctor that sets the entity ID.
+			memset(this->buffers, 0, sizeof(this->buffers));
+		}
 
         typedef std::unordered_map<std::string, std::shared_ptr<GLSLShader>> ShaderMap;
 
@@ -82,6 +91,14 @@ namespace Sigma {
 		 */
 		virtual void InitializeBuffers() = 0;
 
+		/**
+		 * \brief Deletes the buffers and VAO made by InitializeBuffers.
+		 *
+		 * Must be called on the thread owning the OpenGL context. OpenGLSystem calls it when the
+		 * component is removed.
+		 */
+		virtual void DeleteBuffers();
+
 		/**
 		 * \brief Retrieves the specified buffer.
 		 *
@@ -114,6 +131,50 @@ namespace Sigma {
 		 */
 		virtual void Render(glm::mediump_float *view, glm::mediump_float *proj)=0;
 
+		/**
+		 * \brief Renders the component once for each model matrix in the bound ObjectData block.
+		 *
+		 * OpenGLSystem only calls it with more than one instance for components InstancesWith
+		 * matched, drawing them all with the first one; the default renders one instance.
+		 * \param view The current view matrix
+		 * \param proj The current project matrix
+		 * \param instances The number of instances, at most MAX_INSTANCES (see UniformBlocks.h)
+		 */
+		virtual void RenderInstances(glm::mediump_float *view, glm::mediump_float *proj, unsigned int instances) { Render(view, proj); }
+
+		/**
+		 * \brief Whether another component's draw can be made as an instance of this one's.
+		 *
+		 * That is if rendering this component with the other's model matrix draws the other.
+		 * \param other The other component
+		 * \return bool false by default, so each component is drawn by itself.
+		 */
+		virtual bool InstancesWith(const IGLComponent& other) const { return false; }
+
+		/**
+		 * \brief Sets the model matrix the next Render draws with.
+		 *
+		 * OpenGLSystem sets it from the frame's RenderSnapshot, so rendering never reads the
+		 * transform while the simulation may be moving it.
+		 * \param matrix The model matrix
+		 */
+		void SetModelMatrix(const glm::mat4& matrix) { this->modelMatrix = matrix; }
+
+		/**
+		 * \brief Returns the model matrix to draw with, which OpenGLSystem puts in the draw's ObjectData block.
+		 *
+		 * \param view The current view matrix, for components placed relative to the camera
+		 * \return glm::mat4 The model matrix, by default the one set with SetModelMatrix.
+		 */
+		virtual glm::mat4 DrawMatrix(const glm::mat4& view) const { return this->modelMatrix; }
+
+		/**
+		 * \brief Identifies the material drawn with, to group draws sharing it (see RenderQueue).
+		 *
+		 * \return unsigned int e.g. the main texture's ID, 0 for no material.
+		 */
+		virtual unsigned int MaterialKey() const { return 0; }
+
 		/**
 		 * \brief Return the VAO ID of this component.
 		 *
@@ -164,6 +225,7 @@ namespace Sigma {
 		unsigned int vao; // The VAO that describes this component's data.
 		unsigned int drawMode; // The current draw mode (ex. GL_TRIANGLES, GL_TRIANGLE_STRIP).
 		GLuint cull_face; // The current culling method for this component.
+		glm::mat4 modelMatrix; // The model matrix to render with, see SetModelMatrix.
 
         std::shared_ptr<GLSLShader> shader; // shaders are shared among components
         // name-->shader map to look up already-loaded shaders (so each can be loaded only once)
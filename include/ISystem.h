@@ -2,6 +2,7 @@
 #define ISYSTEM_H
 
 #include <unordered_map>
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <iostream>
@@ -9,49 +10,431 @@
 #include "Sigma.h"
 
 namespace Sigma {
+    /**
+     * \brief Packed storage for all the components of one type.
+     *
+     * A sparse set: the components live in a dense array that can be walked front to back,
+     * and a paged index maps an entity ID to its slot in the dense array in O(1).
+     * Components are owned through unique_ptr, so a pointer returned by get() or insert()
+     * stays valid while other components are added to or removed from the store.
+     *
+     * The index is keyed by the entity's index (see EntityIndex), so a store holds one
+     * generation of each entity index and looking up a stale generation finds nothing.
+     */
     template<typename T>
-    class ISystem {
-        typedef std::unordered_map< IComponent::ComponentID,
-                                    std::unique_ptr<T>> ComponentMap;
-        typedef std::unordered_map<id_t,ComponentMap> EntityComponentMap;
+    class ComponentStore {
+        enum : uint32_t {
+            PAGE_BITS = 10,
+            PAGE_SIZE = 1 << PAGE_BITS,
+            MAX_PAGES = 1024, // IDs past MAX_PAGES * PAGE_SIZE go to the overflow map
+            INVALID_SLOT = 0xFFFFFFFF
+        };
+        typedef std::vector<std::unique_ptr<T>> ComponentVector;
         public:
-            ISystem() {};
+            typedef typename ComponentVector::iterator iterator;
+            typedef typename ComponentVector::const_iterator const_iterator;
+
+            ComponentStore() {}
+            ComponentStore(ComponentStore&& other)
+                : pages(std::move(other.pages)), overflow(std::move(other.overflow)),
+                components(std::move(other.components)), entities(std::move(other.entities)) {}
+
+            /**
+             * \brief Retrieves the component of the given entity
+             *
+             * \param[in] id_t EntityID the entity to look up
+             * \return T* the component or nullptr if the entity has none in this store
+             */
+            T* get(id_t EntityID) const {
+                uint32_t slot = findSlot(EntityID);
+                return (slot != INVALID_SLOT) ? this->components[slot].get() : nullptr;
+            }
+
+            /**
+             * \brief Retrieves the component in the given entity's index slot, whatever its generation
+             *
+             * \param[in] id_t EntityID the entity whose index is looked up
+             * \return T* the component insert() would replace, or nullptr if there is none
+             */
+            T* occupant(id_t EntityID) const {
+                uint32_t slot = findIndexSlot(EntityID);
+                return (slot != INVALID_SLOT) ? this->components[slot].get() : nullptr;
+            }
+
+            /**
+             * \brief Stores a component for the given entity
+             *
+             * The component already in the entity index's slot, of this generation of the
+             * entity or a stale one, is replaced. It is handed to Displaced if given, else destroyed.
+             * \param[in] id_t EntityID the entity the component belongs to
+             * \param[in] std::unique_ptr<T> Component the component to take ownership of
+             * \param[out] std::unique_ptr<T>* Displaced receives the replaced component, if any
+             * \return T* the stored component
+             */
+            T* insert(id_t EntityID, std::unique_ptr<T> Component, std::unique_ptr<T>* Displaced = nullptr) {
+                uint32_t& slot = slotFor(EntityID);
+                if (slot != INVALID_SLOT) {
+                    if (this->components[slot].get() == Component.get()) {
+                        Component.release(); // already stored, don't destroy it
+                    }
+                    else {
+                        if (Displaced) {
+                            *Displaced = std::move(this->components[slot]);
+                        }
+                        this->components[slot] = std::move(Component);
+                    }
+                    this->entities[slot] = EntityID; // a stale generation is replaced too
+                }
+                else {
+                    slot = static_cast<uint32_t>(this->components.size());
+                    this->components.push_back(std::move(Component));
+                    this->entities.push_back(EntityID);
+                }
+                return this->components[slot].get();
+            }
+
+            /**
+             * \brief Takes the component of the given entity out of the store
+             *
+             * The last component is moved into the hole, so this is O(1) but changes the
+             * iteration order.
+             * \param[in] id_t EntityID the entity whose component is removed
+             * \return std::unique_ptr<T> the component, or nullptr if the entity has none in this store
+             */
+            std::unique_ptr<T> remove(id_t EntityID) {
+                uint32_t slot = findSlot(EntityID);
+                if (slot == INVALID_SLOT) {
+                    return std::unique_ptr<T>();
+                }
+                std::unique_ptr<T> removed = std::move(this->components[slot]);
+                uint32_t last = static_cast<uint32_t>(this->components.size() - 1);
+                if (slot != last) {
+                    this->components[slot] = std::move(this->components[last]);
+                    this->entities[slot] = this->entities[last];
+                    slotFor(this->entities[slot]) = slot;
+                }
+                this->components.pop_back();
+                this->entities.pop_back();
+                clearSlot(EntityID);
+                return removed;
+            }
+
+            size_t size() const { return this->components.size(); }
+            bool empty() const { return this->components.empty(); }
+
+            /**
+             * \brief The entity owning the component in the given dense slot
+             */
+            id_t entityAt(size_t index) const { return this->entities[index]; }
+
+            iterator begin() { return this->components.begin(); }
+            iterator end() { return this->components.end(); }
+            const_iterator begin() const { return this->components.begin(); }
+            const_iterator end() const { return this->components.end(); }
+        private:
+            ComponentStore(const ComponentStore&);
+            ComponentStore& operator=(const ComponentStore&);
+
+            uint32_t findSlot(id_t EntityID) const {
+                uint32_t slot = findIndexSlot(EntityID);
+                // The slot may hold another generation of the entity index
+                return (slot != INVALID_SLOT && this->entities[slot] == EntityID) ? slot : static_cast<uint32_t>(INVALID_SLOT);
+            }
+
+            uint32_t findIndexSlot(id_t EntityID) const {
+                id_t index = EntityIndex(EntityID);
+                uint32_t page = index >> PAGE_BITS;
+                uint32_t slot = INVALID_SLOT;
+                if (page < MAX_PAGES) {
+                    if (page < this->pages.size() && this->pages[page]) {
+                        slot = this->pages[page][index & (PAGE_SIZE - 1)];
+                    }
+                }
+                else {
+                    auto found = this->overflow.find(index);
+                    if (found != this->overflow.end()) {
+                        slot = found->second;
+                    }
+                }
+                return slot;
+            }
+
+            void clearSlot(id_t EntityID) {
+                id_t index = EntityIndex(EntityID);
+                if ((index >> PAGE_BITS) < MAX_PAGES) {
+                    this->pages[index >> PAGE_BITS][index & (PAGE_SIZE - 1)] = INVALID_SLOT;
+                }
+                else {
+                    this->overflow.erase(index);
+                }
+            }
+
+            uint32_t& slotFor(id_t EntityID) {
+                id_t index = EntityIndex(EntityID);
+                uint32_t page = index >> PAGE_BITS;
+                if (page < MAX_PAGES) {
+                    if (page >= this->pages.size()) {
+                        this->pages.resize(page + 1);
+                    }
+                    if (!this->pages[page]) {
+                        this->pages[page].reset(new uint32_t[PAGE_SIZE]);
+                        std::fill(this->pages[page].get(), this->pages[page].get() + PAGE_SIZE, static_cast<uint32_t>(INVALID_SLOT));
+                    }
+                    return this->pages[page][index & (PAGE_SIZE - 1)];
+                }
+                return this->overflow.insert(std::make_pair(index, static_cast<uint32_t>(INVALID_SLOT))).first->second;
+            }
+
+            std::vector<std::unique_ptr<uint32_t[]>> pages; // entity index --> slot in components
+            std::unordered_map<id_t, uint32_t> overflow; // slots for entity indices too large to page
+            ComponentVector components; // dense, in insertion order until something is removed
+            std::vector<id_t> entities; // the owner of each slot in components
+    };
+
+    /**
+     * \brief Type erased interface of ComponentBucket so a system can keep its buckets in sync.
+     */
+    class IComponentBucket {
+        public:
+            virtual ~IComponentBucket() {}
+            /**
+             * \brief Drops a component from the bucket if it is in it
+             *
+             * \param[in] const IComponent* Component the component being removed from its system
+             */
+            virtual void remove(const IComponent* Component) = 0;
+    };
+
+    /**
+     * \brief A typed view of some of the components owned by a system.
+     *
+     * A system fills a bucket with components of the concrete type it just created (so no cast
+     * is needed) and its update passes walk the bucket instead of every store. The bucket does
+     * not own its components; adding and removing are O(1), removal swaps the last entry into
+     * the hole so the order is not preserved.
+     */
+    template<typename U>
+    class ComponentBucket : public IComponentBucket {
+        typedef std::vector<U*> ComponentVector;
+        public:
+            typedef typename ComponentVector::iterator iterator;
+            typedef typename ComponentVector::const_iterator const_iterator;
+
+            /**
+             * \brief Adds a component to the bucket
+             *
+             * Adding a component that is already in the bucket does nothing.
+             * \param[in] U* Component the component to add
+             */
+            void add(U* Component) {
+                if (this->index.insert(std::make_pair(static_cast<const IComponent*>(Component), this->components.size())).second) {
+                    this->components.push_back(Component);
+                }
+            }
+
+            void remove(const IComponent* Component) override {
+                auto found = this->index.find(Component);
+                if (found == this->index.end()) {
+                    return;
+                }
+                size_t slot = found->second;
+                this->index.erase(found);
+                if (slot != this->components.size() - 1) {
+                    this->components[slot] = this->components.back();
+                    this->index[this->components[slot]] = slot;
+                }
+                this->components.pop_back();
+            }
+
+            bool contains(const IComponent* Component) const { return this->index.count(Component) > 0; }
+            size_t size() const { return this->components.size(); }
+            bool empty() const { return this->components.empty(); }
+
+            iterator begin() { return this->components.begin(); }
+            iterator end() { return this->components.end(); }
+            const_iterator begin() const { return this->components.begin(); }
+            const_iterator end() const { return this->components.end(); }
+        private:
+            ComponentVector components; // dense, iterated by the update passes
+            std::unordered_map<const IComponent*, size_t> index; // component --> slot in components
+    };
+
+    /**
+     * \brief Type erased interface of ISystem, so entities can be removed from every system at once.
+     */
+    class ISystemBase {
+        public:
+            virtual ~ISystemBase() {}
+            /**
+             * \brief Removes and destroys every component of an entity
+             *
+             * \param[in] id_t EntityID the entity being removed
+             * \return size_t the number of components removed
+             */
+            virtual size_t removeEntity(id_t EntityID) = 0;
+    };
+
+    template<typename T>
+    class ISystem : public ISystemBase {
+        protected:
+            typedef ComponentStore<T> Store;
+            typedef std::unordered_map<IComponent::ComponentID, Store> StoreMap;
+        public:
+            ISystem() : _UpdateDepth(0) {};
             virtual ~ISystem() {};
             /**
              * \brief Retrieves a component
              *
              * Retrieves the Component specified by ID belonging to the Entity specified by EntityID
-             * In case t
              * \param[in] id_t EntityId the Id of the Entity the wanted Component belongs to
-             * \param[in] IComponent::ComponentID ID The Id of the wanted Component
+             * \param[in] IComponent::ComponentID ID The type Id of the wanted Component (X::getStaticComponentTypeID())
              * \return   T* returns the Component or NULL, if either the Entity doesn't exist or the Entity doesn't have that Component
              */
-            T* getComponent(id_t EntityID, IComponent::ComponentID ID) {
-                if(this->_Components.find(EntityID) != this->_Components.end() && this->_Components[EntityID].find(ID) != this->_Components[EntityID].end()) {
-                    return _Components[EntityID][ID].get();
-                }
-				else {
-                    return NULL;
+            T* getComponent(id_t EntityID, IComponent::ComponentID ID) const {
+                auto store = this->_Stores.find(ID);
+                if (store != this->_Stores.end()) {
+                    return store->second.get(EntityID);
                 }
+                return NULL;
             }
 
             /**
              * \brief Adds a component
              *
-             * Adds the given Component to the Entity specified by EntityID
+             * Adds the given Component to the Entity specified by EntityID. A Component it replaces
+             * is cleaned up, dropped from every registered bucket and destroyed. While an UpdateScope
+             * of the system is alive, a replacement is deferred like a removal, and the replaced
+             * Component is still the one found until the scope ends.
              * \param[in] id_t EntityId the Id of the Entity the Component belongs to
              * \param[in] T* Component The Component that should be added to the given EntityID
              */
             void addComponent(id_t EntityID,T* Component) {
-				auto found=_Components.find(EntityID);
-                if(found==_Components.end()) {
-                   this-> _Components.insert(std::pair<id_t,ComponentMap>(EntityID,ComponentMap()));
+                if (this->_UpdateDepth > 0) {
+                    T* occupant = this->_Stores[Component->getComponentTypeID()].occupant(EntityID);
+                    if (occupant && occupant != Component) {
+                        this->_Pending.push_back(PendingChange(EntityID, Component->getComponentTypeID(), Component));
+                        return;
+                    }
+                }
+                // The replaced component may belong to a stale generation of the entity, which
+                // get() doesn't find, so take it from insert()
+                std::unique_ptr<T> replaced;
+                this->_Stores[Component->getComponentTypeID()].insert(EntityID, std::unique_ptr<T>(Component), &replaced);
+                if (replaced) {
+                    cleanupComponent(replaced.get());
+                    for (auto bitr = this->_Buckets.begin(); bitr != this->_Buckets.end(); ++bitr) {
+                        (*bitr)->remove(replaced.get());
+                    }
+                }
+            }
+
+            /**
+             * \brief Removes a component
+             *
+             * Removes the Component specified by ID from the Entity specified by EntityID, runs
+             * cleanupComponent, then drops it from every registered bucket and destroys it. O(1), but
+             * changes the order of the store. While an UpdateScope of the system is alive, the
+             * removal is deferred until the scope ends and the Component can still be found.
+             * \param[in] id_t EntityID the Id of the Entity the Component belongs to
+             * \param[in] IComponent::ComponentID ID The type Id of the Component to remove
+             * \return bool false if the Entity didn't have that Component
+             */
+            bool removeComponent(id_t EntityID, IComponent::ComponentID ID) {
+                auto store = this->_Stores.find(ID);
+                if (store == this->_Stores.end() || !store->second.get(EntityID)) {
+                    return false;
+                }
+                if (this->_UpdateDepth > 0) {
+                    this->_Pending.push_back(PendingChange(EntityID, ID, nullptr));
+                    return true;
+                }
+                std::unique_ptr<T> removed = store->second.remove(EntityID);
+                cleanupComponent(removed.get());
+                for (auto bitr = this->_Buckets.begin(); bitr != this->_Buckets.end(); ++bitr) {
+                    (*bitr)->remove(removed.get());
                 }
-               this-> _Components[EntityID][Component->getComponentTypeName()]=std::unique_ptr<T>(Component);
+                return true;
+            }
+
+            size_t removeEntity(id_t EntityID) override {
+                size_t count = 0;
+                for (auto sitr = this->_Stores.begin(); sitr != this->_Stores.end(); ++sitr) {
+                    if (removeComponent(EntityID, sitr->first)) {
+                        ++count;
+                    }
+                }
+                return count;
             }
         protected:
-            EntityComponentMap _Components;
+            /**
+             * \brief Defers removals and replacements while the system walks its components
+             *
+             * Create one at the top of an update pass; components removed or replaced while it is
+             * alive (by the pass itself, or through EntityManager::DeleteEntity) are removed or
+             * replaced, in order, when the outermost scope ends, so stores and buckets don't change
+             * under the iterators.
+             */
+            class UpdateScope {
+                public:
+                    UpdateScope(ISystem& System) : system(System) { ++this->system._UpdateDepth; }
+                    ~UpdateScope() {
+                        if (--this->system._UpdateDepth == 0) {
+                            this->system.flushPending();
+                        }
+                    }
+                private:
+                    UpdateScope(const UpdateScope&);
+                    UpdateScope& operator=(const UpdateScope&);
+                    ISystem& system;
+            };
+
+            /**
+             * \brief Releases what a component holds outside of itself before it is destroyed
+             *
+             * Called when a component is removed or replaced, while it is still in the buckets.
+             * Systems override it to take the component out of their external state (physics
+             * world, GPU or audio objects).
+             * \param[in] T* Component the component about to be destroyed
+             */
+            virtual void cleanupComponent(T*) {}
+
+            /**
+             * \brief Registers a bucket to be kept in sync with the stores
+             *
+             * Components replaced in (and later removed from) the stores are dropped from every
+             * registered bucket. The bucket must outlive the system, usually by being a member of it.
+             * \param[in] IComponentBucket* Bucket the bucket to register
+             */
+            void RegisterBucket(IComponentBucket* Bucket) {
+                this->_Buckets.push_back(Bucket);
+            }
+
+            StoreMap _Stores; // One packed store per component type
+            std::vector<IComponentBucket*> _Buckets; // Typed views over _Stores, see RegisterBucket
         private:
+            // A removal, or a replacement if Component is set
+            struct PendingChange {
+                PendingChange(id_t EntityID, IComponent::ComponentID ID, T* Component) : EntityID(EntityID), ID(ID), Component(Component) {}
+                id_t EntityID;
+                IComponent::ComponentID ID;
+                T* Component; // owned until it is added
+            };
+
+            void flushPending() {
+                std::vector<PendingChange> pending;
+                pending.swap(this->_Pending);
+                for (auto pitr = pending.begin(); pitr != pending.end(); ++pitr) {
+                    if (pitr->Component) {
+                        addComponent(pitr->EntityID, pitr->Component);
+                    }
+                    else {
+                        removeComponent(pitr->EntityID, pitr->ID);
+                    }
+                }
+            }
+
+            unsigned int _UpdateDepth; // number of live UpdateScopes
+            std::vector<PendingChange> _Pending; // removals and replacements deferred by UpdateScope
     };
 }
 
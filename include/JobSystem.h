@@ -0,0 +1,162 @@
+#pragma once
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <functional>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include "FrameAllocator.h"
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief Tasks and the order they have to run in, for JobSystem::Run.
+	 *
+	 * Tasks without an ordering between them may run at the same time. A graph can be run
+	 * again, e.g. once per frame.
+	 */
+	class TaskGraph {
+	public:
+		typedef size_t TaskID;
+
+		/**
+		 * \brief Adds a task.
+		 *
+		 * \param[in] std::function<void()> task The work to do.
+		 * \return TaskID The task, to order it with Precede.
+		 */
+		DLL_EXPORT TaskID Add(std::function<void()> task);
+
+		/**
+		 * \brief Makes a task wait for another one to finish.
+		 *
+		 * \param[in] TaskID before The task that runs first.
+		 * \param[in] TaskID after The task that starts once before has finished.
+		 */
+		DLL_EXPORT void Precede(TaskID before, TaskID after);
+
+		size_t size() const { return this->nodes.size(); }
+		bool empty() const { return this->nodes.empty(); }
+		void clear() { this->nodes.clear(); }
+	private:
+		friend class JobSystem;
+		struct Node {
+			Node(std::function<void()> task) : task(task), predecessors(0) { }
+			std::function<void()> task;
+			std::vector<TaskID> successors;
+			unsigned int predecessors;
+		};
+		std::vector<Node> nodes;
+	};
+
+	/**
+	 * \brief A work-stealing thread pool that the systems split their work across.
+	 *
+	 * Each worker thread has its own queue of jobs: it takes the newest job of its own queue
+	 * and, when that is empty, steals the oldest job of another queue, so work spreads out
+	 * without a single shared queue to fight over. Threads that are not workers (the main
+	 * loop) share one more queue.
+	 *
+	 * Every Run and ParallelFor call returns once its jobs are done, and the calling thread
+	 * runs jobs while it waits, so jobs can start more jobs without blocking the workers.
+	 * An exception thrown by a job is rethrown from the call that started it.
+	 *
+	 * Each thread also gets a FrameAllocator for scratch memory, which NewFrame releases.
+	 */
+	class JobSystem {
+	public:
+		typedef std::function<void()> Job;
+		// Called with a [begin, end) sub-range
+		typedef std::function<void(size_t begin, size_t end)> RangeJob;
+
+		/**
+		 * \brief Starts the worker threads.
+		 *
+		 * \param[in] unsigned int workers The number of worker threads, 0 to use one less than the number of cores.
+		 */
+		DLL_EXPORT explicit JobSystem(unsigned int workers = 0);
+		DLL_EXPORT ~JobSystem();
+
+		/**
+		 * \brief Runs jobs in parallel and waits for all of them.
+		 *
+		 * \param[in] const std::vector<Job> & jobs The jobs.
+		 */
+		DLL_EXPORT void Run(const std::vector<Job>& jobs);
+
+		/**
+		 * \brief Runs the tasks of a graph in parallel, in their order, and waits for all of them.
+		 *
+		 * A task that throws still lets the tasks after it run.
+		 * \param[in] const TaskGraph & graph The tasks.
+		 * \exception std::invalid_argument if the ordering has a cycle.
+		 */
+		DLL_EXPORT void Run(const TaskGraph& graph);
+
+		/**
+		 * \brief Queues a job for the worker threads and returns at once.
+		 *
+		 * Threads that aren't workers never run submitted jobs, not even while they wait in Run
+		 * or ParallelFor, so a long job can't hold up the main loop.
+		 * \param[in] Job job The job.
+		 * \param[in] std::function<void(std::exception_ptr)> done Called on the worker when the job has finished, with the exception it threw if any.
+		 */
+		DLL_EXPORT void Submit(Job job, std::function<void(std::exception_ptr)> done);
+
+		/**
+		 * \brief Splits a range into chunks, runs them in parallel and waits for all of them.
+		 *
+		 * \param[in] size_t begin The start of the range.
+		 * \param[in] size_t end The end of the range, excluded.
+		 * \param[in] size_t grain The number of items per chunk, 0 to pick one from the number of threads.
+		 * \param[in] const RangeJob & job Called once per chunk.
+		 */
+		DLL_EXPORT void ParallelFor(size_t begin, size_t end, size_t grain, const RangeJob& job);
+
+		/**
+		 * \brief The frame allocator of the calling thread.
+		 *
+		 * Threads that are not workers share one, so only the main loop should use it among them.
+		 */
+		DLL_EXPORT FrameAllocator& GetFrameAllocator();
+
+		/**
+		 * \brief Releases the memory of every frame allocator.
+		 *
+		 * Call at the start of a frame, while no jobs are running.
+		 */
+		DLL_EXPORT void NewFrame();
+
+		unsigned int WorkerCount() const { return static_cast<unsigned int>(this->workers.size()); }
+	private:
+		JobSystem(const JobSystem&);
+		JobSystem& operator=(const JobSystem&);
+
+		struct Batch;
+		struct Task;
+		struct WorkQueue;
+
+		void WorkerLoop(size_t index);
+		size_t ThisQueue() const; // the queue of the calling thread
+		void Push(size_t queue, Task task);
+		bool TryRun(size_t queue); // runs one job, false if there was none
+		void Wait(Batch& batch, size_t queue); // runs jobs until the batch is done
+
+		std::vector<std::unique_ptr<WorkQueue>> queues; // 0 for other threads, then one per worker
+		std::vector<std::unique_ptr<FrameAllocator>> allocators; // one per queue
+		std::vector<std::thread> workers;
+
+		std::atomic<size_t> queued; // jobs in all the queues
+		std::atomic<size_t> nextWorker; // round robin for jobs submitted by other threads
+		std::mutex sleepMutex;
+		std::condition_variable wake; // signaled when a job is queued or on shutdown
+		bool stop; // guarded by sleepMutex
+	};
+}
+
+#endif // JOBSYSTEM_H
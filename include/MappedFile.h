@@ -0,0 +1,51 @@
+#pragma once
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief A read only memory mapping of a whole file.
+	 *
+	 * The file's bytes are available through Data() until the object is destroyed or Close()d,
+	 * without copying them into a buffer first. Empty files open successfully with Size() 0.
+	 */
+	class MappedFile {
+	public:
+		DLL_EXPORT MappedFile();
+		DLL_EXPORT ~MappedFile();
+
+		/**
+		 * \brief Maps a file, unmapping the previous one if any.
+		 *
+		 * \param[in] const std::string& fname The file to map
+		 * \return bool false if the file couldn't be opened or mapped
+		 */
+		DLL_EXPORT bool Open(const std::string& fname);
+
+		/**
+		 * \brief Unmaps the file. Data() is invalid afterwards.
+		 */
+		DLL_EXPORT void Close();
+
+		bool IsOpen() const { return this->open; }
+		const char* Data() const { return this->data; }
+		size_t Size() const { return this->size; }
+	private:
+		MappedFile(const MappedFile&);
+		MappedFile& operator=(const MappedFile&);
+
+		const char* data;
+		size_t size;
+		bool open;
+#ifdef _WIN32
+		void* file; // HANDLE
+		void* mapping; // HANDLE
+#endif
+	};
+}
+
+#endif // MAPPEDFILE_H
@@ -53,6 +53,23 @@ namespace Sigma {
 		 */
 		DLL_EXPORT void OSMessageLoop();
 
+		/**
+		 * \brief Sleeps until an OS event arrives or the timeout passes, processing the events.
+		 *
+		 * Needs GLFW 3.2 to wake up for events; older versions just sleep for the timeout.
+		 * \param[in] double timeout The longest time to wait in seconds.
+		 * \return void
+		 */
+		DLL_EXPORT void WaitEvents(double timeout);
+
+		/**
+		 * \brief Sets whether SwapBuffers waits for the display's vertical blank.
+		 *
+		 * \param[in] bool vsync True to wait.
+		 * \return void
+		 */
+		DLL_EXPORT void SetVSync(bool vsync);
+
 		DLL_EXPORT int GetWindowWidth();
 
 		DLL_EXPORT int GetWindowHeight();
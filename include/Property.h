@@ -1,33 +1,62 @@
 #pragma once
 
 #include <string>
+#include <cstring>
+#include <typeinfo>
+#include <utility>
+#include "Sigma.h"
 
 /**
   * \brief A class to contain a generic property.
   *
   * This class is used to pass around generic properties.
-  * Properties have a name and a value. The value is stored in
-  * vholder and is accessed by calling Get() with the
-  * appropriate type.
+  * Properties have a name and a value. The value is accessed by
+  * calling Get() with the type it was set with; any other type
+  * throws std::bad_cast.
+  *
+  * bool, int, float, strings shorter than INLINE_CHARS and pointers
+  * are stored inline, so creating, copying and moving such a property
+  * doesn't touch the heap (beyond a name too long for std::string's own
+  * inline buffer). Longer strings and other types are stored on the heap.
+  *
+  * The name is interned into a small integer ID when the property is
+  * created, so PropertyBindings can dispatch on it without comparing strings.
   */
 class Property {
 private:
-	Property() { }
+	Property() : nameID(0), length(0), type(NONE) { }
 public:
+	enum ValueType { NONE, BOOL, INT, FLOAT, STRING, POINTER, OBJECT };
+	enum { INLINE_CHARS = 24 }; // strings up to INLINE_CHARS - 1 long are stored inline
+
 	// Copy
-	Property(const Property &other) {
-		this->name = other.name;
-		if (other.vholder != nullptr) {
-			this->vholder = other.vholder->Clone();
-		}
-		else {
-			this->vholder = nullptr;
+	Property(const Property &other) : name(other.name), nameID(other.nameID), length(0), type(NONE) {
+		CopyValue(other);
+	}
+
+	// Move, noexcept so std::vector moves instead of copies when it grows
+	Property(Property&& other) SIGMA_NOEXCEPT : name(std::move(other.name)), nameID(other.nameID), length(0), type(NONE) {
+		MoveValue(other);
+	}
+
+	Property& operator=(const Property &other) {
+		if (this != &other) {
+			Reset();
+			this->name = other.name;
+			this->nameID = other.nameID;
+			CopyValue(other);
 		}
+		return *this;
 	}
 
-	// Move
-	Property(Property&& other) : name(other.name), vholder(other.vholder) {
-		other.vholder = nullptr;
+	Property& operator=(Property&& other) SIGMA_NOEXCEPT {
+		if (this != &other) {
+			Reset();
+			this->name = std::move(other.name);
+			this->nameID = other.nameID;
+			MoveValue(other);
+		}
+		return *this;
 	}
 
 	/**
@@ -37,25 +66,87 @@ public:
 	 * \param[in/out] t value The value of the property. typename is inferred on usage.
 	 */
 	template <typename t>
-	Property(std::string name, t value) : name(name), vholder(new ValueHolder<t>(value)) { }
+	Property(std::string name, t value) : name(std::move(name)), nameID(InternName(this->name)), length(0), type(NONE) {
+		Set(value);
+	}
+
+	/**
+	 * \brief Sets the name and a string value of the property.
+	 *
+	 * Stored as a string (not a pointer), so the value is read back with Get<std::string>().
+	 * \param[in] std::string name The name of the property
+	 * \param[in] const char* value The characters of the value
+	 * \param[in] size_t length The number of characters in value
+	 */
+	Property(std::string name, const char* value, size_t length) : name(std::move(name)), nameID(InternName(this->name)), length(0), type(NONE) {
+		SetString(value, length);
+	}
+
+	Property(std::string name, const char* value) : name(std::move(name)), nameID(InternName(this->name)), length(0), type(NONE) {
+		SetString(value, strlen(value));
+	}
+
+	/**
+	 * \brief A property name, interned once, for creating many properties of that name.
+	 *
+	 * Creating a property from a Name copies the name but skips looking it up in InternName.
+	 */
+	struct Name {
+		explicit Name(std::string name) : name(std::move(name)), id(InternName(this->name)) { }
+		std::string name;
+		unsigned int id;
+	};
+
+	template <typename t>
+	Property(const Name& name, t value) : name(name.name), nameID(name.id), length(0), type(NONE) {
+		Set(value);
+	}
+
+	Property(const Name& name, const char* value, size_t length) : name(name.name), nameID(name.id), length(0), type(NONE) {
+		SetString(value, length);
+	}
 
-	~Property() { delete this->vholder; }
+	~Property() { Reset(); }
 
 	/**
-	 * \brief Retrieves the value in vholder.
+	 * \brief Retrieves the value of the property.
 	 *
-	 * Calls the Get() method of ValueHolder with the given template type.
 	 * \returns   t The value with the given template type.
+	 * \exception std::bad_cast if the value isn't of type t.
 	 */
 	template <typename t>
-	t Get() const { return static_cast<ValueHolder<t>*>(this->vholder)->Get(); }
+	t Get() const { return Load(Tag<t>()); }
 
 	/**
 	 * \brief Gets the name of this property.
 	 *
-	 * \returns   std::string The name of this property.
+	 * \returns   const std::string& The name of this property.
+	 */
+	const std::string& GetName() const { return this->name; }
+
+	/**
+	 * \brief Gets the interned ID of this property's name.
+	 *
+	 * \returns   unsigned int The ID InternName returns for GetName().
+	 */
+	unsigned int GetNameID() const { return this->nameID; }
+
+	/**
+	 * \brief Interns a property name.
+	 *
+	 * IDs are dense and start at 0, and the same name always gets the same ID
+	 * for the lifetime of the process. Thread safe.
+	 * \param[in] const std::string& name The property name
+	 * \returns   unsigned int The ID of name
+	 */
+	DLL_EXPORT static unsigned int InternName(const std::string& name);
+
+	/**
+	 * \brief Gets the kind of value held by this property.
+	 *
+	 * \returns   ValueType The kind of value.
 	 */
-	std::string GetName() const { return this->name; }
+	ValueType GetType() const { return this->type; }
 private:
 	/**
 	  * \brief ValueHolderBase is a common base type that can be used to holder a pointer to a specialized templated version of ValueHolder.
@@ -70,23 +161,130 @@ private:
 		 * \returns   ValueHolderBase* A clone of the held object.
 		 */
 		virtual ValueHolderBase* Clone() const = 0;
+		virtual const std::type_info& Type() const = 0;
 	};
 
-
 	/**
-	  * \brief A generic value holder type.
+	  * \brief A generic value holder type, for values that can't be stored inline.
 	  *
 	  */
 	template <typename t>
 	class ValueHolder : public ValueHolderBase {
 	public:
-		ValueHolder(t value) : value(value) {}
+		ValueHolder(const t& value) : value(value) {}
 		virtual ValueHolder* Clone() const { return new ValueHolder(value); }
-		t Get() { return this->value; }
+		virtual const std::type_info& Type() const { return typeid(t); }
+		const t& Get() const { return this->value; }
 	private:
 		t value;
 	};
 
+	// Selects the Load overload for a type without needing a value of it
+	template <typename t>
+	struct Tag { };
+
+	void Set(bool v) { this->value.b = v; this->type = BOOL; }
+	void Set(int v) { this->value.i = v; this->type = INT; }
+	void Set(float v) { this->value.f = v; this->type = FLOAT; }
+	void Set(const std::string& v) { SetString(v.data(), v.size()); }
+	template <typename t>
+	void Set(t* v) {
+		this->value.ptr.address = const_cast<void*>(static_cast<const void*>(v));
+		this->value.ptr.pointee = &typeid(t);
+		this->type = POINTER;
+	}
+	template <typename t>
+	void Set(const t& v) {
+		this->value.holder = new ValueHolder<t>(v);
+		this->type = OBJECT;
+	}
+
+	void SetString(const char* chars, size_t length) {
+		char* dest = this->value.chars;
+		if (length >= INLINE_CHARS) {
+			dest = this->value.heapChars = new char[length + 1];
+		}
+		memcpy(dest, chars, length);
+		dest[length] = '\0';
+		this->length = length;
+		this->type = STRING;
+	}
+
+	const char* Chars() const {
+		return (this->length < INLINE_CHARS) ? this->value.chars : this->value.heapChars;
+	}
+
+	void Check(ValueType expected) const {
+		if (this->type != expected) {
+			throw std::bad_cast();
+		}
+	}
+
+	bool Load(Tag<bool>) const { Check(BOOL); return this->value.b; }
+	int Load(Tag<int>) const { Check(INT); return this->value.i; }
+	float Load(Tag<float>) const { Check(FLOAT); return this->value.f; }
+	std::string Load(Tag<std::string>) const { Check(STRING); return std::string(Chars(), this->length); }
+	template <typename t>
+	t* Load(Tag<t*>) const {
+		Check(POINTER);
+		if (*this->value.ptr.pointee != typeid(t)) {
+			throw std::bad_cast();
+		}
+		return static_cast<t*>(this->value.ptr.address);
+	}
+	template <typename t>
+	t Load(Tag<t>) const {
+		Check(OBJECT);
+		if (this->value.holder->Type() != typeid(t)) {
+			throw std::bad_cast();
+		}
+		return static_cast<const ValueHolder<t>*>(this->value.holder)->Get();
+	}
+
+	void CopyValue(const Property &other) {
+		if (other.type == STRING) {
+			SetString(other.Chars(), other.length);
+			return;
+		}
+		this->value = other.value;
+		this->length = other.length;
+		if (other.type == OBJECT) {
+			this->value.holder = other.value.holder->Clone();
+		}
+		this->type = other.type;
+	}
+
+	void MoveValue(Property &other) {
+		this->value = other.value; // a heap string or holder changes owner with the union
+		this->length = other.length;
+		this->type = other.type;
+		other.type = NONE;
+	}
+
+	void Reset() {
+		if (this->type == STRING && this->length >= INLINE_CHARS) {
+			delete[] this->value.heapChars;
+		}
+		else if (this->type == OBJECT) {
+			delete this->value.holder;
+		}
+		this->type = NONE;
+	}
+
 	std::string name; // Name of this property.
-	ValueHolderBase* vholder; // The value held by this property.
+	unsigned int nameID; // Interned name.
+	union {
+		bool b;
+		int i;
+		float f;
+		char chars[INLINE_CHARS]; // null terminated
+		char* heapChars; // null terminated, when length >= INLINE_CHARS
+		struct {
+			void* address;
+			const std::type_info* pointee;
+		} ptr;
+		ValueHolderBase* holder;
+	} value; // The value held by this property, selected by type.
+	size_t length; // Length of a string value
+	ValueType type;
 };
@@ -0,0 +1,110 @@
+#pragma once
+#ifndef PROPERTYBINDINGS_H
+#define PROPERTYBINDINGS_H
+
+#include <vector>
+#include <functional>
+#include <typeinfo>
+#include "Property.h"
+
+namespace Sigma {
+	/**
+	 * \brief A table mapping property names to setters on a target type.
+	 *
+	 * Factories build one table per component type the first time it is needed, and then
+	 * apply a whole property vector in one pass: each property's interned name ID indexes
+	 * straight into the table, so no names are compared. Properties without a binding are
+	 * ignored.
+	 *
+	 * The target is usually a small struct of creation parameters with their defaults, which
+	 * the factory reads once all properties are applied.
+	 */
+	template<typename T>
+	class PropertyBindings {
+	public:
+		typedef std::function<void(T&, const Property&)> Setter;
+
+		/**
+		 * \brief Binds a property name to a setter.
+		 *
+		 * Binding a name twice replaces the earlier setter.
+		 * \param[in] const std::string& name The property name
+		 * \param[in] Setter setter Called with the target and the property
+		 * \return PropertyBindings& this table, so bindings can be chained
+		 */
+		PropertyBindings& Bind(const std::string& name, Setter setter) {
+			unsigned int id = Property::InternName(name);
+			if (id >= this->setters.size()) {
+				this->setters.resize(id + 1);
+			}
+			this->setters[id] = setter;
+			return *this;
+		}
+
+		/**
+		 * \brief Binds a property name to a data member of the target.
+		 *
+		 * The member is assigned Get<V>() of the property.
+		 * \param[in] const std::string& name The property name
+		 * \param[in] V T::* member The member to assign
+		 * \return PropertyBindings& this table, so bindings can be chained
+		 */
+		template<typename V>
+		PropertyBindings& Bind(const std::string& name, V T::* member) {
+			return Bind(name, [member] (T& target, const Property& p) { target.*member = p.Get<V>(); });
+		}
+
+		/**
+		 * \brief Applies every bound property to the target, in order.
+		 *
+		 * A property of another type than its setter reads is skipped with a warning, so one
+		 * mistyped value in a scene doesn't abort the load.
+		 * \param[in/out] T& target The object to set the properties on
+		 * \param[in] const std::vector<Property>& properties The properties to apply
+		 */
+		void Apply(T& target, const std::vector<Property>& properties) const {
+			for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
+				unsigned int id = propitr->GetNameID();
+				if (id < this->setters.size() && this->setters[id]) {
+					try {
+						this->setters[id](target, *propitr);
+					}
+					catch (const std::bad_cast&) {
+						LOG_WARN << "Property " << propitr->GetName() << " has the wrong type, ignoring it";
+					}
+				}
+			}
+		}
+	private:
+		std::vector<Setter> setters; // indexed by interned property name ID
+	};
+
+	/**
+	 * \brief Position, rotation and uniform scale read by most component factories.
+	 */
+	struct PlacementProperties {
+		PlacementProperties() : x(0.0f), y(0.0f), z(0.0f), rx(0.0f), ry(0.0f), rz(0.0f), scale(1.0f) { }
+		float x, y, z;
+		float rx, ry, rz;
+		float scale;
+	};
+
+	/**
+	 * \brief Binds "x", "y", "z", "rx", "ry", "rz" and "scale" to a PlacementProperties member.
+	 *
+	 * \param[in/out] PropertyBindings<T>& bindings The table to add the bindings to
+	 * \param[in] PlacementProperties T::* placement The member of the target to set
+	 */
+	template<typename T>
+	void BindPlacement(PropertyBindings<T>& bindings, PlacementProperties T::* placement) {
+		bindings.Bind("x", [placement] (T& t, const Property& p) { (t.*placement).x = p.Get<float>(); })
+			.Bind("y", [placement] (T& t, const Property& p) { (t.*placement).y = p.Get<float>(); })
+			.Bind("z", [placement] (T& t, const Property& p) { (t.*placement).z = p.Get<float>(); })
+			.Bind("rx", [placement] (T& t, const Property& p) { (t.*placement).rx = p.Get<float>(); })
+			.Bind("ry", [placement] (T& t, const Property& p) { (t.*placement).ry = p.Get<float>(); })
+			.Bind("rz", [placement] (T& t, const Property& p) { (t.*placement).rz = p.Get<float>(); })
+			.Bind("scale", [placement] (T& t, const Property& p) { (t.*placement).scale = p.Get<float>(); });
+	}
+}
+
+#endif // PROPERTYBINDINGS_H
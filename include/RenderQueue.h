@@ -0,0 +1,119 @@
+#pragma once
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <vector>
+#include <utility>
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief Orders a frame's draws so that consecutive draws share as much state as possible.
+	 *
+	 * Each draw is submitted with a 64-bit sort key and the index of what to draw. Sorting by
+	 * the key groups the draws by pass, then shader, material and vertex array, and within
+	 * those front to back, so the renderer only switches state when the key changes:
+	 *
+	 *   bits 63-60 pass, 59-48 shader, 47-32 material, 31-16 vertex array, 15-0 depth
+	 *
+	 * The IDs are truncated to their field, so two of them can share a group; that only
+	 * costs a state change, as the renderer still binds what each draw needs.
+	 */
+	class RenderQueue {
+	public:
+		struct Item {
+			uint64_t key;
+			uint32_t index; // of the draw, e.g. in the RenderSnapshot's models
+		};
+
+		// Consecutive draws made at once, e.g. as the instances of one draw call
+		struct Run {
+			size_t begin; // the position of the first draw in Items()
+			size_t count;
+		};
+
+		static const unsigned int PASS_BITS = 4;
+		static const unsigned int SHADER_BITS = 12;
+		static const unsigned int MATERIAL_BITS = 16;
+		static const unsigned int VAO_BITS = 16;
+		static const unsigned int DEPTH_BITS = 16;
+
+		/**
+		 * \brief Builds a sort key.
+		 *
+		 * \param[in] unsigned int pass The render pass, drawn in increasing order.
+		 * \param[in] uint32_t shader The shader program.
+		 * \param[in] uint32_t material The material, e.g. its main texture; 0 for none.
+		 * \param[in] uint32_t vao The vertex array.
+		 * \param[in] float depth The distance from the camera; closer draws come first.
+		 * \return uint64_t The key.
+		 */
+		DLL_EXPORT static uint64_t MakeKey(unsigned int pass, uint32_t shader, uint32_t material, uint32_t vao, float depth);
+
+		// The fields of a key
+		static unsigned int Pass(uint64_t key) { return static_cast<unsigned int>(key >> (64 - PASS_BITS)); }
+		static uint64_t State(uint64_t key) { return key >> DEPTH_BITS; } // everything but the depth
+
+		void Clear() { this->items.clear(); }
+
+		void Submit(uint64_t key, uint32_t index) {
+			Item item = { key, index };
+			this->items.push_back(item);
+		}
+
+		/**
+		 * \brief Sorts the submitted draws by key; draws with the same key keep the order of their indices.
+		 */
+		DLL_EXPORT void Sort();
+
+		/**
+		 * \brief Removes the draw of an index, and shifts the later indices down, keeping the order.
+		 *
+		 * For when the indexed draws are erased from under the queue.
+		 * \param[in] uint32_t index The index of the draw removed.
+		 */
+		DLL_EXPORT void Remove(uint32_t index);
+
+		/**
+		 * \brief Finds the draws of a pass, once sorted.
+		 *
+		 * \return std::pair<size_t, size_t> The [first, last) positions of the pass's draws in Items().
+		 */
+		DLL_EXPORT std::pair<size_t, size_t> PassRange(unsigned int pass) const;
+
+		/**
+		 * \brief Splits the sorted draws into runs of consecutive draws that can be made at once.
+		 *
+		 * A draw joins the run before it when both are in the same pass, the run has fewer than
+		 * maxCount draws, and same holds for the run's first draw and it. Draws that can share a
+		 * run should have the same key but for the depth, so that sorting puts them together.
+		 * \param[in] size_t maxCount The most draws in a run.
+		 * \param[in] Same same bool(const Item& first, const Item& item), whether item can join first's run.
+		 * \param[out] std::vector<Run>& runs The runs, in order; cleared first.
+		 */
+		template <typename Same>
+		void Runs(size_t maxCount, Same same, std::vector<Run>& runs) const {
+			runs.clear();
+			for (size_t i = 0; i < this->items.size(); ++i) {
+				if (!runs.empty()) {
+					Run& run = runs.back();
+					const Item& first = this->items[run.begin];
+					if (run.count < maxCount && Pass(first.key) == Pass(this->items[i].key) && same(first, this->items[i])) {
+						++run.count;
+						continue;
+					}
+				}
+				Run run = { i, 1 };
+				runs.push_back(run);
+			}
+		}
+
+		const std::vector<Item>& Items() const { return this->items; }
+		size_t size() const { return this->items.size(); }
+		bool empty() const { return this->items.empty(); }
+	private:
+		std::vector<Item> items;
+	};
+}
+
+#endif // RENDERQUEUE_H
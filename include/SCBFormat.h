@@ -0,0 +1,113 @@
+#pragma once
+#ifndef SCBFORMAT_H
+#define SCBFORMAT_H
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+
+// SCB files are SC scenes compiled by the scenecompiler tool (see SCBWriter).
+// SCParser loads them directly from a memory mapping.
+//
+// The header is made of 32 bit little endian integers. Everything after it is packed: counts,
+// indices and ints are LEB128 varints (ints zigzag encoded first), so small values take a byte.
+// ----------
+// Header, HEADER_SIZE bytes:
+//   magic "SCB2", version, entity count, string count,
+//   offset of the strings, offset of the entity records, file size
+// ----------
+// Strings, one after the other: length (varint), then the characters.
+// Every name, type and string value in the file is an index into the strings, and each
+// distinct string is stored once, so the loader resolves each of them once per file.
+// ----------
+// Entity records, in scene order:
+//   id (int), name, component count, then for each component:
+//     type name, type ID (ComponentTypeHash of the type name, 32 bits), property count, then for each property:
+//       name, value kind (PropertyKind, one byte), then the value for the kind:
+//         KIND_FLOAT 32 bit float, KIND_INT int, KIND_STRING string index, and none for the bool kinds
+
+namespace Sigma {
+	namespace parser {
+		namespace scb {
+			const char MAGIC[4] = { 'S', 'C', 'B', '2' };
+			const uint32_t VERSION = 2;
+			const uint32_t HEADER_SIZE = 4 * 7;
+
+			enum PropertyKind : uint8_t {
+				KIND_FLOAT = 0,
+				KIND_INT = 1,
+				KIND_FALSE = 2,
+				KIND_TRUE = 3,
+				KIND_STRING = 4
+			};
+
+			inline uint32_t ReadU32(const char* p) {
+				const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+				return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+					(static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+			}
+
+			inline void WriteU32(char* p, uint32_t value) {
+				p[0] = static_cast<char>(value & 0xFF);
+				p[1] = static_cast<char>((value >> 8) & 0xFF);
+				p[2] = static_cast<char>((value >> 16) & 0xFF);
+				p[3] = static_cast<char>((value >> 24) & 0xFF);
+			}
+
+			inline void AppendU32(std::vector<char>& out, uint32_t value) {
+				size_t at = out.size();
+				out.resize(at + 4);
+				WriteU32(&out[at], value);
+			}
+
+			inline void AppendVarint(std::vector<char>& out, uint32_t value) {
+				while (value >= 0x80) {
+					out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+					value >>= 7;
+				}
+				out.push_back(static_cast<char>(value));
+			}
+
+			/**
+			 * Reads a varint and advances p past it. Returns false, leaving p alone, if the
+			 * varint runs past end or is longer than a 32 bit value can be.
+			 */
+			inline bool ReadVarint(const char*& p, const char* end, uint32_t& value) {
+				uint32_t result = 0;
+				for (int shift = 0; shift < 35 && p + shift / 7 < end; shift += 7) {
+					uint32_t b = static_cast<unsigned char>(p[shift / 7]);
+					result |= (b & 0x7F) << shift;
+					if ((b & 0x80) == 0) {
+						p += shift / 7 + 1;
+						value = result;
+						return true;
+					}
+				}
+				return false;
+			}
+
+			// Maps ints of small magnitude, negative ones included, to small varints
+			inline uint32_t ZigZag(int32_t value) {
+				return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+			}
+
+			inline int32_t UnZigZag(uint32_t value) {
+				return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1)));
+			}
+
+			inline uint32_t FloatBits(float value) {
+				uint32_t bits;
+				memcpy(&bits, &value, sizeof(bits));
+				return bits;
+			}
+
+			inline float BitsFloat(uint32_t bits) {
+				float value;
+				memcpy(&value, &bits, sizeof(value));
+				return value;
+			}
+		}
+	}
+}
+
+#endif // SCBFORMAT_H
@@ -0,0 +1,59 @@
+#pragma once
+#ifndef SCBWRITER_H
+#define SCBWRITER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include "SCParser.h"
+
+namespace Sigma {
+	namespace parser {
+		/**
+		 * \brief Compiles parsed entities into an SCB file (see SCBFormat.h).
+		 *
+		 * Entities are added one at a time, so it can be fed straight from SCParser's callback.
+		 */
+		class SCBWriter {
+		public:
+			DLL_EXPORT SCBWriter();
+
+			/**
+			 * \brief Appends an entity and its components.
+			 *
+			 * Properties that don't hold a float, int, bool or string are skipped with a warning.
+			 * \param[in] const Entity & e The entity to add.
+			 */
+			DLL_EXPORT void Add(const Entity& e);
+
+			/**
+			 * \brief Writes everything added so far to a file.
+			 *
+			 * \param[in] const std::string & fname Name of the file to write.
+			 * \return   bool false if the file couldn't be written.
+			 */
+			DLL_EXPORT bool Write(const std::string& fname) const;
+
+			/**
+			 * \brief Compiles a scene file (text or binary) into an SCB file.
+			 *
+			 * \param[in] const std::string & in Name of the scene file to read.
+			 * \param[in] const std::string & out Name of the SCB file to write.
+			 * \return   bool false if either file couldn't be opened.
+			 */
+			DLL_EXPORT static bool Compile(const std::string& in, const std::string& out);
+
+			unsigned int EntityCount() const { return this->entityCount; }
+		private:
+			uint32_t Intern(const std::string& s);
+
+			std::vector<char> records; // entity records, already encoded
+			std::vector<std::string> strings; // by index
+			std::unordered_map<std::string, uint32_t> stringIndex; // string --> index in strings
+			uint32_t entityCount;
+		};
+	}
+}
+
+#endif // SCBWRITER_H
@@ -1,7 +1,9 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <functional>
 #include "Sigma.h"
+#include "Property.h"
 // SC files contain data for Sigma Component creation
 // Each line begins with a key. These keys describe the rest of the line.
 // There is no whitespace allowed between the key and the rest of the line
@@ -22,14 +24,15 @@
 // & - The type of the component to create. e.g.
 // &GLIcoSphere
 // ----------
-// > - A component property. Each line has a value and a type.
-// The last letter in the line dictates the type of the value. e.g.
+// > - A component property. Each line has a name, a value and a type.
+// The last letter in the line dictates the type of the value
+// (f float, i int, b bool as a number, 0 for false, s string). e.g.
 // Each property is added to the component it follows.
-// >100i
-// >10.0f
-// >I am a strings
+// >count=100i
+// >size=10.0f
+// >label=I am a strings
 // ----------
-// NOTE a blank line or comment line must follow each component.
+// A component ends at the first line that is not a property or id line.
 //
 // To create multiple components for each entity just make add a new component line (&).
 // @entity1
@@ -39,8 +42,9 @@
 //
 // &GLMesh
 // >prop2=2i
-
-class Property;
+//
+// Scenes may also be compiled into binary SCB files (see SCBFormat.h and the scenecompiler
+// tool). SCParser recognizes them by their magic number and loads either format.
 
 namespace Sigma {
 	namespace parser {
@@ -48,8 +52,9 @@ namespace Sigma {
 		 * The component creation properties.
 		 */
 		struct Component {
-			Component() : type("") { }
+			Component() : type(""), typeID(0) { }
 			std::string type;
+			ComponentID typeID; // ComponentTypeHash of type
 			std::vector<Property> properties;
 		};
 		/**
@@ -64,12 +69,32 @@ namespace Sigma {
 
 		class SCParser {
 		public:
+			/**
+			 * Receives each entity as soon as it has been parsed. The entity may be modified or
+			 * moved from; the parser reuses it (and its buffers) for the next entity.
+			 */
+			typedef std::function<void(Entity&)> EntityCallback;
+
 			SCParser() { }
 
+			/**
+			 * \brief Streams the entities of a file to a callback.
+			 *
+			 * The file is memory mapped and tokenized in place, and the entity handed to the
+			 * callback is reused, so once its buffers have grown, parsing allocates only for
+			 * names and values too long for the inline buffers of std::string and Property.
+			 * Nothing is kept in the entity list.
+			 * \param[in] const std::string & fname Name of the file to parse.
+			 * \param[in] const EntityCallback & onEntity Called once per entity, in file order.
+			 * \return   bool false if there was a file opening issue.
+			 */
+			DLL_EXPORT bool Parse(const std::string& fname, const EntityCallback& onEntity);
+
 			/**
 			 * \brief Parses a file into entities and their components.
 			 *
 			 * Given a file name the parser will parse through the file and create an entity list. These entities will have their components parsed as well.
+			 * Prefer the streaming overload for large files.
 			 * \param[in] const std::string & fname Name of the file to parse.
 			 * \return   bool false if there was a file opening issue.
 			 */
@@ -0,0 +1,61 @@
+#pragma once
+#ifndef SCENELOADER_H
+#define SCENELOADER_H
+
+#include <string>
+#include <functional>
+#include "SCParser.h"
+#include "systems/FactorySystem.h"
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief Loads scene files, preparing components on worker threads.
+	 *
+	 * The scene is parsed, then worker threads call the factory's preload function of each
+	 * component (file I/O, mesh parsing, image and sound decoding, BVH builds) in scene order,
+	 * while the calling thread creates the components, also in scene order, as soon as each is
+	 * prepared. Component creation, which makes the OpenGL and OpenAL objects, therefore stays
+	 * on the thread owning those contexts.
+	 */
+	class SceneLoader {
+	public:
+		/**
+		 * Creates one component. Called on the loading thread, after the component's preload
+		 * function has finished, and may change its properties.
+		 */
+		typedef std::function<void(parser::Entity&, parser::Component&)> CreateCallback;
+
+		/**
+		 * Reports the number of components created so far and the number in the scene.
+		 * Called on the loading thread after each component is created.
+		 */
+		typedef std::function<void(size_t created, size_t total)> ProgressCallback;
+
+		/**
+		 * \brief Creates a loader.
+		 *
+		 * \param[in] FactorySystem & factory The factory whose preload and create functions are used.
+		 * \param[in] unsigned int workers The number of worker threads, 0 to use one less than the number of cores.
+		 */
+		DLL_EXPORT SceneLoader(FactorySystem& factory, unsigned int workers = 0);
+
+		/**
+		 * \brief Loads a scene file (text or compiled) and creates its components.
+		 *
+		 * \param[in] const std::string & fname Name of the scene file.
+		 * \param[in] const CreateCallback & create Creates each component, FactorySystem::create if empty.
+		 * \param[in] const ProgressCallback & onProgress Reports progress, may be empty.
+		 * \return   bool false if the scene file couldn't be parsed.
+		 */
+		DLL_EXPORT bool Load(const std::string& fname, const CreateCallback& create = CreateCallback(),
+			const ProgressCallback& onProgress = ProgressCallback());
+
+		unsigned int WorkerCount() const { return this->workers; }
+	private:
+		FactorySystem& factory;
+		unsigned int workers;
+	};
+}
+
+#endif // SCENELOADER_H
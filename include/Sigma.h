@@ -9,7 +9,38 @@
 // Put in this header all the things shared by all code
 namespace Sigma {
 	typedef uint32_t id_t;
-	typedef std::string ComponentID;
+	typedef uint32_t ComponentID; // See ComponentTypeHash in IComponent.h
+}
+
+// MSVC only supports constexpr and noexcept from VS2015 on; older compilers evaluate the hashes at runtime.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define SIGMA_CONSTEXPR
+#define SIGMA_NOEXCEPT
+#else
+#define SIGMA_CONSTEXPR constexpr
+#define SIGMA_NOEXCEPT noexcept
+#endif
+
+// thread_local came with VS2015; older MSVC only has __declspec(thread), for plain data.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define SIGMA_THREAD_LOCAL __declspec(thread)
+#else
+#define SIGMA_THREAD_LOCAL thread_local
+#endif
+
+namespace Sigma {
+	// Entity IDs: the low ENTITY_INDEX_BITS bits are a slot in the entity table, the high bits
+	// the slot's generation, bumped each time the slot is reused (see EntityManager). IDs
+	// written by hand in scene files are small, so they are generation 0.
+	const unsigned int ENTITY_INDEX_BITS = 24;
+	const id_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+	const id_t ENTITY_GENERATION_MASK = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+
+	inline SIGMA_CONSTEXPR id_t EntityIndex(id_t EntityID) { return EntityID & ENTITY_INDEX_MASK; }
+	inline SIGMA_CONSTEXPR id_t EntityGeneration(id_t EntityID) { return EntityID >> ENTITY_INDEX_BITS; }
+	inline SIGMA_CONSTEXPR id_t MakeEntityID(id_t index, id_t generation) {
+		return ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK);
+	}
 }
 
 #ifdef libSigma_EXPORTS
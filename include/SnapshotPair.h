@@ -0,0 +1,89 @@
+#pragma once
+#ifndef SNAPSHOTPAIR_H
+#define SNAPSHOTPAIR_H
+
+#include <vector>
+#include <algorithm>
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief The two snapshots of a pipelined renderer: the published one, which is drawn,
+	 * and the pending one, which is captured into meanwhile.
+	 *
+	 * Both may be read until the next Publish, so an item removed in the meantime (e.g. a
+	 * deleted component) is only dropped from them by Publish; until then IsRemoved tells
+	 * the draw to skip it.
+	 *
+	 * Snapshot must have a method Remove(Key) that drops an item. A key must not be reused
+	 * for another item before the next Publish, so it shouldn't be an address that an
+	 * allocator may hand out again.
+	 */
+	template <typename Snapshot, typename Key>
+	class SnapshotPair {
+	public:
+		SnapshotPair() : published(0) { }
+
+		Snapshot& Pending() { return this->snapshots[1 - this->published]; }
+		const Snapshot& Published() const { return this->snapshots[this->published]; }
+
+		/**
+		 * \brief Drops an item from both snapshots at the next Publish.
+		 *
+		 * \param[in] Key key The item.
+		 */
+		void Remove(Key key) { this->removed.push_back(key); }
+
+		// Whether an item was removed since the last Publish
+		bool IsRemoved(Key key) const {
+			return std::find(this->removed.begin(), this->removed.end(), key) != this->removed.end();
+		}
+		bool HasRemovals() const { return !this->removed.empty(); }
+
+		/**
+		 * \brief Drops the removed items, then makes the pending snapshot the published one.
+		 *
+		 * Neither snapshot may be in use.
+		 */
+		void Publish() {
+			for (auto ritr = this->removed.begin(); ritr != this->removed.end(); ++ritr) {
+				this->snapshots[0].Remove(*ritr);
+				this->snapshots[1].Remove(*ritr);
+			}
+			this->removed.clear();
+			this->published = 1 - this->published;
+		}
+	private:
+		Snapshot snapshots[2];
+		unsigned int published; // index of the published snapshot
+		std::vector<Key> removed; // since the last Publish
+	};
+
+	/**
+	 * \brief Blends the models of a snapshot being captured between their last two states.
+	 *
+	 * Each model's current state must be set. Its previous state is its current state in the
+	 * last snapshot if the simulation stepped since, else the previous state it had there; a
+	 * model that wasn't at the same index in the last snapshot isn't blended for a frame.
+	 * Model needs the members key (its identity), previous, current and matrix (blended).
+	 * \param[in/out] Model * models The models of the snapshot being captured.
+	 * \param[in] size_t begin, end The range of models to blend, so it can be split across jobs.
+	 * \param[in] const std::vector<Model> & last The models of the last snapshot.
+	 * \param[in] bool stepped Whether the simulation stepped since the last snapshot.
+	 * \param[in] float alpha How far to blend from previous (0) to current (1).
+	 * \param[in] Interpolate interpolate State(const State& from, const State& to, float alpha).
+	 */
+	template <typename Model, typename Interpolate>
+	void BlendModels(Model* models, size_t begin, size_t end, const std::vector<Model>& last, bool stepped, float alpha, const Interpolate& interpolate) {
+		for (size_t i = begin; i < end; ++i) {
+			Model& model = models[i];
+			model.previous = model.current;
+			if (i < last.size() && last[i].key == model.key) {
+				model.previous = stepped ? last[i].current : last[i].previous;
+			}
+			model.matrix = interpolate(model.previous, model.current, alpha);
+		}
+	}
+}
+
+#endif // SNAPSHOTPAIR_H
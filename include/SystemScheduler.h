@@ -0,0 +1,131 @@
+#pragma once
+#ifndef SYSTEMSCHEDULER_H
+#define SYSTEMSCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include "IComponent.h"
+#include "JobSystem.h"
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief The data a system's update reads and writes, and where it has to run.
+	 *
+	 * Data is named like component types (see ComponentTypeHash), so a component type's ID
+	 * names the data of its components; shared data that isn't a component, like the GL
+	 * context's textures, gets a name of its own.
+	 */
+	struct SystemAccess {
+		SystemAccess() : mainThread(false) { }
+
+		SystemAccess& Reads(const char* data) { return Reads(ComponentTypeHash(data)); }
+		SystemAccess& Reads(ComponentID data) { this->reads.push_back(data); return *this; }
+		SystemAccess& Writes(const char* data) { return Writes(ComponentTypeHash(data)); }
+		SystemAccess& Writes(ComponentID data) { this->writes.push_back(data); return *this; }
+		// The update must run on the thread calling SystemScheduler::Update, e.g. for a GL context
+		SystemAccess& OnMainThread() { this->mainThread = true; return *this; }
+
+		/**
+		 * \brief Whether two updates may not run at the same time.
+		 *
+		 * \return bool true if either one writes data the other reads or writes.
+		 */
+		DLL_EXPORT bool ConflictsWith(const SystemAccess& other) const;
+
+		std::vector<ComponentID> reads;
+		std::vector<ComponentID> writes;
+		bool mainThread;
+	};
+
+	/**
+	 * \brief Runs the updates of the systems each frame, concurrently where their data allows.
+	 *
+	 * Updates whose data conflict run in the order they were added; the others may overlap,
+	 * the ones marked OnMainThread on the calling thread and the rest on the job system's
+	 * workers. E.g. audio streaming and the CEF message loop overlap with the physics step,
+	 * while rendering waits for physics to move the transforms it draws.
+	 */
+	class SystemScheduler {
+	public:
+		typedef std::function<void(double delta)> UpdateFunction;
+
+		// How long an update took in the last frame
+		struct SystemTime {
+			SystemTime(const std::string& name) : name(name), seconds(0.0) { }
+			std::string name;
+			double seconds;
+		};
+
+		/**
+		 * \param[in] JobSystem & jobs The job system whose workers run the updates.
+		 */
+		DLL_EXPORT SystemScheduler(JobSystem& jobs);
+
+		/**
+		 * \brief Adds a system's update to the frame.
+		 *
+		 * \param[in] const std::string & name The name shown in the timings.
+		 * \param[in] const SystemAccess & access The data the update uses.
+		 * \param[in] UpdateFunction update Called once per frame with the frame's delta in seconds.
+		 */
+		DLL_EXPORT void Add(const std::string& name, const SystemAccess& access, UpdateFunction update);
+
+		/**
+		 * \brief Runs one frame of every update and waits for them.
+		 *
+		 * Must be called from the same thread every frame. If updates threw, the first exception
+		 * is rethrown once the others have finished.
+		 * \param[in] double delta The time since the last frame in seconds.
+		 */
+		DLL_EXPORT void Update(double delta);
+
+		/**
+		 * \brief How long each update took in the last frame, in the order they were added.
+		 */
+		const std::vector<SystemTime>& Timings() const { return this->timings; }
+
+		/**
+		 * \brief The wall clock time of the last frame, in seconds.
+		 *
+		 * Less than the sum of Timings() by the time the updates overlapped.
+		 */
+		double FrameTime() const { return this->frameTime; }
+	private:
+		SystemScheduler(const SystemScheduler&);
+		SystemScheduler& operator=(const SystemScheduler&);
+
+		struct System {
+			System(const SystemAccess& access, UpdateFunction update) : access(access), update(update), predecessors(0) { }
+			SystemAccess access;
+			UpdateFunction update;
+			std::vector<size_t> successors; // systems added later that conflict with this one
+			unsigned int predecessors;
+		};
+
+		void Start(size_t system, double delta); // queues a system whose predecessors are done
+		void Run(size_t system, double delta);
+		void Finish(size_t system, double delta, std::exception_ptr error);
+
+		JobSystem& jobs;
+		std::vector<System> systems;
+		std::vector<SystemTime> timings;
+		double frameTime;
+
+		// State of the running frame
+		std::unique_ptr<std::atomic<unsigned int>[]> waiting; // unfinished predecessors of each system
+		std::mutex mutex;
+		std::condition_variable changed; // signaled when mainReady or remaining change
+		std::vector<size_t> mainReady; // main thread systems ready to run, guarded by mutex
+		size_t remaining; // systems not finished, guarded by mutex
+		std::exception_ptr error; // first exception of the frame, guarded by mutex
+	};
+}
+
+#endif // SYSTEMSCHEDULER_H
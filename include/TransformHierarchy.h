@@ -0,0 +1,110 @@
+#pragma once
+#ifndef TRANSFORMHIERARCHY_H
+#define TRANSFORMHIERARCHY_H
+
+#include <vector>
+#include "JobSystem.h"
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief Orders a set of transforms by depth in their hierarchy, so they can be updated parents first.
+	 *
+	 * The transforms are numbered, e.g. by their slot in the TransformStore. Add places a
+	 * transform and its ancestors at their depth, walking up only to the first ancestor already
+	 * placed, so gathering is linear in the number of transforms. Update then runs a job on each
+	 * depth in turn, split across the job system, once the depth above it is done.
+	 *
+	 * The set is gathered again with Clear and Add whenever parents change.
+	 */
+	class TransformHierarchy {
+	public:
+		static const uint32_t NONE = 0xFFFFFFFF; // the parent of a root
+
+		DLL_EXPORT TransformHierarchy();
+
+		/**
+		 * \brief Starts gathering a new set of transforms.
+		 *
+		 * \param[in] size_t count The transforms are numbered below count.
+		 */
+		DLL_EXPORT void Clear(size_t count);
+
+		/**
+		 * \brief Adds a transform, and its ancestors, to the set.
+		 *
+		 * Adding a transform more than once is fine. A transform in a cycle of parents is placed
+		 * as if the cycle ended at it, as there is no right order for a cycle.
+		 * \param[in] uint32_t index The transform.
+		 * \param[in] ParentOf parentOf uint32_t(uint32_t index), the parent of a transform, NONE for a root.
+		 */
+		template <typename ParentOf>
+		void Add(uint32_t index, ParentOf parentOf) {
+			if (this->depths[index] != UNVISITED) {
+				return;
+			}
+			uint32_t depth = 0;
+			uint32_t current = index;
+			while (true) {
+				// Mark it before visiting the parents, so a cycle ends instead of looping forever
+				this->depths[current] = VISITING;
+				this->path.push_back(current);
+				const uint32_t parent = parentOf(current);
+				if (parent == NONE || this->depths[parent] == VISITING) {
+					break;
+				}
+				if (this->depths[parent] != UNVISITED) {
+					depth = this->depths[parent] + 1;
+					break;
+				}
+				current = parent;
+			}
+			// path runs from index up to the topmost ancestor found
+			for (auto itr = this->path.rbegin(); itr != this->path.rend(); ++itr, ++depth) {
+				Place(*itr, depth);
+			}
+			this->path.clear();
+		}
+
+		/**
+		 * \brief Runs a job on every transform of the set, parents before children.
+		 *
+		 * \param[in] JobSystem * jobs The job system to split each depth across, nullptr to run on the calling thread.
+		 * \param[in] size_t grain The fewest transforms per job.
+		 * \param[in] Job job void(uint32_t index), called at once for transforms of the same depth.
+		 */
+		template <typename Job>
+		void Update(JobSystem* jobs, size_t grain, const Job& job) const {
+			for (size_t d = 0; d < this->depth; ++d) {
+				const uint32_t* indices = this->levels[d].data();
+				auto update = [indices, &job] (size_t begin, size_t end) {
+					for (size_t i = begin; i < end; ++i) {
+						job(indices[i]);
+					}
+				};
+				if (jobs) {
+					jobs->ParallelFor(0, this->levels[d].size(), grain, update);
+				}
+				else {
+					update(0, this->levels[d].size());
+				}
+			}
+		}
+
+		// The number of depths in the set, and the transforms at one of them
+		size_t Depth() const { return this->depth; }
+		const std::vector<uint32_t>& Level(size_t depth) const { return this->levels[depth]; }
+	private:
+		static const uint32_t UNVISITED = 0xFFFFFFFF;
+		static const uint32_t VISITING = 0xFFFFFFFE;
+
+		void Place(uint32_t index, uint32_t depth);
+
+		std::vector<std::vector<uint32_t>> levels; // the transforms at each depth
+		size_t depth; // the levels in use
+		std::vector<uint32_t> depths; // of each transform, UNVISITED if it isn't in the set
+		std::vector<uint32_t> path; // the transforms Add is walking up
+	};
+}
+
+#endif // TRANSFORMHIERARCHY_H
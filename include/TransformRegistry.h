@@ -0,0 +1,58 @@
+#pragma once
+#ifndef TRANSFORMREGISTRY_H
+#define TRANSFORMREGISTRY_H
+
+#include "Sigma.h"
+
+namespace Sigma {
+	class GLTransform;
+
+	/**
+	 * \brief Finds the transform of an entity, for every system.
+	 *
+	 * The system creating an entity's visible component registers its transform here, and
+	 * physics, audio or game code look it up in O(1) by entity ID, without knowing which
+	 * system or component type holds it. The table is paged by entity index (see EntityIndex)
+	 * and keeps the full ID, so the ID of a deleted entity finds nothing once its slot is reused.
+	 *
+	 * An entity has at most one registered transform; the first one registered stays until it
+	 * is unregistered. Lookups don't change the table, so they are safe from any thread while
+	 * no transform is registered or unregistered. Registering is not thread safe; do it from
+	 * the thread creating the components.
+	 */
+	class TransformRegistry {
+	public:
+		/**
+		 * \brief Registers the transform of an entity.
+		 *
+		 * \param[in] id_t entityID The entity.
+		 * \param[in] GLTransform * transform The transform, owned by one of the entity's components.
+		 * \return bool true if it was registered, false if the entity already has a transform.
+		 */
+		DLL_EXPORT static bool Register(id_t entityID, GLTransform* transform);
+
+		/**
+		 * \brief Unregisters the transform of an entity, if it is the one registered.
+		 *
+		 * Call it when the component owning the transform is removed.
+		 * \param[in] id_t entityID The entity.
+		 * \param[in] const GLTransform * transform The transform going away.
+		 */
+		DLL_EXPORT static void Unregister(id_t entityID, const GLTransform* transform);
+
+		/**
+		 * \brief Looks up the transform of an entity.
+		 *
+		 * \param[in] id_t entityID The entity.
+		 * \return GLTransform* The transform, or nullptr if the entity has none.
+		 */
+		DLL_EXPORT static GLTransform* Get(id_t entityID);
+
+		/**
+		 * \brief Unregisters every transform.
+		 */
+		DLL_EXPORT static void Clear();
+	};
+}
+
+#endif // TRANSFORMREGISTRY_H
@@ -0,0 +1,189 @@
+#pragma once
+#ifndef TRANSFORMSTORE_H
+#define TRANSFORMSTORE_H
+
+#include <memory>
+#include <vector>
+#include "JobSystem.h"
+#include "TransformHierarchy.h"
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief Central storage of every transform's position, orientation and scale, and of the matrices made from them.
+	 *
+	 * The data is laid out as structure of arrays, in pages of SLOTS_PER_PAGE slots: the positions,
+	 * quaternions and scales each have their own array, so composing the matrices of many
+	 * transforms streams through just the data it reads, four transforms at a time with SSE.
+	 * The local and world matrices are kept per slot, ready to upload.
+	 *
+	 * A GLTransform only holds a handle into the store. Handles carry the slot's generation,
+	 * like entity IDs, so the handle of a destroyed transform is never mistaken for the one
+	 * reusing its slot; a child whose parent is destroyed becomes a root.
+	 *
+	 * Update brings every matrix up to date once per frame, parents first. GetWorldMatrix
+	 * brings a single one up to date, for code that moves a transform and reads it back in
+	 * the same frame. Create, Destroy and SetParent must not run while Update does.
+	 */
+	class TransformStore {
+	public:
+		typedef uint32_t Handle;
+
+		static const Handle NONE = 0xFFFFFFFF;
+		static const unsigned int HANDLE_INDEX_BITS = 24;
+		static const unsigned int PAGE_BITS = 10;
+		static const size_t SLOTS_PER_PAGE = 1 << PAGE_BITS;
+
+		// Slot flags
+		static const uint8_t ALIVE = 1;
+		static const uint8_t LOCAL_DIRTY = 2; // the local matrix is out of date
+		static const uint8_t WORLD_DIRTY = 4; // the world matrix is out of date
+
+		struct Page {
+			float px[SLOTS_PER_PAGE], py[SLOTS_PER_PAGE], pz[SLOTS_PER_PAGE]; // position
+			float qx[SLOTS_PER_PAGE], qy[SLOTS_PER_PAGE], qz[SLOTS_PER_PAGE], qw[SLOTS_PER_PAGE]; // orientation, a unit quaternion
+			float sx[SLOTS_PER_PAGE], sy[SLOTS_PER_PAGE], sz[SLOTS_PER_PAGE]; // scale
+			float local[SLOTS_PER_PAGE][16]; // translation * rotation * scale, column-major
+			float world[SLOTS_PER_PAGE][16]; // parent's world matrix * local
+			Handle parent[SLOTS_PER_PAGE];
+			uint32_t worldVersion[SLOTS_PER_PAGE]; // counts the changes of world, so children can tell theirs is stale
+			uint32_t parentVersion[SLOTS_PER_PAGE]; // the parent's worldVersion when world was computed
+			uint8_t generation[SLOTS_PER_PAGE];
+			uint8_t flags[SLOTS_PER_PAGE];
+			bool dirty; // some slot has LOCAL_DIRTY set
+		};
+
+		/**
+		 * \brief The store the GLTransforms live in.
+		 *
+		 * It is never destroyed, so transforms in static objects can outlive main.
+		 */
+		DLL_EXPORT static TransformStore& Instance();
+
+		DLL_EXPORT TransformStore();
+
+		/**
+		 * \brief Creates an identity transform with no parent.
+		 *
+		 * \return Handle The new transform's handle.
+		 */
+		DLL_EXPORT Handle Create();
+
+		/**
+		 * \brief Destroys a transform, freeing its slot. Destroying an invalid handle does nothing.
+		 */
+		DLL_EXPORT void Destroy(Handle handle);
+
+		/**
+		 * \brief Copies the position, orientation, scale and parent of a transform onto another.
+		 */
+		DLL_EXPORT void Copy(Handle from, Handle to);
+
+		/**
+		 * \brief Checks whether a handle refers to a transform that wasn't destroyed.
+		 */
+		bool Valid(Handle handle) const {
+			const size_t index = Index(handle);
+			if (handle == NONE || index >= this->count) {
+				return false;
+			}
+			const Page& page = *this->pages[index >> PAGE_BITS];
+			const size_t slot = index & (SLOTS_PER_PAGE - 1);
+			return (page.flags[slot] & ALIVE) && page.generation[slot] == Generation(handle);
+		}
+
+		// The page and slot of a valid handle
+		Page& PageOf(Handle handle) { return *this->pages[Index(handle) >> PAGE_BITS]; }
+		const Page& PageOf(Handle handle) const { return *this->pages[Index(handle) >> PAGE_BITS]; }
+		static size_t Slot(Handle handle) { return Index(handle) & (SLOTS_PER_PAGE - 1); }
+
+		void SetPosition(Handle handle, float x, float y, float z) {
+			Page& page = PageOf(handle);
+			const size_t slot = Slot(handle);
+			page.px[slot] = x;
+			page.py[slot] = y;
+			page.pz[slot] = z;
+			MarkDirty(page, slot);
+		}
+
+		void SetOrientation(Handle handle, float x, float y, float z, float w) {
+			Page& page = PageOf(handle);
+			const size_t slot = Slot(handle);
+			page.qx[slot] = x;
+			page.qy[slot] = y;
+			page.qz[slot] = z;
+			page.qw[slot] = w;
+			MarkDirty(page, slot);
+		}
+
+		void SetScale(Handle handle, float x, float y, float z) {
+			Page& page = PageOf(handle);
+			const size_t slot = Slot(handle);
+			page.sx[slot] = x;
+			page.sy[slot] = y;
+			page.sz[slot] = z;
+			MarkDirty(page, slot);
+		}
+
+		/**
+		 * \brief Sets the transform a transform is relative to.
+		 *
+		 * \param[in] Handle handle The child.
+		 * \param[in] Handle parent The parent, NONE to make the child a root.
+		 */
+		DLL_EXPORT void SetParent(Handle handle, Handle parent);
+
+		/**
+		 * \brief Returns the world matrix of a transform, bringing it and its parents' up to date first.
+		 *
+		 * Only composes and multiplies the matrices that changed, so it is cheap to call
+		 * repeatedly. Transforms sharing a parent must not be read from different threads at once.
+		 * \return const float* The column-major matrix.
+		 */
+		DLL_EXPORT const float* GetWorldMatrix(Handle handle);
+
+		/**
+		 * \brief Brings every matrix up to date, parents before children.
+		 *
+		 * The local matrices of a page are composed in one pass over its arrays, then the world
+		 * matrices are updated one depth of the hierarchy at a time.
+		 * \param[in] JobSystem * jobs The job system to split the work across, nullptr to update on the calling thread.
+		 */
+		DLL_EXPORT void Update(JobSystem* jobs);
+
+		// The number of live transforms
+		size_t Size() const { return this->count - this->freeSlots.size(); }
+
+		/**
+		 * \brief Composes the local matrices of the dirty slots in [begin, end) of a page.
+		 *
+		 * \param[in] bool simd Whether to use SSE, if it was compiled in; the results are the same.
+		 */
+		DLL_EXPORT static void ComposeLocal(Page& page, size_t begin, size_t end, bool simd = true);
+
+		// Whether ComposeLocal and the matrix products were compiled with SSE
+		DLL_EXPORT static bool HasSIMD();
+	private:
+		static size_t Index(Handle handle) { return handle & ((1u << HANDLE_INDEX_BITS) - 1); }
+		static uint8_t Generation(Handle handle) { return static_cast<uint8_t>(handle >> HANDLE_INDEX_BITS); }
+
+		static void MarkDirty(Page& page, size_t slot) {
+			page.flags[slot] |= LOCAL_DIRTY;
+			page.dirty = true;
+		}
+
+		// Recomputes the world matrix of a slot if it or its parent changed, the parent must be up to date
+		void UpdateWorld(size_t index);
+		void BuildOrder();
+
+		std::vector<std::unique_ptr<Page>> pages;
+		size_t count; // slots handed out so far, live or free
+		std::vector<uint32_t> freeSlots;
+
+		unsigned int structureVersion; // bumped whenever a transform comes, goes or changes parent
+		unsigned int orderVersion; // the structureVersion hierarchy was gathered for
+		TransformHierarchy hierarchy; // the live slots, by depth
+	};
+}
+
+#endif // TRANSFORMSTORE_H
@@ -9,6 +9,7 @@
 #include "ISound.h"
 #include "glm/glm.hpp"
 #include "systems/OpenALSystem.h"
+#include "FrameAllocator.h"
 
 #define ALSOUND_BUFFERS 4
 namespace Sigma {
@@ -45,7 +46,11 @@ namespace Sigma {
 
 		ALuint GetID() { return sourceid; }
 	protected:
-		void Update();
+		// Looks up the sound file Update streams from and reads its format. Sound files are
+		// shared between sounds, so this runs on the system's thread before the sounds update.
+		void Prepare();
+		// Streams the next buffers; the decoded samples are put in scratch, which may be reset afterwards
+		void Update(FrameAllocator& scratch);
 		ALuint sourceid;
 		bool stream;
 		int buffers[ALSOUND_BUFFERS];
@@ -54,6 +59,7 @@ namespace Sigma {
 		int buffercount;
 		int bufferloaded;
 		resource::Decoder codec;
+		std::shared_ptr<resource::SoundFile> file; // the file Update streams from, set by Prepare
 		OpenALSystem *master;
 	};
 } // namespace Sigma
@@ -1,13 +1,32 @@
 #pragma once
+#include <memory>
 #include "../IBulletShape.h"
 #include "Sigma.h"
 
 namespace Sigma{
 	class GLMesh;
+	struct MeshData;
+
+	/**
+	 * The triangles of a mesh file and the BVH built over them. It is built once per file,
+	 * on any thread, and shared by every BulletShapeMesh of that file through a scaled shape.
+	 */
+	struct CollisionMesh {
+		/**
+		 * \brief Builds the triangle mesh and its BVH.
+		 *
+		 * \param mesh The mesh data to build from.
+		 */
+		void Build(const MeshData& mesh);
+
+		btTriangleMesh triangles;
+		std::unique_ptr<btBvhTriangleMeshShape> bvh;
+	};
+
 	class BulletShapeMesh : public IBulletShape {
 	public:
 		SET_COMPONENT_TYPENAME("BulletShapeMesh");
-		BulletShapeMesh(const id_t entityID = 0) : IBulletShape(entityID) { }
+		BulletShapeMesh(const id_t entityID = 0) : IBulletShape(entityID), btmesh(nullptr) { }
 		~BulletShapeMesh() {
 			if (this->btmesh != nullptr) {
 				delete this->btmesh;
@@ -18,7 +37,16 @@ namespace Sigma{
 		void SetMesh(const GLMesh* mesh, float scale);
 		void SetMesh(const GLMesh* mesh);
 
+		/**
+		 * \brief Uses a shared collision mesh, scaled evenly in all dimensions.
+		 *
+		 * \param mesh The collision mesh, kept alive as long as this shape.
+		 * \param scale The scale of the shape.
+		 */
+		void SetMesh(std::shared_ptr<CollisionMesh> mesh, float scale);
+
 	private:
 		btTriangleMesh* btmesh;
+		std::shared_ptr<CollisionMesh> collisionMesh;
 	};
 }
@@ -31,6 +31,17 @@ namespace Sigma {
          */
         void Render(glm::mediump_float *view, glm::mediump_float *proj);
 
+        /**
+         * \brief Returns the model matrix, moved to the camera if the sphere is fixed to it
+         *
+         * \param view The current view matrix
+         * \return glm::mat4 The model matrix to draw with
+         */
+        glm::mat4 DrawMatrix(const glm::mat4& view) const;
+
+        // The cube map
+        unsigned int MaterialKey() const { return this->_cubeMap; }
+
         /**
          * \brief Returns the number of elements to draw for this component.
          *
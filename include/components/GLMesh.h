@@ -25,6 +25,37 @@ namespace Sigma{
         VertexIndices v[3];
     };
 
+    // A texture map named in a material file
+    struct MaterialTexture {
+        std::string file; // as written in the material file
+        std::string path; // directory of the material file
+    };
+
+    struct MaterialTextures {
+        MaterialTexture ambient;
+        MaterialTexture diffuse;
+        MaterialTexture normal;
+    };
+
+    /**
+     * The geometry and materials of a mesh file. It holds no OpenGL objects, so it can be
+     * loaded on any thread, and it is shared by every mesh loaded from the same file.
+     */
+    struct MeshData {
+        std::vector<unsigned int> groupIndex;
+        std::vector<Face> faces;
+        std::map<unsigned int, std::string> faceGroups;
+        std::vector<Vertex> verts;
+        std::vector<Vertex> vertNorms;
+        std::vector<TexCoord> texCoords;
+        std::vector<Color> colors;
+        std::map<std::string, Material> mats; // without their texture maps
+        std::map<std::string, MaterialTextures> matTextures; // the texture maps of mats
+    };
+
+    // The vertex array and buffers of a mesh file set up for a shader, see GLMesh::InitializeBuffers
+    struct MeshGeometry;
+
     class GLMesh : public IGLComponent {
     public:
         using IGLComponent::LoadShader;
@@ -36,10 +67,16 @@ namespace Sigma{
         /**
          * \brief Initializes the mesh in the OpenGL context.
          *
-         * \param entityID The entity this component belongs to.
+         * Meshes loaded from the same file with the same shader share one vertex array and its
+         * buffers, made by the first of them, so that they can be drawn as instances of each other.
          */
         void InitializeBuffers();
 
+        /**
+         * \brief Deletes the buffers and VAO, or lets go of them if they are shared.
+         */
+        void DeleteBuffers();
+
         /** \brief render the mesh with
          *
          * Uses the given view and projection matrices. additional uniforms may be set in the args array.
@@ -49,6 +86,13 @@ namespace Sigma{
          * \return void
          */
         virtual void Render(glm::mediump_float *view, glm::mediump_float *proj);
+        virtual void RenderInstances(glm::mediump_float *view, glm::mediump_float *proj, unsigned int instances);
+
+        // Meshes sharing this one's vertex array, culling and textures
+        virtual bool InstancesWith(const IGLComponent& other) const;
+
+        // The diffuse (or else ambient) map of the first material
+        virtual unsigned int MaterialKey() const;
 
         /**
          * \brief Returns the number of elements to draw for this component.
@@ -74,9 +118,35 @@ namespace Sigma{
 			}
 		}
 
+        /**
+         * \brief Loads a mesh file and the textures of its materials.
+         *
+         * The file is only parsed once (see GetMeshData). Must be called on the thread
+         * owning the OpenGL context, as it creates the textures.
+         * \param fname The mesh file.
+         * \return bool false if the file couldn't be loaded.
+         */
         bool LoadMesh(std::string fname);
 
-        void ParseMTL(std::string fname);
+        /**
+         * \brief Gets the parsed contents of a mesh file, parsing it the first time.
+         *
+         * Thread safe, so the scene loader can parse meshes on worker threads.
+         * \param fname The mesh file.
+         * \return std::shared_ptr<const MeshData> The mesh data, empty if the file couldn't be loaded.
+         */
+        static std::shared_ptr<const MeshData> GetMeshData(const std::string& fname);
+
+        /**
+         * \brief Parses an OBJ file and its material files.
+         *
+         * \param fname The mesh file.
+         * \param data The mesh data to fill.
+         * \return bool false if the file couldn't be opened.
+         */
+        static bool LoadMeshData(const std::string& fname, MeshData& data);
+
+        static void ParseMTL(const std::string& fname, MeshData& data);
 
         /**
          * \brief Add a vertex to the list.
@@ -197,6 +267,9 @@ namespace Sigma{
 		std::string texReplace;
 		std::string texReplaceWith;
 	protected:
+		// Resolves the texture maps of data's materials into mats, loading the textures
+		void LoadTextures(const MeshData& data);
+
 		// Note that these values are protected, not private! Inheriting classes get access to these
 		//  basic drawing elements.
 		std::vector<unsigned int> groupIndex; // Stores which index in faces a group starts at.
@@ -209,6 +282,8 @@ namespace Sigma{
 		std::vector<Color> colors;
 		std::map<std::string, Material> mats;
 
+		std::string meshFile; // The file loaded, empty for meshes made some other way.
+		std::shared_ptr<MeshGeometry> geometry; // The shared vertex array of meshFile, if it is set up.
 	}; // class GLMesh
 
 } // namespace Sigma
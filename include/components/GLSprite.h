@@ -34,6 +34,9 @@ namespace Sigma{
          */
         virtual void Render(glm::mediump_float *view, glm::mediump_float *proj);
 
+        // The texture drawn
+        virtual unsigned int MaterialKey() const;
+
 		/**
 		 * \brief Set the GLTexture resource
 		 *
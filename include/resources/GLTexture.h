@@ -9,9 +9,73 @@
 #include <cassert>
 
 #include "SOIL/SOIL.h"
+#include "systems/GLState.h"
 
 namespace Sigma {
 	namespace resource {
+		/**
+		 * A decoded image in RAM, flipped for OpenGL. Decoding doesn't touch OpenGL, so it can
+		 * be done on any thread and uploaded later with GLTexture::LoadDataFromImage.
+		 */
+		class ImageData {
+		public:
+			ImageData() : data(nullptr), width(0), height(0), channels(0) { }
+			~ImageData() {
+				if (this->data) {
+					SOIL_free_image_data(this->data);
+				}
+			}
+
+			/**
+			 * Decodes an image file
+			 * \param filename Path to the image file
+			 * \return false if the file couldn't be decoded
+			 */
+			bool LoadFromFile(const std::string& filename) {
+				int width, height, channels;
+				unsigned char* data = SOIL_load_image(filename.c_str(), &width, &height, &channels, false);
+				if (!data) {
+					return false;
+				}
+
+				// Invert Y (necesary!)
+				int i, j;
+				for( j = 0; j*2 < height; ++j ) {
+					int index1 = j * width * channels;
+					int index2 = (height - 1 - j) * width * channels;
+					for( i = width * channels; i > 0; --i ) {
+						unsigned char temp = data[index1];
+						data[index1] = data[index2];
+						data[index2] = temp;
+						++index1;
+						++index2;
+					}
+				}
+
+				if (this->data) {
+					SOIL_free_image_data(this->data);
+				}
+				this->data = data;
+				this->width = width >= 0 ? width : 0;
+				this->height = height >= 0 ? height : 0;
+				this->channels = channels;
+				return true;
+			}
+
+			const unsigned char* Data() const { return data; }
+			unsigned int Width() const { return width; }
+			unsigned int Height() const { return height; }
+			int Channels() const { return channels; }
+		private:
+			ImageData(const ImageData&);
+			ImageData& operator=(const ImageData&);
+
+			unsigned char* data;
+			unsigned int width;
+			unsigned int height;
+			int channels;
+		};
+
 		/**
 		 * Represents a OpenGL Texture
 		 */
@@ -43,11 +107,10 @@ namespace Sigma {
 				this->width = width;
 				this->height = height;
 
-				glBindTexture(GL_TEXTURE_2D, this->id);
+				GLState::Get().BindTexture(GL_TEXTURE_2D, this->id);
 				glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->mag_filter);
 				glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->min_filter);
 				glTexImage2D(GL_TEXTURE_2D, 0, this->int_format, this->width, this->height, 0, this->format, GL_UNSIGNED_BYTE, NULL);
-				glBindTexture(GL_TEXTURE_2D, 0);
 			}
 
 			/**
@@ -64,7 +127,7 @@ namespace Sigma {
 				this->width = width;
 				this->height = height;
 
-				glBindTexture(GL_TEXTURE_2D, this->id);
+				GLState::Get().BindTexture(GL_TEXTURE_2D, this->id);
 
 				glTexImage2D(GL_TEXTURE_2D, 0, this->int_format , this->width, this->height, 0, this->format, this->type, data);
 
@@ -78,8 +141,6 @@ namespace Sigma {
 
 				glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->mag_filter);
 				glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->min_filter);
-
-				glBindTexture(GL_TEXTURE_2D, 0);
 			}
 
 			/**
@@ -92,11 +153,10 @@ namespace Sigma {
 				if (id != 0) {
 					assert (this->width > 0 && this->height > 0);
 
-					glBindTexture(GL_TEXTURE_2D, this->id);
+					GLState::Get().BindTexture(GL_TEXTURE_2D, this->id);
 					glTexSubImage2D(	GL_TEXTURE_2D, 0,
 										0, 0, this->width, this->height, 
 										this->format, this->type, data);
-					glBindTexture(GL_TEXTURE_2D, 0);
 				}
 			}
 
@@ -106,35 +166,20 @@ namespace Sigma {
 			 * \param options Struct that defines the format of the bitmap and how the GPU will interpret it
 			 */
 			void LoadDataFromFile(const std::string& filename) {
-				int width, height, channels;
-				unsigned char* data = SOIL_load_image(filename.c_str(), &width, &height, &channels, false);
-
-				if (data) {
-					// Invert Y (necesary!)
-					int i, j;
-					for( j = 0; j*2 < height; ++j ) {
-						int index1 = j * width * channels;
-						int index2 = (height - 1 - j) * width * channels;
-						for( i = width * channels; i > 0; --i ) {
-							unsigned char temp = data[index1];
-							data[index1] = data[index2];
-							data[index2] = temp;
-							++index1;
-							++index2;
-						}
-					}
-
-					if (width >= 0) {
-						this->width = width;
-					}
-					if (height >= 0) {
-						this->height = height;
-					}
-					LoadDataFromMemory(data, width, height);
-					delete data;
+				ImageData image;
+				if (image.LoadFromFile(filename)) {
+					LoadDataFromImage(image);
 				}
 			}
 
+			/**
+			 * Creates a texture from an image decoded with ImageData::LoadFromFile
+			 * \param image The decoded image
+			 */
+			void LoadDataFromImage(const ImageData& image) {
+				LoadDataFromMemory(image.Data(), image.Width(), image.Height());
+			}
+
 			unsigned int GetID() const { return id; }
 
 			/**
@@ -172,9 +217,8 @@ namespace Sigma {
 			void WrapS(GLint val) {
 				wrap_s = val;
 				if (id != 0) {
-					glBindTexture(GL_TEXTURE_2D, this->id);
+					GLState::Get().BindTexture(GL_TEXTURE_2D, this->id);
 					glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_s);
-					glBindTexture(GL_TEXTURE_2D, 0);
 				}
 			}
 
@@ -183,9 +227,8 @@ namespace Sigma {
 			void WrapT(GLint val) {
 				wrap_t = val;
 				if (id != 0) {
-					glBindTexture(GL_TEXTURE_2D, this->id);
+					GLState::Get().BindTexture(GL_TEXTURE_2D, this->id);
 					glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_t);
-					glBindTexture(GL_TEXTURE_2D, 0);
 				}
 			}
 
@@ -194,9 +237,8 @@ namespace Sigma {
 			void WrapR(GLint val) {
 				wrap_r = val;
 				if (id != 0) {
-					glBindTexture(GL_TEXTURE_2D, this->id);
+					GLState::Get().BindTexture(GL_TEXTURE_2D, this->id);
 					glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, wrap_r);
-					glBindTexture(GL_TEXTURE_2D, 0);
 				}
 			}
 
@@ -215,9 +257,8 @@ namespace Sigma {
 			void MagFilter(GLint val) {
 				mag_filter = val; 
 				if (id != 0) {
-					glBindTexture(GL_TEXTURE_2D, this->id);
+					GLState::Get().BindTexture(GL_TEXTURE_2D, this->id);
 					glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter);
-					glBindTexture(GL_TEXTURE_2D, 0);
 				}
 			}
 
@@ -226,9 +267,8 @@ namespace Sigma {
 			void MinFilter(GLint val) {
 				min_filter = val;
 				if (id != 0) {
-					glBindTexture(GL_TEXTURE_2D, this->id);
+					GLState::Get().BindTexture(GL_TEXTURE_2D, this->id);
 					glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
-					glBindTexture(GL_TEXTURE_2D, 0);
 				}
 			}
 
@@ -0,0 +1,88 @@
+#pragma once
+#ifndef RESOURCECACHE_H
+#define RESOURCECACHE_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <unordered_map>
+
+namespace Sigma {
+	namespace resource {
+		/**
+		 * \brief A thread safe cache of resources loaded from files, keyed by name.
+		 *
+		 * Each resource is loaded once: a thread that asks for a resource another thread is
+		 * loading waits for that load instead of starting its own. This lets the scene loader
+		 * decode resources on worker threads while the main thread picks them up.
+		 */
+		template <class T>
+		class ResourceCache {
+		public:
+			typedef std::shared_ptr<T> Handle;
+
+			/**
+			 * \brief Gets a resource, loading it the first time it is asked for.
+			 *
+			 * \param[in] const std::string & name The name of the resource, usually its file name.
+			 * \param[in] Loader load Called as bool load(name, T&) to fill a new resource, returns false on failure.
+			 * \return   Handle The resource, or an empty handle if it failed to load. Failures are cached too.
+			 */
+			template <class Loader>
+			Handle Load(const std::string& name, Loader load) {
+				std::promise<Handle> promise;
+				std::shared_future<Handle> result;
+				bool owner = false;
+				{
+					std::lock_guard<std::mutex> lock(this->mutex);
+					auto found = this->entries.find(name);
+					if (found != this->entries.end()) {
+						result = found->second;
+					}
+					else {
+						result = promise.get_future().share();
+						this->entries[name] = result;
+						owner = true;
+					}
+				}
+
+				// Only the thread that added the entry loads it, outside the lock
+				if (owner) {
+					try {
+						Handle resource(new T());
+						if (!load(name, *resource)) {
+							resource.reset();
+						}
+						promise.set_value(resource);
+					}
+					catch (...) {
+						promise.set_exception(std::current_exception());
+					}
+				}
+				return result.get();
+			}
+
+			/**
+			 * \brief Forgets a resource.
+			 *
+			 * Handles already given out stay valid. The next Load of the name loads it again.
+			 * \param[in] const std::string & name The name of the resource.
+			 */
+			void Remove(const std::string& name) {
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->entries.erase(name);
+			}
+
+			void Clear() {
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->entries.clear();
+			}
+		private:
+			std::mutex mutex;
+			std::unordered_map<std::string, std::shared_future<Handle>> entries;
+		};
+	}
+}
+
+#endif // RESOURCECACHE_H
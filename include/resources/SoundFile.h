@@ -94,8 +94,10 @@ namespace Sigma {
 				}
 			}
 			void ProcessMeta() {
-				Decoder d;
-				d.ProcessMeta(*this);
+				if(!hasmeta) {
+					Decoder d;
+					d.ProcessMeta(*this);
+				}
 			}
 		protected:
 			unsigned char* data;
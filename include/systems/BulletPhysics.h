@@ -5,8 +5,11 @@
 #include "bullet/btBulletDynamicsCommon.h"
 #include "IBulletShape.h"
 #include "components/PhysicsController.h"
+#include "SystemScheduler.h"
 #include "Sigma.h"
 #include "components/BulletShapeCapsule.h"
+#include "components/BulletShapeMesh.h"
+#include "resources/ResourceCache.h"
 
 class Property;
 class IMoverComponent;
@@ -28,22 +31,37 @@ namespace Sigma {
 		/**
 		 * \brief Causes an update in the system based on the change in time.
 		 *
-		 * Updates the state of the system based off how much time has elapsed since the last update.
+		 * Steps the simulation by exactly delta, so call it with the fixed step of a FixedStepClock
+		 * as many times as the clock says.
 		 * \param[in] const float delta The change in time since the last update
 		 * \return bool Returns true if we had an update interval passed.
 		 */
 		DLL_EXPORT bool Update(const double delta);
 
+		/**
+		 * \brief The data Update reads and writes, for the SystemScheduler.
+		 */
+		DLL_EXPORT static SystemAccess DataAccess();
+
 		DLL_EXPORT IComponent* createBulletShapeMesh(const id_t entityID, const std::vector<Property> &properties);
 		DLL_EXPORT IComponent* createBulletShapeSphere(const id_t entityID, const std::vector<Property> &properties);
 
 		std::map<std::string,FactoryFunction> getFactoryFunctions();
+		std::map<std::string,PreloadFunction> getPreloadFunctions();
 
 		DLL_EXPORT void initViewMover(GLTransform& t);
 		PhysicsController* getViewMover() {
 			return this->mover;
 		}
+	protected:
+		// Takes the shape's rigid body out of the dynamics world before the shape is destroyed
+		void cleanupComponent(IBulletShape* component) override;
 	private:
+		// Builds the collision mesh of a BulletShapeMesh, run on the scene loader's worker threads
+		void PreloadBulletShapeMesh(const std::vector<Property> &properties);
+
+		resource::ResourceCache<CollisionMesh> collisionMeshes; // by mesh file
+
 		btBroadphaseInterface* broadphase;
 		btDefaultCollisionConfiguration* collisionConfiguration;
 		btCollisionDispatcher* dispatcher;
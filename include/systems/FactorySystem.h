@@ -27,10 +27,45 @@ namespace Sigma {
                         const id_t entityID,
                         const std::vector<Property> &properties);
 
+            /**
+             * \brief Create a new component of a given type ID.
+             *
+             * Like create by name, without hashing the name. Parsed scenes carry the ID of each component type.
+             * \param[in] ComponentID typeID The ComponentTypeHash of the type of component to create
+             * \param[in] const id_t entityID The ID of the entity this component belongs to.
+             * \param[in] std::vector<Property> &properties A vector containing the properties to apply to the created component.
+             * \return a pointer to the newly created component
+             */
+            DLL_EXPORT IComponent* create(ComponentID typeID,
+                        const id_t entityID,
+                        const std::vector<Property> &properties);
+
+            /**
+             * \brief Prepares the resources of a component before it is created.
+             *
+             * Calls the preload function registered for the type, if any. Unlike create, this
+             * may be called from any thread, once every factory has been registered.
+             * \param[in] const std::string type The type of component that will be created
+             * \param[in] std::vector<Property> &properties The properties the component will be created with.
+             */
+            DLL_EXPORT void preload(const std::string& type,
+                        const std::vector<Property> &properties) const;
+
+            /**
+             * \brief Prepares the resources of a component of a given type ID before it is created.
+             *
+             * Like preload by name, without hashing the name.
+             * \param[in] ComponentID typeID The ComponentTypeHash of the type of component that will be created
+             * \param[in] std::vector<Property> &properties The properties the component will be created with.
+             */
+            DLL_EXPORT void preload(ComponentID typeID,
+                        const std::vector<Property> &properties) const;
+
             /**
              * \brief add the given Factory to the central list
              *
-             *  All factory-functions returned by getFactoryFunctions() are
+             *  All factory-functions returned by getFactoryFunctions() and
+             *  preload-functions returned by getPreloadFunctions() are
              *  added (registered) to the central list of functions
              * \param[in] IFactory& Factory the factory whose functions will be registered
              */
@@ -43,9 +78,12 @@ namespace Sigma {
             FactorySystem& operator=(const FactorySystem& rhs);
             // the singleton instance
             static std::shared_ptr<FactorySystem> _instance;
-            // the map of name-->factory
-            std::unordered_map<std::string,IFactory::FactoryFunction>
+            // the map of type ID-->name and factory
+            std::unordered_map<ComponentID,std::pair<std::string,IFactory::FactoryFunction>>
                     registeredFactoryFunctions;
+            // the map of type ID-->preload function
+            std::unordered_map<ComponentID,IFactory::PreloadFunction>
+                    registeredPreloadFunctions;
 
     }; // class FactorySystem
 
@@ -9,7 +9,9 @@
 #include "GL/glew.h"
 #endif
 #include <map>
+#include "systems/GLState.h"
 #include <string>
+#include <vector>
 
 class GLSLShader
 {
@@ -22,22 +24,36 @@ public:
 	void Use();
 	void UnUse();
 	void AddAttribute(const std::string attribute);
-	void AddUniform(const std::string uniform);
+	void AddUniform(const std::string& uniform);
 	GLuint GetProgram() const;
 	
 	// ISSUE: This is a bit questionable as it violates the principle of least surprise
 	//An indexer that returns the location of the attribute/uniform
-	GLuint operator[](const std::string attribute);
-	GLuint operator()(const std::string uniform);
+	//These look the name up, draws use Sigma::GLUniform handles instead
+	GLuint operator[](const std::string& attribute);
+	GLuint operator()(const std::string& uniform);
+
+	//Uniform slots: each uniform name used by a Sigma::GLUniform gets a slot, and every program
+	//finds the locations of all the slots when it links, so a draw indexes a vector instead
+	static unsigned int UniformSlot(const std::string& uniform);
+	GLint Location(unsigned int slot) {
+		if (slot >= _slotLocations.size()) {
+			ResolveSlots(); // named after this program was linked
+		}
+		return _slotLocations[slot];
+	}
 	
 	//Program deletion
-	void DeleteProgram() {glDeleteProgram(_program);_program=-1;}
+	void DeleteProgram() {glDeleteProgram(_program);_program=-1;Sigma::GLState::Get().Invalidate();}
 	bool isLoaded() { return _program != 0; }
 private:
+	void ResolveSlots();
+
 	enum ShaderType {VERTEX_SHADER, FRAGMENT_SHADER, GEOMETRY_SHADER};
 	GLuint	_program;
 	int _totalShaders;
 	GLuint _shaders[3];//0->vertexshader, 1->fragmentshader, 2->geometryshader
 	std::map<std::string,GLuint> _attributeList;
 	std::map<std::string,GLuint> _uniformLocationList;
+	std::vector<GLint> _slotLocations; //indexed by slot, -1 for uniforms the program doesn't have
 };
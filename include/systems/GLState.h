@@ -0,0 +1,151 @@
+#pragma once
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#ifdef __APPLE__
+#include <OpenGL/gl3.h>
+#else
+#include "GL/glew.h"
+#endif
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * \brief A shadow copy of the OpenGL state, so setting what is already set never reaches the driver.
+	 *
+	 * The engine binds its programs, vertex arrays, buffers, textures and framebuffers, and sets
+	 * blending, depth and face culling, through it. Each draw sets the state it needs and leaves it
+	 * there; when the render queue puts draws sharing state next to each other, only the first one
+	 * actually changes it. The calls issued and avoided are counted.
+	 *
+	 * There is one OpenGL context, on the rendering thread, so there is one GLState. Code
+	 * changing the tracked state directly, or deleting objects whose names could be reused,
+	 * must call Invalidate afterwards; OpenGLSystem invalidates at the start of every frame,
+	 * as libraries such as SOIL bind textures while loading.
+	 */
+	class GLState {
+	public:
+		static const unsigned int TEXTURE_UNITS = 16; // tracked, the units above are always set
+		static const unsigned int UNIFORM_BINDINGS = 8; // likewise for uniform block binding points
+
+		DLL_EXPORT static GLState& Get();
+
+		DLL_EXPORT GLState();
+
+		/**
+		 * \brief Forgets the tracked state, so the next calls set it whatever it is.
+		 */
+		DLL_EXPORT void Invalidate();
+
+		DLL_EXPORT void UseProgram(GLuint program);
+
+		/**
+		 * \brief Binds a vertex array.
+		 *
+		 * The element array buffer binding is part of the vertex array, so it is forgotten when the vertex array changes.
+		 * \param[in] GLuint vao The vertex array.
+		 */
+		DLL_EXPORT void BindVertexArray(GLuint vao);
+
+		/**
+		 * \brief Binds a buffer.
+		 *
+		 * \param[in] GLenum target GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER and GL_UNIFORM_BUFFER are tracked, other targets are always bound.
+		 * \param[in] GLuint buffer The buffer.
+		 */
+		DLL_EXPORT void BindBuffer(GLenum target, GLuint buffer);
+
+		/**
+		 * \brief Binds a range of a buffer to an indexed binding point, and to the target.
+		 *
+		 * \param[in] GLenum target GL_UNIFORM_BUFFER is tracked, other targets are always bound.
+		 * \param[in] GLuint index The binding point.
+		 * \param[in] GLuint buffer The buffer.
+		 * \param[in] GLintptr offset The start of the range, in bytes.
+		 * \param[in] GLsizeiptr size The size of the range, in bytes.
+		 */
+		DLL_EXPORT void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+		/**
+		 * \brief Selects the texture unit BindTexture binds to.
+		 *
+		 * \param[in] GLuint unit The index of the unit, e.g. 1 for GL_TEXTURE1.
+		 */
+		DLL_EXPORT void ActiveTexture(GLuint unit);
+
+		/**
+		 * \brief Binds a texture to the active unit.
+		 *
+		 * \param[in] GLenum target GL_TEXTURE_2D and GL_TEXTURE_CUBE_MAP are tracked, other targets are always bound.
+		 * \param[in] GLuint texture The texture.
+		 */
+		DLL_EXPORT void BindTexture(GLenum target, GLuint texture);
+
+		/**
+		 * \brief Binds a texture to a unit, activating the unit if it isn't.
+		 *
+		 * \param[in] GLuint unit The index of the unit, e.g. 1 for GL_TEXTURE1.
+		 * \param[in] GLenum target The target, as for BindTexture.
+		 * \param[in] GLuint texture The texture.
+		 */
+		DLL_EXPORT void BindTexture(GLuint unit, GLenum target, GLuint texture);
+
+		DLL_EXPORT void Blend(bool enabled);
+		DLL_EXPORT void BlendFunc(GLenum source, GLenum destination);
+
+		DLL_EXPORT void DepthTest(bool enabled);
+		DLL_EXPORT void DepthFunc(GLenum func);
+		DLL_EXPORT void DepthMask(bool write);
+
+		/**
+		 * \brief Sets the faces culled.
+		 *
+		 * \param[in] GLenum mode GL_BACK, GL_FRONT or GL_FRONT_AND_BACK, 0 to disable culling.
+		 */
+		DLL_EXPORT void CullFace(GLenum mode);
+
+		/**
+		 * \brief Binds a framebuffer.
+		 *
+		 * \param[in] GLenum target GL_DRAW_FRAMEBUFFER, GL_READ_FRAMEBUFFER, or GL_FRAMEBUFFER for both.
+		 * \param[in] GLuint framebuffer The framebuffer, 0 for the window's.
+		 */
+		DLL_EXPORT void BindFramebuffer(GLenum target, GLuint framebuffer);
+
+		// The calls made to the driver, and the ones skipped as they wouldn't have changed anything
+		uint64_t Issued() const { return this->issued; }
+		uint64_t Avoided() const { return this->avoided; }
+		void ResetCounters() { this->issued = this->avoided = 0; }
+	private:
+		// Updates a tracked value and counts the call; returns whether it has to be made
+		bool Change(GLuint& tracked, GLuint value);
+
+		GLuint program;
+		GLuint vao;
+		GLuint arrayBuffer;
+		GLuint elementBuffer; // of the bound vertex array
+		GLuint uniformBuffer;
+		struct Range {
+			GLuint buffer;
+			GLintptr offset;
+			GLsizeiptr size;
+		} uniformRanges[UNIFORM_BINDINGS];
+		GLuint activeUnit;
+		GLuint texture2D[TEXTURE_UNITS];
+		GLuint textureCube[TEXTURE_UNITS];
+		GLuint blend; // booleans are 0 or 1, so they can be unknown too
+		GLuint blendSource;
+		GLuint blendDestination;
+		GLuint depthTest;
+		GLuint depthFunc;
+		GLuint depthMask;
+		GLenum cullFace; // 0 when culling is disabled
+		GLuint drawFramebuffer;
+		GLuint readFramebuffer;
+
+		uint64_t issued;
+		uint64_t avoided;
+	};
+}
+
+#endif // GLSTATE_H
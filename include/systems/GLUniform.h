@@ -0,0 +1,46 @@
+#pragma once
+#ifndef GLUNIFORM_H
+#define GLUNIFORM_H
+
+#include "systems/GLSLShader.h"
+#include "glm/glm.hpp"
+
+namespace Sigma {
+	// Set a uniform of the program in use, by type
+	inline void SetUniform(GLint location, GLint value) { glUniform1i(location, value); }
+	inline void SetUniform(GLint location, GLfloat value) { glUniform1f(location, value); }
+	inline void SetUniform(GLint location, const glm::vec3& value) { glUniform3fv(location, 1, &value[0]); }
+	inline void SetUniform(GLint location, const glm::vec4& value) { glUniform4fv(location, 1, &value[0]); }
+	inline void SetUniform(GLint location, const glm::mat4& value) { glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]); }
+
+	/**
+	 * \brief A typed handle to a uniform, usable with any shader.
+	 *
+	 * Making the handle gives the uniform's name a slot, and every shader finds the location
+	 * of each slot when it links, so setting the uniform neither hashes the name nor queries
+	 * OpenGL. Handles are meant to be made once, e.g. as statics. A shader without the
+	 * uniform has it at -1, which OpenGL ignores.
+	 */
+	template <typename T>
+	class GLUniform {
+	public:
+		explicit GLUniform(const std::string& name) : slot(GLSLShader::UniformSlot(name)) { }
+
+		/**
+		 * \brief Sets the uniform of a shader, which must be in use.
+		 *
+		 * \param[in] GLSLShader& shader The shader.
+		 * \param[in] const T& value The value.
+		 */
+		void Set(GLSLShader& shader, const T& value) const {
+			SetUniform(shader.Location(this->slot), value);
+		}
+
+		// The location in a shader, for values that aren't a T yet, e.g. a matrix as floats
+		GLint Location(GLSLShader& shader) const { return shader.Location(this->slot); }
+	private:
+		unsigned int slot;
+	};
+}
+
+#endif // GLUNIFORM_H
@@ -24,7 +24,26 @@ namespace Sigma{
 	struct Frustum {
 		Plane planes[6];
 
-		bool intersectsSphere(glm::vec3 position, float radius) {
+		/*
+		 * /brief Extracts the planes from a matrix
+		 *        The space the planes are in depends on matrix
+		 *        such that a Projection matrix only will yield camera space
+		 *        view*proj will yield world space
+		 */
+		void Extract(const glm::mat4& mvp) {
+			this->planes[0] = Plane(mvp[3]+mvp[0]);
+			this->planes[1] = Plane(mvp[3]-mvp[0]);
+			this->planes[2] = Plane(mvp[3]-mvp[1]);
+			this->planes[3] = Plane(mvp[3]+mvp[1]);
+			this->planes[4] = Plane(mvp[3]+mvp[2]);
+			this->planes[5] = Plane(mvp[3]-mvp[2]);
+
+			for(int i = 0; i < 6; ++i) {
+				this->planes[i].normalize();
+			}
+		}
+
+		bool intersectsSphere(glm::vec3 position, float radius) const {
 			float distToPlane;
 
 			// calculate our distances to each of the planes
@@ -69,19 +88,7 @@ namespace Sigma{
 		 *        view*proj will yield world space
 		 */
 		virtual void CalculateFrustum(glm::mat4 mvp) {
-			this->CameraFrustum.planes[0] = Plane(mvp[3]+mvp[0]);
-			this->CameraFrustum.planes[1] = Plane(mvp[3]-mvp[0]);
-			this->CameraFrustum.planes[2] = Plane(mvp[3]-mvp[1]);
-			this->CameraFrustum.planes[3] = Plane(mvp[3]+mvp[1]);
-			this->CameraFrustum.planes[4] = Plane(mvp[3]+mvp[2]);
-			this->CameraFrustum.planes[5] = Plane(mvp[3]-mvp[2]);
-
-			this->CameraFrustum.planes[0].normalize();
-			this->CameraFrustum.planes[1].normalize();
-			this->CameraFrustum.planes[2].normalize();
-			this->CameraFrustum.planes[3].normalize();
-			this->CameraFrustum.planes[4].normalize();
-			this->CameraFrustum.planes[5].normalize();
+			this->CameraFrustum.Extract(mvp);
 		}
 
 	}; // stuct IGLView
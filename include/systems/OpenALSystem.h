@@ -20,11 +20,25 @@
 #include <iostream>
 #include "resources/ALBuffer.h"
 #include "resources/SoundFile.h"
+#include "resources/ResourceCache.h"
 #include "components/ALSound.h"
+#include "JobSystem.h"
+#include "SystemScheduler.h"
+#include "EventBus.h"
 #include "Sigma.h"
 
 
 namespace Sigma {
+	class ALSound;
+
+	// Moves the listener, from any thread (see OpenALSystem::Subscribe)
+	struct ListenerMovedEvent {
+		SET_EVENT_TYPENAME("ListenerMovedEvent");
+		glm::vec3 position;
+		glm::vec3 forward;
+		glm::vec3 up;
+	};
+
 	class OpenALSystem
 		: public Sigma::IFactory, public ISystem<IComponent> {
 		friend class ALSound;
@@ -56,6 +70,23 @@ namespace Sigma {
 		 */
 		DLL_EXPORT bool Update();
 
+		/**
+		 * \brief The data Update reads and writes, for the SystemScheduler.
+		 */
+		DLL_EXPORT static SystemAccess DataAccess();
+
+		/**
+		 * \brief Handles the audio events of a bus: ListenerMovedEvent.
+		 */
+		DLL_EXPORT void Subscribe(EventBus& bus);
+
+		/**
+		 * \brief Sets the job system that streaming sounds decode on.
+		 *
+		 * \param jobs the job system, nullptr to decode on the calling thread
+		 */
+		DLL_EXPORT void SetJobSystem(JobSystem* jobs) { this->jobs = jobs; }
+
 		/**
 		 * \brief Set master gain.
 		 *
@@ -93,8 +124,9 @@ namespace Sigma {
 		 */
 		std::weak_ptr<resource::SoundFile> GetSoundFile(long i) {
 			std::weak_ptr<resource::SoundFile> p;
-			if (audiofiles.find(i) != audiofiles.end()) {
-				p = audiofiles[i];
+			auto found = audiofiles.find(i);
+			if (found != audiofiles.end()) {
+				p = found->second;
 			} else {
 				LOG_WARN << "Invalid Sound index: " << i;
 			}
@@ -106,20 +138,32 @@ namespace Sigma {
 		DLL_EXPORT void UpdateTransform(glm::vec3 pos, glm::vec3 forward, glm::vec3 up);
 
 		DLL_EXPORT void test();
+	protected:
+		// Stops a removed sound and releases its source and buffers
+		void cleanupComponent(IComponent* component) override;
 	private:
 		std::map<std::string,FactoryFunction> getFactoryFunctions();
+		std::map<std::string,PreloadFunction> getPreloadFunctions();
+		void PreloadALSource(const std::vector<Property> &);
 		int AllocateBuffer();
 		std::vector<std::unique_ptr<resource::ALBuffer>> buffers;
+		std::vector<int> freebuffers; // indices in buffers released by removed sounds
 		ALuint testsource;
 		ALuint lbuf;
 		std::map<std::string, long> audioindex;
 		std::map<long, std::shared_ptr<resource::SoundFile>> audiofiles;
+		resource::ResourceCache<resource::SoundFile> preloadedfiles; // read by worker threads, not yet in audiofiles
 		long nextindex;
 		int lbi;
 		bool altn;
 		ALCdevice* device;
 		ALCcontext* context;
 
+		ComponentBucket<ALSound> sounds; // Every ALSound in _Stores
+
+		JobSystem* jobs; // may be nullptr
+		FrameAllocator scratch; // decode buffers when there is no job system
+
 	}; // class OpenALSystem
 } // namespace Sigma
 
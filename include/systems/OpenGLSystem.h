@@ -17,8 +17,20 @@
 #include "IGLComponent.h"
 #include "systems/IGLView.h"
 #include <vector>
+#include <utility>
 #include "resources/GLTexture.h"
+#include "resources/ResourceCache.h"
 #include "components/GLScreenQuad.h"
+#include "components/PointLight.h"
+#include "components/SpotLight.h"
+#include "JobSystem.h"
+#include "SystemScheduler.h"
+#include "FixedStepClock.h"
+#include "TransformStore.h"
+#include "EventBus.h"
+#include "RenderQueue.h"
+#include "SnapshotPair.h"
+#include "systems/UniformBlocks.h"
 #include "Sigma.h"
 
 struct IGLView;
@@ -45,6 +57,70 @@ namespace Sigma{
 		void UnbindRead();
 	};
 
+	/**
+	 * \brief Everything OpenGLSystem draws in a frame, copied out of the components.
+	 *
+	 * The render passes only read a snapshot, so in pipelined mode the simulation can move
+	 * the components for the next frame while the last one is drawn. Models and the camera
+	 * keep their last two simulated states, and are drawn blended between them.
+	 */
+	struct RenderSnapshot {
+		// Identifies a model across snapshots by its entity, generation included, and component
+		// type. Not by its component's address: ComponentPool hands a freed block straight to the
+		// next component of the type, so a component created in the frame another one was deleted
+		// in would be taken for it.
+		typedef std::pair<id_t, ComponentID> ModelKey;
+
+		struct Model {
+			IGLComponent* component;
+			ModelKey key;
+			glm::mat4 previous; // at the step before the last one
+			glm::mat4 current; // at the last step
+			glm::mat4 matrix; // drawn, blended between the two
+		};
+		struct PointLightState {
+			glm::vec3 position;
+			float radius;
+			glm::vec4 color;
+		};
+		struct SpotLightState {
+			glm::vec3 position;
+			glm::vec3 direction;
+			glm::vec4 color;
+			float cosInnerAngle;
+			float cosOuterAngle;
+		};
+
+		// The passes of the render queue
+		enum Pass {
+			PASS_GBUFFER, // lit models
+			PASS_UNLIT
+		};
+
+		RenderSnapshot() : step(0) { }
+
+		// Drops a component's model and its draw
+		void Remove(const ModelKey& key);
+
+		uint64_t step; // FixedStepClock::TotalSteps() when captured
+		glm::mat4 previousView;
+		glm::mat4 currentView;
+		glm::mat4 viewMatrix; // drawn, blended between the two
+		glm::mat4 viewProjInv;
+		glm::vec3 viewPosition;
+		std::vector<Model> models;
+		RenderQueue queue; // the models to draw, indexing models, sorted to share state
+		std::vector<PointLightState> pointLights; // only the ones in the view frustum
+		std::vector<SpotLightState> spotLights; // only the enabled ones
+	};
+
+	// Turns a spot light on or off, from any thread (see OpenGLSystem::Subscribe)
+	struct SpotLightSwitchEvent {
+		SET_EVENT_TYPENAME("SpotLightSwitchEvent");
+		id_t entityID;
+		bool enabled;
+	};
+
 	class OpenGLSystem
 		: public Sigma::IFactory, public ISystem<IComponent> {
 	public:
@@ -68,6 +144,70 @@ namespace Sigma{
 		 */
 		DLL_EXPORT bool Update(const double delta);
 
+		/**
+		 * \brief The data Update reads and writes, for the SystemScheduler.
+		 *
+		 * \param pipelined true for the data of Update in pipelined mode, see SetPipelined
+		 */
+		DLL_EXPORT static SystemAccess DataAccess(bool pipelined = false);
+
+		/**
+		 * \brief The data CaptureSnapshot reads and writes, for the SystemScheduler.
+		 *
+		 * It updates the transforms' cached matrices, and reads the GL components, the view and
+		 * the lights. The model matrices Update sets on the GL components for drawing are data
+		 * of their own, GLModelMatrix, so capturing can overlap with drawing.
+		 */
+		DLL_EXPORT static SystemAccess SnapshotAccess();
+
+		/**
+		 * \brief Handles the rendering events of a bus: SpotLightSwitchEvent.
+		 */
+		DLL_EXPORT void Subscribe(EventBus& bus);
+
+		/**
+		 * \brief Turns pipelined rendering on or off.
+		 *
+		 * When on, Update draws the snapshot published in the previous frame instead of taking
+		 * its own. The caller runs CaptureSnapshot once the simulation is done, alongside Update,
+		 * and PublishSnapshot after both. GL calls then overlap with the simulation of the next
+		 * frame, at the cost of showing the scene one frame later.
+		 * \param pipelined true to turn pipelining on, it is off by default
+		 */
+		DLL_EXPORT void SetPipelined(bool pipelined) { this->pipelined = pipelined; }
+
+		/**
+		 * \brief Sets the clock the simulation steps by, to blend between its steps.
+		 *
+		 * Snapshots then draw models and the camera between their states at the last two steps,
+		 * by the clock's Alpha(), so motion is smooth whatever the step and frame rates are.
+		 * \param clock the clock, nullptr to draw the latest states as they are
+		 */
+		DLL_EXPORT void SetClock(const FixedStepClock* clock) { this->clock = clock; }
+
+		/**
+		 * \brief Copies the model matrices, visible lights and camera into the pending snapshot.
+		 *
+		 * Doesn't touch OpenGL, so it can run on any thread while Update draws the published snapshot.
+		 * Components must not be added or removed meanwhile.
+		 */
+		DLL_EXPORT void CaptureSnapshot();
+
+		/**
+		 * \brief Makes the pending snapshot the one Update draws next.
+		 *
+		 * Also drops the components removed since the last call from both snapshots, so it must
+		 * not run alongside CaptureSnapshot or Update.
+		 */
+		DLL_EXPORT void PublishSnapshot() { this->snapshots.Publish(); }
+
+		/**
+		 * \brief Sets the job system that transform updates and culling are split across
+		 *
+		 * \param jobs the job system, nullptr to do all the work on the calling thread
+		 */
+		DLL_EXPORT void SetJobSystem(JobSystem* jobs) { this->jobs = jobs; }
+
 		/**
 		 * \brief Sets the window width and height for glViewport
 		 *
@@ -88,11 +228,13 @@ namespace Sigma{
 		/**
 		 * \brief set the framerate at runtime
 		 *
-		 *  Note that the constructor sets a default of 60fps
+		 *  Note that the constructor sets a default of 60fps. Set 0 to render on every Update,
+		 *  when the main loop is paced by a FramePacer.
 		 */
 		DLL_EXPORT void SetFrameRate(double fr) { this->framerate = fr; }
 
 		std::map<std::string,FactoryFunction> getFactoryFunctions();
+		std::map<std::string,PreloadFunction> getPreloadFunctions();
 
 		DLL_EXPORT IComponent* createPointLight(const id_t entityID, const std::vector<Property> &properties);
 		DLL_EXPORT IComponent* createSpotLight(const id_t entityID, const std::vector<Property> &properties);
@@ -160,10 +302,53 @@ namespace Sigma{
 			}
 		}
 
+		/**
+		 * \brief Returns the transform of an entity's first GL component, see TransformRegistry.
+		 *
+		 * \param[in] const unsigned int entityID The entity.
+		 * \return GLTransform* The transform, or nullptr if the entity has no GL component.
+		 */
 		DLL_EXPORT GLTransform* GetTransformFor(const unsigned int entityID);
 
+		/**
+		 * \brief Gets a texture, loading it from a file the first time.
+		 *
+		 * Must be called on the thread owning the OpenGL context. The image is decoded here
+		 * unless PreloadTexture already decoded it.
+		 * \param[in] const std::string & name The name of the texture in textures.
+		 * \param[in] const std::string & path The image file, if empty only an already loaded texture is returned.
+		 * \return resource::GLTexture* The texture, or nullptr if it couldn't be loaded.
+		 */
+		DLL_EXPORT static resource::GLTexture* LoadTexture(const std::string& name, const std::string& path);
+
+		/**
+		 * \brief Decodes an image file for a later LoadTexture call.
+		 *
+		 * Doesn't touch OpenGL, so it can be called from any thread.
+		 * \param[in] const std::string & path The image file.
+		 */
+		DLL_EXPORT static void PreloadTexture(const std::string& path);
+
+		/**
+		 * \brief Frees the images decoded for LoadTexture.
+		 *
+		 * Decoded images are kept while a scene loads, so an image preloaded for several
+		 * components is decoded once; call this once the scene has loaded.
+		 */
+		DLL_EXPORT static void ReleaseDecodedImages();
+
 		static std::map<std::string, Sigma::resource::GLTexture> textures;
+	protected:
+		// Deletes the GL objects of a removed component and drops it from the view stack
+		void cleanupComponent(IComponent* component) override;
 	private:
+		// Preload functions, run on the scene loader's worker threads
+		void PreloadGLMesh(const std::vector<Property> &properties);
+		void PreloadGLSprite(const std::vector<Property> &properties);
+		void PreloadScreenQuad(const std::vector<Property> &properties);
+
+		static resource::ResourceCache<resource::ImageData> images; // decoded images, kept until ReleaseDecodedImages
+
 		unsigned int windowWidth; // Store the width of our window
 		unsigned int windowHeight; // Store the height of our window
 
@@ -174,6 +359,12 @@ namespace Sigma{
 		std::vector<IGLView*> views; // A stack of the view. A vector is used to support random access.
 
 		double deltaAccumulator; // milliseconds since last render
+
+		JobSystem* jobs; // may be nullptr
+		bool pipelined;
+		const FixedStepClock* clock; // may be nullptr
+		SnapshotPair<RenderSnapshot, RenderSnapshot::ModelKey> snapshots; // the published one is drawn, the other one is captured into
+		RenderQueue drawQueue; // the published draws, less the ones of components removed since
 		double framerate; // default is 60fps
 
 		// Utility quads for rendering
@@ -183,7 +374,19 @@ namespace Sigma{
 		// Render targets to draw to
 		std::vector<std::unique_ptr<RenderTarget>> renderTargets;
 
+		// The frame's uniform blocks, and where the draws' and lights' blocks are in it
+		UniformRing uniforms;
+		std::vector<RenderQueue::Run> batches; // the render queue's draws made as one instanced draw
+		std::vector<size_t> batchBlocks; // the ObjectData of each batch
+		std::vector<size_t> lightBlocks; // the point lights, then the spot lights
+		std::vector<ObjectBlock> instances; // a batch's model matrices, while packing them
+
 		std::vector<std::unique_ptr<IGLComponent>> screensSpaceComp; // A vector that holds only screen space components. These are rendered separately.
+
+		// Typed views of _Stores walked by the render passes
+		ComponentBucket<IGLComponent> glComponents; // lit and unlit, IsLightingEnabled() can change at any time
+		ComponentBucket<PointLight> pointLights;
+		ComponentBucket<SpotLight> spotLights;
 	}; // class OpenGLSystem
 } // namespace Sigma
 #endif // OPENGLSYSTEM_H
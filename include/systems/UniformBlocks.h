@@ -0,0 +1,124 @@
+#pragma once
+#ifndef UNIFORMBLOCKS_H
+#define UNIFORMBLOCKS_H
+
+#ifdef __APPLE__
+#include <OpenGL/gl3.h>
+#else
+#include "GL/glew.h"
+#endif
+#include <vector>
+#include "glm/glm.hpp"
+#include "Sigma.h"
+
+namespace Sigma {
+	/**
+	 * The uniform blocks shared by the shaders, and the binding points they are bound to.
+	 * Every program linked has the blocks it declares bound to their points, see
+	 * BindUniformBlocks. The structs follow the std140 layout of the blocks in shaders/, which
+	 * have to be kept in the same order.
+	 */
+	enum UniformBlockBinding {
+		FRAME_BLOCK = 0, // FrameData, once per frame
+		LIGHT_BLOCK = 1, // LightData, per light
+		OBJECT_BLOCK = 2 // ObjectData, per draw
+	};
+
+	// The length of ObjectData's array, so that the block fits the 16KB every implementation allows
+	const unsigned int MAX_INSTANCES = 256;
+
+	struct FrameBlock {
+		glm::mat4 view; // in_View
+		glm::mat4 projection; // in_Proj
+		glm::mat4 viewProjInverse;
+		glm::vec3 viewPosition; // viewPosW
+		float padding;
+	};
+
+	struct LightBlock {
+		glm::vec4 color; // lightColor
+		glm::vec3 position; // lightPosW
+		float radius; // lightRadius
+		glm::vec3 direction; // lightDirW
+		float cosInnerAngle; // lightCosInnerAngle
+		float cosOuterAngle; // lightCosOuterAngle
+		float padding[3];
+	};
+
+	// One instance's entry in ObjectData, which holds MAX_INSTANCES of them
+	struct ObjectBlock {
+		glm::mat4 model; // in_Models[gl_InstanceID]
+	};
+
+	/**
+	 * \brief Binds the uniform blocks a program declares to their binding points.
+	 *
+	 * \param[in] GLuint program The linked program.
+	 */
+	DLL_EXPORT void BindUniformBlocks(GLuint program);
+
+	/**
+	 * \brief A uniform buffer filled once per frame, with the frame's blocks one after another.
+	 *
+	 * The blocks are staged, each at an offset aligned as OpenGL requires for binding it, and
+	 * uploaded at once. The buffer has a segment for each of the last SEGMENTS frames, and
+	 * each frame writes the next one, so the frames the GPU may still be drawing keep their
+	 * data. The segments grow to fit the largest frame.
+	 */
+	class UniformRing {
+	public:
+		static const unsigned int SEGMENTS = 3;
+
+		DLL_EXPORT UniformRing();
+		DLL_EXPORT ~UniformRing();
+
+		/**
+		 * \brief Starts staging a frame, in the next segment.
+		 */
+		DLL_EXPORT void Begin();
+
+		/**
+		 * \brief Stages a block.
+		 *
+		 * \param[in] const T& block The block.
+		 * \return size_t Where the block is in the frame, for Bind.
+		 */
+		template <typename T>
+		size_t Append(const T& block) {
+			return Append(&block, sizeof(T));
+		}
+		DLL_EXPORT size_t Append(const void* data, size_t size);
+
+		/**
+		 * \brief Makes the frame at least size bytes long, for blocks bound with more than was staged.
+		 *
+		 * \param[in] size_t size The size of the frame.
+		 */
+		DLL_EXPORT void Pad(size_t size);
+
+		/**
+		 * \brief Uploads the blocks staged since Begin; they can be bound from then on.
+		 */
+		DLL_EXPORT void Upload();
+
+		/**
+		 * \brief Binds a block of this frame to a binding point.
+		 *
+		 * \param[in] UniformBlockBinding binding The binding point.
+		 * \param[in] size_t offset Where the block is in the frame, as returned by Append.
+		 * \param[in] size_t size The size of the block.
+		 */
+		DLL_EXPORT void Bind(UniformBlockBinding binding, size_t offset, size_t size);
+	private:
+		UniformRing(const UniformRing&);
+		UniformRing& operator=(const UniformRing&);
+
+		GLuint buffer;
+		size_t alignment; // of the blocks' offsets
+		size_t segmentSize;
+		unsigned int segment; // written this frame
+		std::vector<char> staging;
+	};
+}
+
+#endif // UNIFORMBLOCKS_H
@@ -13,6 +13,7 @@
 #include "cef_client.h"
 #include "cef_render_process_handler.h"
 #endif
+#include "SystemScheduler.h"
 #include "Sigma.h"
 
 class Property;
@@ -49,6 +50,11 @@ namespace Sigma {
 		 */
 		DLL_EXPORT bool Update(const double delta);
 
+		/**
+		 * \brief The data Update reads and writes, for the SystemScheduler.
+		 */
+		DLL_EXPORT static SystemAccess DataAccess();
+
 		std::map<std::string,FactoryFunction> getFactoryFunctions();
 
 		DLL_EXPORT IComponent* createWebGUIView(const id_t entityID, const std::vector<Property> &properties);
@@ -6,9 +6,18 @@ in  vec3 in_Position;
 //in  vec3 in_Color;
 //in  vec3 in_Normal;
 
-uniform  mat4 in_Model;
-uniform  mat4 in_View;
-uniform  mat4 in_Proj;
+// Set once per frame, see systems/UniformBlocks.h
+layout(std140) uniform FrameData {
+	mat4 in_View;
+	mat4 in_Proj;
+	mat4 viewProjInverse;
+	vec3 viewPosW;
+};
+
+// Set per draw, a model matrix for each instance drawn (MAX_INSTANCES in systems/UniformBlocks.h)
+layout(std140) uniform ObjectData {
+	mat4 in_Models[256];
+};
 
 out vec3 ex_NormalW;
 out vec3 ex_TangentW;
@@ -17,6 +26,8 @@ out vec3 ex_UVW;
  
 void main(void)
 {
+	mat4 in_Model = in_Models[gl_InstanceID];
+
 	vec3 transformedPos = normalize(in_Position);
 	gl_Position = in_Proj * (in_View * (in_Model * vec4(transformedPos,1)));
 	ex_NormalW = normalize((in_Model * vec4(transformedPos,0)).xyz);
@@ -2,9 +2,18 @@
  
 #version 140
 
-uniform  mat4 in_Model;
-uniform  mat4 in_View;
-uniform  mat4 in_Proj;
+// Set once per frame, see systems/UniformBlocks.h
+layout(std140) uniform FrameData {
+	mat4 in_View;
+	mat4 in_Proj;
+	mat4 viewProjInverse;
+	vec3 viewPosW;
+};
+
+// Set per draw, a model matrix for each instance drawn (MAX_INSTANCES in systems/UniformBlocks.h)
+layout(std140) uniform ObjectData {
+	mat4 in_Models[256];
+};
  
 in  vec3 in_Position;
 in  vec3 in_Color;
@@ -18,6 +27,8 @@ out vec3 ex_LightDir;
  
 void main(void)
 {
+	mat4 in_Model = in_Models[gl_InstanceID];
+
 	vec3 normalDirection = normalize(mat3(in_Model) * in_Normal);
 	ex_LightDir = normalize(vec3(-in_View[3].xyz * mat3(in_View) - (in_Model * vec4(in_Position, 1.0)).xyz ));
 	ex_Color = vec3(in_Color);
@@ -2,12 +2,19 @@
  
 #version 140
 
-uniform  mat4 in_Model;
-uniform  mat4 in_View;
-uniform  mat4 in_Proj;
+// Set once per frame, see systems/UniformBlocks.h
+layout(std140) uniform FrameData {
+	mat4 in_View;
+	mat4 in_Proj;
+	mat4 viewProjInverse;
+	vec3 viewPosW;
+};
+
+// Set per draw, a model matrix for each instance drawn (MAX_INSTANCES in systems/UniformBlocks.h)
+layout(std140) uniform ObjectData {
+	mat4 in_Models[256];
+};
 
-// Viewer position
-uniform vec3 viewPosW;
 uniform vec3 lightPositionW = vec3(0.0f, 1.5f, 0.0f);
  
 in  vec3 in_Position;
@@ -24,6 +31,8 @@ out vec3 ex_ViewDirW;
  
 void main(void)
 {
+	mat4 in_Model = in_Models[gl_InstanceID];
+
 	ex_Color = vec3(in_Color);
 	ex_Normal = (in_Model * vec4(in_Normal,0)).xyz;
 	ex_UV = in_UV;
@@ -2,11 +2,23 @@
 
 precision highp float; // needed only for version 1.30
 
-uniform vec3 viewPosW;
-uniform mat4 viewProjInverse;
-uniform vec3 lightPosW;
-uniform float lightRadius;
-uniform vec4 lightColor;
+// Set once per frame, see systems/UniformBlocks.h
+layout(std140) uniform FrameData {
+	mat4 in_View;
+	mat4 in_Proj;
+	mat4 viewProjInverse;
+	vec3 viewPosW;
+};
+
+// Set per light
+layout(std140) uniform LightData {
+	vec4 lightColor;
+	vec3 lightPosW;
+	float lightRadius;
+	vec3 lightDirW;
+	float lightCosInnerAngle;
+	float lightCosOuterAngle;
+};
 
 uniform sampler2D diffuseBuffer;
 uniform sampler2D normalBuffer;
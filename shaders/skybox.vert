@@ -6,15 +6,26 @@
 
 uniform vec3 gViewPositionW;
 
-uniform mat4 in_Model;
-uniform mat4 in_View;
-uniform mat4 in_Proj;
+// Set once per frame, see systems/UniformBlocks.h
+layout(std140) uniform FrameData {
+	mat4 in_View;
+	mat4 in_Proj;
+	mat4 viewProjInverse;
+	vec3 viewPosW;
+};
+
+// Set per draw, a model matrix for each instance drawn (MAX_INSTANCES in systems/UniformBlocks.h)
+layout(std140) uniform ObjectData {
+	mat4 in_Models[256];
+};
 
 in vec3 in_Position;
 
 out vec3 ex_UVW;
 
 void main(void) {
+	mat4 in_Model = in_Models[gl_InstanceID];
+
 	gl_Position = (in_Proj * (in_View * (in_Model * vec4(in_Position,1)))).xyww;
 	ex_UVW = in_Position;
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "ComponentPool.h"
+
+#include <new>
+#include <memory>
+#include <unordered_map>
+
+namespace Sigma {
+	namespace {
+		const size_t BLOCK_ALIGN = 16; // enough for any scalar or glm type
+		const size_t FIRST_SLAB_BLOCKS = 32;
+		const size_t MAX_SLAB_BLOCKS = 4096;
+	}
+
+	ComponentPool& ComponentPool::Get(ComponentID type, size_t size) {
+		static std::mutex registryLock;
+		// Deliberately leaked: components owned by static systems may be deleted after
+		// static destructors have run.
+		static std::unordered_map<uint64_t, ComponentPool*>& registry = *new std::unordered_map<uint64_t, ComponentPool*>();
+
+		uint64_t key = (static_cast<uint64_t>(type) << 32) | static_cast<uint32_t>(size);
+		std::lock_guard<std::mutex> guard(registryLock);
+		auto found = registry.find(key);
+		if (found != registry.end()) {
+			return *found->second;
+		}
+		ComponentPool* pool = new ComponentPool(size);
+		registry[key] = pool;
+		return *pool;
+	}
+
+	ComponentPool::ComponentPool(size_t size) : slabBlocks(FIRST_SLAB_BLOCKS), live(0), freeList(nullptr) {
+		if (size < sizeof(FreeBlock)) {
+			size = sizeof(FreeBlock);
+		}
+		this->blockSize = (size + BLOCK_ALIGN - 1) & ~(BLOCK_ALIGN - 1);
+	}
+
+	void* ComponentPool::Allocate() {
+		std::lock_guard<std::mutex> guard(this->lock);
+		if (!this->freeList) {
+			AddSlab();
+		}
+		FreeBlock* block = this->freeList;
+		this->freeList = block->next;
+		++this->live;
+		return block;
+	}
+
+	void ComponentPool::Free(void* block) {
+		if (!block) {
+			return;
+		}
+		std::lock_guard<std::mutex> guard(this->lock);
+		FreeBlock* freed = static_cast<FreeBlock*>(block);
+		freed->next = this->freeList;
+		this->freeList = freed;
+		if (--this->live == 0 && this->slabs.size() > 1) {
+			ReleaseSlabs();
+		}
+	}
+
+	void ComponentPool::AddSlab() {
+		// operator new returns memory aligned for any object, and blockSize keeps that alignment
+		char* slab = static_cast<char*>(::operator new(this->blockSize * this->slabBlocks));
+		this->slabs.push_back(slab);
+		ThreadSlab(slab, this->slabBlocks);
+
+		if (this->slabBlocks < MAX_SLAB_BLOCKS) {
+			this->slabBlocks *= 2;
+		}
+	}
+
+	void ComponentPool::ThreadSlab(char* slab, size_t blocks) {
+		// Thread the free list front to back so consecutive allocations are adjacent
+		for (size_t i = blocks; i > 0; --i) {
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * this->blockSize);
+			block->next = this->freeList;
+			this->freeList = block;
+		}
+	}
+
+	void ComponentPool::ReleaseSlabs() {
+		// Keep the first slab, so a component that is created and destroyed over and over
+		// doesn't allocate and free a slab each time
+		for (auto itr = this->slabs.begin() + 1; itr != this->slabs.end(); ++itr) {
+			::operator delete(*itr);
+		}
+		this->slabs.resize(1);
+		this->freeList = nullptr;
+		ThreadSlab(this->slabs[0], FIRST_SLAB_BLOCKS);
+		this->slabBlocks = FIRST_SLAB_BLOCKS * 2;
+	}
+}
@@ -0,0 +1,168 @@
+#include "EntityManager.h"
+#include "systems/FactorySystem.h"
+#include "Log.h"
+
+#include <deque>
+#include <algorithm>
+#include <limits>
+
+namespace Sigma {
+	namespace {
+		const EntityManager::ContextID FREE_SLOT = std::numeric_limits<EntityManager::ContextID>::max();
+
+		struct EntitySlot {
+			EntitySlot() : generation(0), context(FREE_SLOT), position(0) { }
+			id_t generation; // of the entity in the slot, or of the next one if it is free
+			EntityManager::ContextID context; // owning context, FREE_SLOT if no entity uses the slot
+			size_t position; // in the entity list of the context
+		};
+
+		struct EntityTable {
+			EntityTable() : current(0), contexts(1) { }
+			std::vector<EntitySlot> slots; // indexed by EntityIndex
+			std::deque<id_t> freeSlots; // deleted slots, oldest first so generations wrap late
+			EntityManager::ContextID current;
+			std::vector<std::vector<id_t>> contexts; // the entities of each context
+			std::vector<ISystemBase*> systems;
+		};
+
+		EntityTable& Table() {
+			static EntityTable table;
+			return table;
+		}
+
+		void Claim(EntityTable& table, id_t index, id_t generation) {
+			EntitySlot& slot = table.slots[index];
+			std::vector<id_t>& entities = table.contexts[table.current];
+			slot.generation = generation;
+			slot.context = table.current;
+			slot.position = entities.size();
+			entities.push_back(MakeEntityID(index, generation));
+		}
+	}
+
+	EntityManager::ContextID EntityManager::CreateContext() {
+		EntityTable& table = Table();
+		table.contexts.push_back(std::vector<id_t>());
+		return static_cast<ContextID>(table.contexts.size() - 1);
+	}
+
+	void EntityManager::UseContext(ContextID context) {
+		EntityTable& table = Table();
+		if (context >= table.contexts.size()) {
+			throw NoSuchContextException(context);
+		}
+		table.current = context;
+	}
+
+	EntityManager::ContextID EntityManager::CurrentContext() {
+		return Table().current;
+	}
+
+	id_t EntityManager::CreateEntity() {
+		EntityTable& table = Table();
+		// Slots in the free list may have been taken since by CreateEntity(id_t)
+		while (!table.freeSlots.empty()) {
+			id_t index = table.freeSlots.front();
+			table.freeSlots.pop_front();
+			if (table.slots[index].context == FREE_SLOT) {
+				Claim(table, index, table.slots[index].generation);
+				return MakeEntityID(index, table.slots[index].generation);
+			}
+		}
+		id_t index = static_cast<id_t>(table.slots.size());
+		if (index > ENTITY_INDEX_MASK) {
+			throw std::overflow_error("too many entities");
+		}
+		table.slots.push_back(EntitySlot());
+		Claim(table, index, 0);
+		return MakeEntityID(index, 0);
+	}
+
+	bool EntityManager::CreateEntity(id_t entityID) {
+		EntityTable& table = Table();
+		id_t index = EntityIndex(entityID);
+		id_t generation = EntityGeneration(entityID);
+		bool inTable = index < table.slots.size();
+		if (inTable && table.slots[index].context != FREE_SLOT) {
+			if (table.slots[index].generation == generation) {
+				return true;
+			}
+			LOG_WARN << "Entity " << entityID << " can't be created, its slot is used by entity "
+				<< MakeEntityID(index, table.slots[index].generation);
+			return false;
+		}
+		// Only the slot's next generation may be created, so deleted IDs stay deleted
+		id_t current = inTable ? table.slots[index].generation : 0;
+		if (generation != current) {
+			LOG_WARN << "Entity " << entityID << " can't be created, its slot is at generation " << current;
+			return false;
+		}
+		if (!inTable) {
+			// The slots skipped over are free
+			for (id_t skipped = static_cast<id_t>(table.slots.size()); skipped < index; ++skipped) {
+				table.freeSlots.push_back(skipped);
+			}
+			table.slots.resize(index + 1);
+		}
+		Claim(table, index, generation);
+		return false;
+	}
+
+	bool EntityManager::EntityExists(id_t entityID) {
+		EntityTable& table = Table();
+		id_t index = EntityIndex(entityID);
+		return index < table.slots.size()
+			&& table.slots[index].context == table.current
+			&& table.slots[index].generation == EntityGeneration(entityID);
+	}
+
+	bool EntityManager::DeleteEntity(id_t entityID) {
+		if (!EntityExists(entityID)) {
+			return false;
+		}
+		EntityTable& table = Table();
+		for (auto sitr = table.systems.begin(); sitr != table.systems.end(); ++sitr) {
+			(*sitr)->removeEntity(entityID);
+		}
+
+		// Swap the last entity of the context into the hole
+		id_t index = EntityIndex(entityID);
+		EntitySlot& slot = table.slots[index];
+		std::vector<id_t>& entities = table.contexts[slot.context];
+		if (slot.position != entities.size() - 1) {
+			entities[slot.position] = entities.back();
+			table.slots[EntityIndex(entities[slot.position])].position = slot.position;
+		}
+		entities.pop_back();
+
+		slot.context = FREE_SLOT;
+		slot.generation = (slot.generation + 1) & ENTITY_GENERATION_MASK;
+		table.freeSlots.push_back(index);
+		return true;
+	}
+
+	IComponent* EntityManager::AddComponent(id_t entityID, const std::string& type, const std::vector<Property>& properties) {
+		if (!EntityExists(entityID)) {
+			throw NoSuchEntityException(entityID);
+		}
+		return FactorySystem::getInstance().create(type, entityID, properties);
+	}
+
+	const std::vector<id_t>& EntityManager::Entities() {
+		EntityTable& table = Table();
+		return table.contexts[table.current];
+	}
+
+	void EntityManager::RegisterSystem(ISystemBase& system) {
+		EntityTable& table = Table();
+		if (std::find(table.systems.begin(), table.systems.end(), &system) == table.systems.end()) {
+			table.systems.push_back(&system);
+		}
+	}
+
+	void EntityManager::UnregisterSystem(ISystemBase& system) {
+		EntityTable& table = Table();
+		table.systems.erase(std::remove(table.systems.begin(), table.systems.end(), &system), table.systems.end());
+	}
+}
@@ -0,0 +1,138 @@
+#include "EventBus.h"
+
+namespace Sigma {
+	namespace {
+		std::atomic<unsigned int> nextSerial(1);
+
+		// The queue this thread last published to, and its bus
+		SIGMA_THREAD_LOCAL unsigned int cachedBus = 0;
+		SIGMA_THREAD_LOCAL void* cachedQueue = nullptr;
+	}
+
+	EventBus::EventBus() : serial(nextSerial++), queues(nullptr) { }
+
+	EventBus::ProducerQueue::ProducerQueue(std::thread::id owner) : owner(owner), head(&stub), tail(&stub), next(nullptr) {
+		for (unsigned int c = 0; c < SIZE_CLASSES; ++c) {
+			this->returned[c].store(nullptr, std::memory_order_relaxed);
+			this->spare[c] = nullptr;
+		}
+	}
+
+	EventBus::~EventBus() {
+		ProducerQueue* queue = this->queues.load(std::memory_order_acquire);
+		while (queue) {
+			Event* event = queue->head;
+			while (event) {
+				Event* next = event->next.load(std::memory_order_acquire);
+				if (event != &queue->stub) {
+					Free(queue, event);
+				}
+				event = next;
+			}
+			for (unsigned int c = 0; c < SIZE_CLASSES; ++c) {
+				FreeNode* nodes[2] = { queue->spare[c], queue->returned[c].load(std::memory_order_acquire) };
+				for (int list = 0; list < 2; ++list) {
+					while (nodes[list]) {
+						FreeNode* next = nodes[list]->next;
+						::operator delete(nodes[list]);
+						nodes[list] = next;
+					}
+				}
+			}
+			ProducerQueue* next = queue->next;
+			delete queue;
+			queue = next;
+		}
+	}
+
+	void* EventBus::Allocate(ProducerQueue* queue, size_t size, unsigned int sizeClass) {
+		if (sizeClass >= SIZE_CLASSES) {
+			return ::operator new(size);
+		}
+		if (!queue->spare[sizeClass]) {
+			// Take back every node Dispatch has freed since
+			queue->spare[sizeClass] = queue->returned[sizeClass].exchange(nullptr, std::memory_order_acquire);
+		}
+		FreeNode* node = queue->spare[sizeClass];
+		if (!node) {
+			return ::operator new(SMALLEST_NODE << sizeClass);
+		}
+		queue->spare[sizeClass] = node->next;
+		return node;
+	}
+
+	void EventBus::Free(ProducerQueue* queue, Event* event) {
+		const unsigned int sizeClass = event->sizeClass;
+		event->~Event();
+		if (sizeClass >= SIZE_CLASSES) {
+			::operator delete(event);
+			return;
+		}
+		// The owner only ever swaps the whole list out, so a node can't come back in between
+		FreeNode* node = reinterpret_cast<FreeNode*>(event);
+		FreeNode* first = queue->returned[sizeClass].load(std::memory_order_relaxed);
+		do {
+			node->next = first;
+		} while (!queue->returned[sizeClass].compare_exchange_weak(first, node, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	EventBus::ProducerQueue* EventBus::QueueOfThisThread() {
+		if (cachedBus == this->serial) {
+			return static_cast<ProducerQueue*>(cachedQueue);
+		}
+
+		const std::thread::id self = std::this_thread::get_id();
+		ProducerQueue* queue = this->queues.load(std::memory_order_acquire);
+		while (queue && queue->owner != self) {
+			queue = queue->next;
+		}
+		if (!queue) {
+			// First event from this thread. A thread reusing the ID of one that ended takes
+			// over its queue, which still has a single producer.
+			queue = new ProducerQueue(self);
+			ProducerQueue* first = this->queues.load(std::memory_order_relaxed);
+			do {
+				queue->next = first;
+			} while (!this->queues.compare_exchange_weak(first, queue, std::memory_order_release, std::memory_order_relaxed));
+		}
+		cachedBus = this->serial;
+		cachedQueue = queue;
+		return queue;
+	}
+
+	void EventBus::Push(ProducerQueue* queue, Event* event) {
+		Event* last = queue->tail.load(std::memory_order_relaxed);
+		last->next.store(event, std::memory_order_release);
+		queue->tail.store(event, std::memory_order_release);
+	}
+
+	void EventBus::AddHandler(EventID type, Handler handler) {
+		this->handlers[type].push_back(handler);
+	}
+
+	size_t EventBus::Dispatch() {
+		size_t handled = 0;
+		for (ProducerQueue* queue = this->queues.load(std::memory_order_acquire); queue; queue = queue->next) {
+			// Stop at the last event pushed so far, so handlers publishing more can't keep this going
+			Event* const last = queue->tail.load(std::memory_order_acquire);
+			while (queue->head != last) {
+				Event* previous = queue->head;
+				Event* event = previous->next.load(std::memory_order_acquire);
+				// The event becomes the list's head, freed once the next one is handled
+				queue->head = event;
+				if (previous != &queue->stub) {
+					Free(queue, previous);
+				}
+				auto typeitr = this->handlers.find(event->type);
+				if (typeitr != this->handlers.end()) {
+					const std::vector<Handler>& subscribed = typeitr->second;
+					for (auto hitr = subscribed.begin(); hitr != subscribed.end(); ++hitr) {
+						(*hitr)(event->Data());
+					}
+				}
+				++handled;
+			}
+		}
+		return handled;
+	}
+}
@@ -0,0 +1,35 @@
+#include "FixedStepClock.h"
+
+#include <cmath>
+
+namespace Sigma {
+	FixedStepClock::FixedStepClock(double rate, unsigned int maxSteps) : step(1.0 / 60.0), maxSteps(maxSteps),
+		accumulator(0.0), steps(0), totalSteps(0), dropped(0.0) {
+		SetRate(rate);
+	}
+
+	unsigned int FixedStepClock::Advance(double delta) {
+		if (delta > 0.0) {
+			this->accumulator += delta;
+		}
+		this->steps = static_cast<unsigned int>(std::floor(this->accumulator / this->step));
+		if (this->steps > this->maxSteps) {
+			// Keep the fraction of a step so Alpha stays smooth across the drop
+			double kept = std::fmod(this->accumulator, this->step);
+			this->dropped += this->accumulator - kept - this->maxSteps * this->step;
+			this->accumulator = kept;
+			this->steps = this->maxSteps;
+		}
+		else {
+			this->accumulator -= this->steps * this->step;
+		}
+		this->totalSteps += this->steps;
+		return this->steps;
+	}
+
+	void FixedStepClock::SetRate(double rate) {
+		if (rate > 0.0) {
+			this->step = 1.0 / rate;
+		}
+	}
+}
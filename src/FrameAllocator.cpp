@@ -0,0 +1,42 @@
+#include "FrameAllocator.h"
+
+#include <algorithm>
+#include <stdint.h>
+
+namespace Sigma {
+	FrameAllocator::FrameAllocator(size_t capacity) : blockSize(0), offset(0), capacity(0), used(0) {
+		AddBlock(std::max<size_t>(capacity, 1));
+	}
+
+	void* FrameAllocator::Allocate(size_t bytes, size_t alignment) {
+		uintptr_t base = reinterpret_cast<uintptr_t>(this->blocks.back().get());
+		size_t start = ((base + this->offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+		if (start + bytes > this->blockSize) {
+			// Leave the rest of this block unused; the next Reset merges the blocks
+			AddBlock(std::max(this->blockSize * 2, bytes + alignment));
+			base = reinterpret_cast<uintptr_t>(this->blocks.back().get());
+			start = ((base + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+		}
+		this->offset = start + bytes;
+		this->used += bytes;
+		return this->blocks.back().get() + start;
+	}
+
+	void FrameAllocator::Reset() {
+		if (this->blocks.size() > 1) {
+			size_t total = this->capacity;
+			this->blocks.clear();
+			this->capacity = 0;
+			AddBlock(total);
+		}
+		this->offset = 0;
+		this->used = 0;
+	}
+
+	void FrameAllocator::AddBlock(size_t bytes) {
+		this->blocks.push_back(std::unique_ptr<char[]>(new char[bytes]));
+		this->blockSize = bytes;
+		this->offset = 0;
+		this->capacity += bytes;
+	}
+}
@@ -0,0 +1,89 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace Sigma {
+	namespace {
+		const double MIN_SPIN = 0.0005; // seconds
+		const double VSYNC_MARGIN = 0.001; // seconds left for the buffer swap to wait out
+	}
+
+	FramePacer::FramePacer(double rate) : period(0.0), vsync(false), wait(nullptr), clockNow(nullptr), next(Clock::now()),
+		spin(0.002), statsStart(Clock::now()), idle(0.0), lastIdle(0.0) {
+		SetRate(rate);
+	}
+
+	void FramePacer::SetRate(double rate) {
+		this->period = std::chrono::duration<double>(rate > 0.0 ? 1.0 / rate : 0.0);
+		this->next = Now();
+	}
+
+	void FramePacer::SetClock(NowFunction now) {
+		this->clockNow = now;
+		this->next = Now();
+		ResetStats();
+	}
+
+	void FramePacer::Wait() {
+		const Clock::time_point start = Now();
+		if (this->period.count() <= 0.0) {
+			this->lastIdle = 0.0;
+			return;
+		}
+
+		Clock::time_point deadline = this->next;
+		if (this->vsync) {
+			deadline -= std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(VSYNC_MARGIN));
+		}
+
+		// Sleep until shortly before the deadline, learning how late sleeps wake up
+		Clock::time_point now = start;
+		while (true) {
+			double remaining = std::chrono::duration<double>(deadline - now).count();
+			if (remaining <= this->spin) {
+				break;
+			}
+			double requested = remaining - this->spin;
+			if (this->wait) {
+				this->wait(requested);
+			}
+			else {
+				std::this_thread::sleep_for(std::chrono::duration<double>(requested));
+			}
+			Clock::time_point woke = Now();
+			double overshoot = std::chrono::duration<double>(woke - now).count() - requested;
+			this->spin = std::max(MIN_SPIN, std::min(this->period.count() / 2, std::max(overshoot * 1.5, this->spin * 0.99)));
+			now = woke;
+		}
+		if (!this->vsync) {
+			while (now < deadline) {
+				std::this_thread::yield();
+				now = Now();
+			}
+		}
+
+		this->next += std::chrono::duration_cast<Clock::duration>(this->period);
+		if (this->next < now) {
+			// More than a frame behind, start the schedule over
+			this->next = now + std::chrono::duration_cast<Clock::duration>(this->period);
+		}
+		this->lastIdle = std::chrono::duration<double>(now - start).count();
+		this->idle += this->lastIdle;
+	}
+
+	double FramePacer::ElapsedTime() const {
+		return std::chrono::duration<double>(Now() - this->statsStart).count();
+	}
+
+	double FramePacer::IdleFraction() const {
+		double elapsed = ElapsedTime();
+		return elapsed > 0.0 ? std::min(1.0, this->idle / elapsed) : 0.0;
+	}
+
+	void FramePacer::ResetStats() {
+		this->statsStart = Now();
+		this->idle = 0.0;
+		this->lastIdle = 0.0;
+	}
+}
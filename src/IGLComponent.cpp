@@ -1,9 +1,22 @@
 #include "IGLComponent.h"
+#include "systems/GLState.h"
 
 namespace Sigma{
 	// static member initialization
 	IGLComponent::ShaderMap IGLComponent::loadedShaders;
 
+	void IGLComponent::DeleteBuffers() {
+		// Buffers that were never generated are 0, which glDeleteBuffers ignores
+		glDeleteBuffers(sizeof(this->buffers) / sizeof(this->buffers[0]), this->buffers);
+		memset(this->buffers, 0, sizeof(this->buffers));
+		if (this->vao != 0) {
+			glDeleteVertexArrays(1, &this->vao);
+			this->vao = 0;
+		}
+		// The names can be reused, so what was bound is no longer known
+		GLState::Get().Invalidate();
+	}
+
 	void IGLComponent::LoadShader(const std::string& filename) {
 		// look up shader that is already loaded
 		ShaderMap::iterator existingShader = IGLComponent::loadedShaders.find(filename.c_str());
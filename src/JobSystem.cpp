@@ -0,0 +1,289 @@
+#include "JobSystem.h"
+
+#include <deque>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+
+namespace Sigma {
+	struct JobSystem::Batch {
+		Batch(size_t count) : remaining(count) { }
+		std::atomic<size_t> remaining;
+		std::mutex errorMutex;
+		std::exception_ptr error; // the first exception thrown by a job
+	};
+
+	struct JobSystem::Task {
+		Task(Job job, Batch* batch) : job(job), batch(batch) { }
+		Job job;
+		Batch* batch; // nullptr for submitted jobs, which report to their own callback
+	};
+
+	struct JobSystem::WorkQueue {
+		std::mutex mutex;
+		std::deque<Task> tasks; // the owner works at the back, thieves steal from the front
+	};
+
+	namespace {
+		// The pool the calling thread works for and its queue in that pool
+		SIGMA_THREAD_LOCAL JobSystem* workerOf = nullptr;
+		SIGMA_THREAD_LOCAL size_t workerQueue = 0;
+	}
+
+	size_t TaskGraph::Add(std::function<void()> task) {
+		this->nodes.push_back(Node(task));
+		return this->nodes.size() - 1;
+	}
+
+	void TaskGraph::Precede(TaskID before, TaskID after) {
+		if (before >= this->nodes.size() || after >= this->nodes.size()) {
+			throw std::out_of_range("no such task");
+		}
+		this->nodes[before].successors.push_back(after);
+		++this->nodes[after].predecessors;
+	}
+
+	JobSystem::JobSystem(unsigned int workers) : queued(0), nextWorker(0), stop(false) {
+		if (workers == 0) {
+			unsigned int cores = std::thread::hardware_concurrency();
+			workers = cores > 1 ? cores - 1 : 1;
+		}
+		for (unsigned int q = 0; q <= workers; ++q) {
+			this->queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+			this->allocators.push_back(std::unique_ptr<FrameAllocator>(new FrameAllocator()));
+		}
+		for (unsigned int w = 0; w < workers; ++w) {
+			this->workers.push_back(std::thread(&JobSystem::WorkerLoop, this, w + 1));
+		}
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(this->sleepMutex);
+			this->stop = true;
+		}
+		this->wake.notify_all();
+		for (auto witr = this->workers.begin(); witr != this->workers.end(); ++witr) {
+			witr->join();
+		}
+	}
+
+	void JobSystem::WorkerLoop(size_t index) {
+		workerOf = this;
+		workerQueue = index;
+		while (true) {
+			if (TryRun(index)) {
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(this->sleepMutex);
+			this->wake.wait(lock, [this] () { return this->stop || this->queued > 0; });
+			if (this->stop && this->queued == 0) {
+				return;
+			}
+		}
+	}
+
+	size_t JobSystem::ThisQueue() const {
+		return (workerOf == this) ? workerQueue : 0;
+	}
+
+	void JobSystem::Push(size_t queue, Task task) {
+		{
+			std::lock_guard<std::mutex> lock(this->queues[queue]->mutex);
+			this->queues[queue]->tasks.push_back(std::move(task));
+		}
+		{
+			// Taking the lock orders the increment before a worker's check in WorkerLoop
+			std::lock_guard<std::mutex> lock(this->sleepMutex);
+			++this->queued;
+		}
+		this->wake.notify_one();
+	}
+
+	bool JobSystem::TryRun(size_t queue) {
+		Task task(nullptr, nullptr);
+		bool found = false;
+		{
+			// Newest job of our own queue first, it is most likely still in the cache
+			WorkQueue& own = *this->queues[queue];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.tasks.empty()) {
+				task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+				found = true;
+			}
+		}
+		for (size_t i = 1; !found && i < this->queues.size(); ++i) {
+			// Oldest job of another queue, usually the biggest chunk of work left there
+			WorkQueue& victim = *this->queues[(queue + i) % this->queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.tasks.empty() && (queue != 0 || victim.tasks.front().batch)) {
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				found = true;
+			}
+		}
+		if (!found) {
+			return false;
+		}
+		--this->queued;
+
+		if (!task.batch) {
+			task.job(); // handles its own exceptions, see Submit
+			return true;
+		}
+		try {
+			task.job();
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(task.batch->errorMutex);
+			if (!task.batch->error) {
+				task.batch->error = std::current_exception();
+			}
+		}
+		--task.batch->remaining;
+		return true;
+	}
+
+	void JobSystem::Wait(Batch& batch, size_t queue) {
+		while (batch.remaining > 0) {
+			if (!TryRun(queue)) {
+				// The last jobs are running on other threads
+				std::this_thread::yield();
+			}
+		}
+		if (batch.error) {
+			std::rethrow_exception(batch.error);
+		}
+	}
+
+	void JobSystem::Run(const std::vector<Job>& jobs) {
+		if (jobs.empty()) {
+			return;
+		}
+		size_t queue = ThisQueue();
+		Batch batch(jobs.size());
+		for (auto jitr = jobs.begin(); jitr != jobs.end(); ++jitr) {
+			Push(queue, Task(*jitr, &batch));
+		}
+		Wait(batch, queue);
+	}
+
+	void JobSystem::Run(const TaskGraph& graph) {
+		const size_t count = graph.nodes.size();
+		if (count == 0) {
+			return;
+		}
+
+		// Check for cycles first, a cycle would never finish
+		std::vector<unsigned int> predecessors(count);
+		std::vector<TaskGraph::TaskID> ready;
+		for (size_t i = 0; i < count; ++i) {
+			predecessors[i] = graph.nodes[i].predecessors;
+			if (predecessors[i] == 0) {
+				ready.push_back(i);
+			}
+		}
+		size_t reached = 0;
+		for (size_t r = 0; r < ready.size(); ++r, ++reached) {
+			const std::vector<TaskGraph::TaskID>& successors = graph.nodes[ready[r]].successors;
+			for (auto sitr = successors.begin(); sitr != successors.end(); ++sitr) {
+				if (--predecessors[*sitr] == 0) {
+					ready.push_back(*sitr);
+				}
+			}
+		}
+		if (reached != count) {
+			throw std::invalid_argument("task graph has a cycle");
+		}
+
+		std::unique_ptr<std::atomic<unsigned int>[]> waiting(new std::atomic<unsigned int>[count]);
+		for (size_t i = 0; i < count; ++i) {
+			waiting[i] = graph.nodes[i].predecessors;
+		}
+
+		Batch batch(count);
+		std::function<void(TaskGraph::TaskID)> schedule;
+		schedule = [&] (TaskGraph::TaskID id) {
+			Push(ThisQueue(), Task([&, id] () {
+				std::exception_ptr error;
+				try {
+					graph.nodes[id].task();
+				}
+				catch (...) {
+					error = std::current_exception();
+				}
+				// Successors are queued before this task counts as done, so the batch can't finish early
+				const std::vector<TaskGraph::TaskID>& successors = graph.nodes[id].successors;
+				for (auto sitr = successors.begin(); sitr != successors.end(); ++sitr) {
+					if (--waiting[*sitr] == 0) {
+						schedule(*sitr);
+					}
+				}
+				if (error) {
+					std::rethrow_exception(error);
+				}
+			}, &batch));
+		};
+		for (size_t i = 0; i < count; ++i) {
+			if (graph.nodes[i].predecessors == 0) {
+				schedule(i);
+			}
+		}
+		Wait(batch, ThisQueue());
+	}
+
+	void JobSystem::Submit(Job job, std::function<void(std::exception_ptr)> done) {
+		size_t queue = ThisQueue();
+		if (queue == 0) {
+			queue = 1 + (this->nextWorker++ % this->workers.size());
+		}
+		Push(queue, Task([job, done] () {
+			std::exception_ptr error;
+			try {
+				job();
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+			if (done) {
+				done(error);
+			}
+		}, nullptr));
+	}
+
+	void JobSystem::ParallelFor(size_t begin, size_t end, size_t grain, const RangeJob& job) {
+		if (end <= begin) {
+			return;
+		}
+		const size_t count = end - begin;
+		if (grain == 0) {
+			// A few chunks per thread, so threads that finish early can steal the rest
+			grain = std::max<size_t>(1, count / (4 * this->queues.size()));
+		}
+		const size_t chunks = (count + grain - 1) / grain;
+		if (chunks == 1) {
+			job(begin, end);
+			return;
+		}
+
+		size_t queue = ThisQueue();
+		Batch batch(chunks);
+		for (size_t c = 0; c < chunks; ++c) {
+			size_t first = begin + c * grain;
+			size_t last = std::min(end, first + grain);
+			Push(queue, Task([&job, first, last] () { job(first, last); }, &batch));
+		}
+		Wait(batch, queue);
+	}
+
+	FrameAllocator& JobSystem::GetFrameAllocator() {
+		return *this->allocators[ThisQueue()];
+	}
+
+	void JobSystem::NewFrame() {
+		for (auto aitr = this->allocators.begin(); aitr != this->allocators.end(); ++aitr) {
+			(*aitr)->Reset();
+		}
+	}
+}
@@ -0,0 +1,111 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Sigma {
+#ifdef _WIN32
+	MappedFile::MappedFile() : data(nullptr), size(0), open(false), file(INVALID_HANDLE_VALUE), mapping(nullptr) { }
+#else
+	MappedFile::MappedFile() : data(nullptr), size(0), open(false) { }
+#endif
+
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+#ifdef _WIN32
+	bool MappedFile::Open(const std::string& fname) {
+		Close();
+
+		this->file = CreateFileA(fname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (this->file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(this->file, &fileSize)) {
+			Close();
+			return false;
+		}
+		this->size = static_cast<size_t>(fileSize.QuadPart);
+		this->open = true;
+		if (this->size == 0) {
+			return true; // nothing to map
+		}
+
+		this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (this->mapping == nullptr) {
+			Close();
+			return false;
+		}
+		this->data = static_cast<const char*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+		if (this->data == nullptr) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (this->data != nullptr) {
+			UnmapViewOfFile(this->data);
+		}
+		if (this->mapping != nullptr) {
+			CloseHandle(this->mapping);
+		}
+		if (this->file != INVALID_HANDLE_VALUE) {
+			CloseHandle(this->file);
+		}
+		this->data = nullptr;
+		this->mapping = nullptr;
+		this->file = INVALID_HANDLE_VALUE;
+		this->size = 0;
+		this->open = false;
+	}
+#else
+	bool MappedFile::Open(const std::string& fname) {
+		Close();
+
+		int fd = ::open(fname.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat info;
+		if (fstat(fd, &info) != 0) {
+			::close(fd);
+			return false;
+		}
+		this->size = static_cast<size_t>(info.st_size);
+		if (this->size > 0) {
+			void* mapped = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped == MAP_FAILED) {
+				::close(fd);
+				this->size = 0;
+				return false;
+			}
+			madvise(mapped, this->size, MADV_SEQUENTIAL);
+			this->data = static_cast<const char*>(mapped);
+		}
+		::close(fd); // the mapping keeps the file alive
+		this->open = true;
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (this->data != nullptr) {
+			munmap(const_cast<char*>(this->data), this->size);
+		}
+		this->data = nullptr;
+		this->size = 0;
+		this->open = false;
+	}
+#endif
+}
@@ -1,6 +1,8 @@
 #include "OS.h"
 
 #include <iostream>
+#include <thread>
+#include <chrono>
 
 #ifdef __APPLE__
 // Needed so we can disable retina support for our window.
@@ -97,6 +99,19 @@ namespace Sigma {
 		glfwPollEvents();
 	}
 
+	void OS::WaitEvents(double timeout) {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 2)
+		glfwWaitEventsTimeout(timeout);
+#else
+		// No way to wake glfwWaitEvents after a timeout
+		std::this_thread::sleep_for(std::chrono::duration<double>(timeout));
+#endif
+	}
+
+	void OS::SetVSync(bool vsync) {
+		glfwSwapInterval(vsync ? 1 : 0);
+	}
+
 	int OS::GetWindowWidth() {
 		return this->width;
 	}
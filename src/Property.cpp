@@ -0,0 +1,18 @@
+#include "Property.h"
+
+#include <mutex>
+#include <unordered_map>
+
+unsigned int Property::InternName(const std::string& name) {
+	static std::mutex lock;
+	static std::unordered_map<std::string, unsigned int> names;
+
+	std::lock_guard<std::mutex> guard(lock);
+	auto found = names.find(name);
+	if (found != names.end()) {
+		return found->second;
+	}
+	unsigned int id = static_cast<unsigned int>(names.size());
+	names[name] = id;
+	return id;
+}
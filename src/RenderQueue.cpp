@@ -0,0 +1,53 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Sigma {
+	namespace {
+		uint64_t Field(uint64_t value, unsigned int bits) {
+			return value & ((uint64_t(1) << bits) - 1);
+		}
+
+		// The bits of a non-negative float grow with its value; the top ones keep the order coarsely
+		uint64_t DepthBits(float depth) {
+			if (!(depth > 0.0f)) {
+				return 0; // behind the camera, or NaN
+			}
+			uint32_t bits;
+			std::memcpy(&bits, &depth, sizeof(bits));
+			return bits >> (32 - RenderQueue::DEPTH_BITS);
+		}
+	}
+
+	uint64_t RenderQueue::MakeKey(unsigned int pass, uint32_t shader, uint32_t material, uint32_t vao, float depth) {
+		return (Field(pass, PASS_BITS) << (SHADER_BITS + MATERIAL_BITS + VAO_BITS + DEPTH_BITS))
+			| (Field(shader, SHADER_BITS) << (MATERIAL_BITS + VAO_BITS + DEPTH_BITS))
+			| (Field(material, MATERIAL_BITS) << (VAO_BITS + DEPTH_BITS))
+			| (Field(vao, VAO_BITS) << DEPTH_BITS)
+			| DepthBits(depth);
+	}
+
+	void RenderQueue::Sort() {
+		std::sort(this->items.begin(), this->items.end(), [] (const Item& a, const Item& b) {
+			return a.key < b.key || (a.key == b.key && a.index < b.index);
+		});
+	}
+
+	void RenderQueue::Remove(uint32_t index) {
+		auto last = std::remove_if(this->items.begin(), this->items.end(), [index] (const Item& item) { return item.index == index; });
+		this->items.erase(last, this->items.end());
+		for (auto itr = this->items.begin(); itr != this->items.end(); ++itr) {
+			if (itr->index > index) {
+				--itr->index;
+			}
+		}
+	}
+
+	std::pair<size_t, size_t> RenderQueue::PassRange(unsigned int pass) const {
+		auto byPass = [] (const Item& item, unsigned int pass) { return Pass(item.key) < pass; };
+		auto begin = std::lower_bound(this->items.begin(), this->items.end(), pass, byPass);
+		auto end = std::lower_bound(begin, this->items.end(), pass + 1, byPass);
+		return std::make_pair(static_cast<size_t>(begin - this->items.begin()), static_cast<size_t>(end - this->items.begin()));
+	}
+}
@@ -0,0 +1,112 @@
+#include "SCBWriter.h"
+#include "SCBFormat.h"
+#include "IComponent.h"
+#include <fstream>
+
+namespace Sigma {
+	namespace parser {
+		SCBWriter::SCBWriter() : entityCount(0) { }
+
+		uint32_t SCBWriter::Intern(const std::string& s) {
+			auto found = this->stringIndex.find(s);
+			if (found != this->stringIndex.end()) {
+				return found->second;
+			}
+			uint32_t index = static_cast<uint32_t>(this->strings.size());
+			this->strings.push_back(s);
+			this->stringIndex[s] = index;
+			return index;
+		}
+
+		void SCBWriter::Add(const Entity& e) {
+			scb::AppendVarint(this->records, scb::ZigZag(e.id));
+			scb::AppendVarint(this->records, Intern(e.name));
+			scb::AppendVarint(this->records, static_cast<uint32_t>(e.components.size()));
+
+			// The properties are encoded apart, as their count is only known once the storable ones are
+			std::vector<char> properties;
+			for (auto citr = e.components.begin(); citr != e.components.end(); ++citr) {
+				scb::AppendVarint(this->records, Intern(citr->type));
+				scb::AppendU32(this->records, ComponentTypeHash(citr->type.c_str()));
+
+				properties.clear();
+				uint32_t count = 0;
+				for (auto pitr = citr->properties.begin(); pitr != citr->properties.end(); ++pitr) {
+					switch (pitr->GetType()) {
+					case Property::FLOAT:
+						scb::AppendVarint(properties, Intern(pitr->GetName()));
+						properties.push_back(scb::KIND_FLOAT);
+						scb::AppendU32(properties, scb::FloatBits(pitr->Get<float>()));
+						break;
+					case Property::INT:
+						scb::AppendVarint(properties, Intern(pitr->GetName()));
+						properties.push_back(scb::KIND_INT);
+						scb::AppendVarint(properties, scb::ZigZag(pitr->Get<int>()));
+						break;
+					case Property::BOOL:
+						scb::AppendVarint(properties, Intern(pitr->GetName()));
+						properties.push_back(pitr->Get<bool>() ? scb::KIND_TRUE : scb::KIND_FALSE);
+						break;
+					case Property::STRING:
+						scb::AppendVarint(properties, Intern(pitr->GetName()));
+						properties.push_back(scb::KIND_STRING);
+						scb::AppendVarint(properties, Intern(pitr->Get<std::string>()));
+						break;
+					default:
+						LOG_WARN << "Cannot store property " << pitr->GetName() << " of " << citr->type << " in a scene file, skipping it.";
+						continue;
+					}
+					++count;
+				}
+				scb::AppendVarint(this->records, count);
+				this->records.insert(this->records.end(), properties.begin(), properties.end());
+			}
+			++this->entityCount;
+		}
+
+		bool SCBWriter::Write(const std::string& fname) const {
+			std::ofstream out(fname, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!out) {
+				LOG_ERROR << "Cannot open scb file " << fname;
+				return false;
+			}
+
+			std::vector<char> stringData;
+			for (auto sitr = this->strings.begin(); sitr != this->strings.end(); ++sitr) {
+				scb::AppendVarint(stringData, static_cast<uint32_t>(sitr->size()));
+				stringData.insert(stringData.end(), sitr->begin(), sitr->end());
+			}
+
+			uint32_t stringsOffset = scb::HEADER_SIZE;
+			uint32_t entitiesOffset = stringsOffset + static_cast<uint32_t>(stringData.size());
+			uint32_t fileSize = entitiesOffset + static_cast<uint32_t>(this->records.size());
+
+			char header[scb::HEADER_SIZE];
+			memcpy(header, scb::MAGIC, 4);
+			scb::WriteU32(header + 4, scb::VERSION);
+			scb::WriteU32(header + 8, this->entityCount);
+			scb::WriteU32(header + 12, static_cast<uint32_t>(this->strings.size()));
+			scb::WriteU32(header + 16, stringsOffset);
+			scb::WriteU32(header + 20, entitiesOffset);
+			scb::WriteU32(header + 24, fileSize);
+
+			out.write(header, scb::HEADER_SIZE);
+			if (!stringData.empty()) {
+				out.write(&stringData[0], stringData.size());
+			}
+			if (!this->records.empty()) {
+				out.write(&this->records[0], this->records.size());
+			}
+			return static_cast<bool>(out);
+		}
+
+		bool SCBWriter::Compile(const std::string& in, const std::string& out) {
+			SCParser parser;
+			SCBWriter writer;
+			if (!parser.Parse(in, [&writer] (Entity& e) { writer.Add(e); })) {
+				return false;
+			}
+			return writer.Write(out);
+		}
+	}
+}
@@ -1,116 +1,495 @@
 #include "SCParser.h"
 #include "Property.h"
-#include "strutils.h"
-#include <fstream>
-#include <iostream>
-#include <sstream>
-#include <locale.h>
+#include "MappedFile.h"
+#include "SCBFormat.h"
+#include "IComponent.h"
+#include <cstring>
+#include <cmath>
+#include <unordered_map>
 
 #include "Sigma.h"
 
 namespace Sigma {
 	namespace parser {
-	/**
-	 * Change locals to "C" for numbers inside the code block were is created as uses RAII
-	 */
-	struct SetLocals {
-		SetLocals() {
-			setlocale(LC_NUMERIC, "C"); // We must parse numbers in a consistent way
+	namespace {
+		/**
+		 * A range of characters inside the mapped file. Nothing is copied until a value is stored.
+		 */
+		struct StringRef {
+			StringRef() : begin(nullptr), end(nullptr) { }
+			StringRef(const char* begin, const char* end) : begin(begin), end(end) { }
+			size_t size() const { return this->end - this->begin; }
+			bool empty() const { return this->begin == this->end; }
+			const char* begin;
+			const char* end;
+		};
+
+		/**
+		 * Interns each distinct property name of a text scene once per parse, keyed by its
+		 * characters in the mapped file, so a property line neither allocates nor locks.
+		 */
+		class NameCache {
+		public:
+			const Property::Name& Get(StringRef name) {
+				auto found = this->names.find(name);
+				if (found != this->names.end()) {
+					return found->second;
+				}
+				return this->names.insert(std::make_pair(name, Property::Name(std::string(name.begin, name.end)))).first->second;
+			}
+		private:
+			struct Hash {
+				size_t operator()(const StringRef& s) const {
+					uint32_t hash = 2166136261u; // FNV-1a, as ComponentTypeHash
+					for (const char* c = s.begin; c < s.end; ++c) {
+						hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+					}
+					return hash;
+				}
+			};
+			struct Equal {
+				bool operator()(const StringRef& a, const StringRef& b) const {
+					return a.size() == b.size() && memcmp(a.begin, b.begin, a.size()) == 0;
+				}
+			};
+			std::unordered_map<StringRef, Property::Name, Hash, Equal> names;
+		};
+
+		bool IsSpace(char c) {
+			return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
 		}
 
-		~SetLocals() {
-			setlocale(LC_ALL, ""); // Restores system local
+		StringRef RTrim(StringRef s) {
+			while (!s.empty() && IsSpace(s.end[-1])) {
+				--s.end;
+			}
+			return s;
 		}
-	};
 
-		bool SCParser::Parse(const std::string& fname) {
-			this->fname = fname;
-			std::ifstream in(this->fname, std::ios::in);
+		// Cuts a C style comment that begins with the last '//' of the line
+		StringRef RComment(StringRef s) {
+			for (const char* c = s.end - 1; c > s.begin; --c) {
+				if (c[0] == '/' && c[-1] == '/') {
+					s.end = c - 1;
+					break;
+				}
+			}
+			return s;
+		}
 
-			// Some type of error opening the file
-			if (!in) {
-				LOG_ERROR << "Cannot open sc file " << fname;
-				return false;
+		/**
+		 * Parses a leading integer like atoi: skips whitespace, then an optional sign and
+		 * digits; parsing stops at the first other character. Yields 0 if there are no digits.
+		 */
+		int ParseInt(StringRef s) {
+			const char* c = s.begin;
+			while (c < s.end && IsSpace(*c)) {
+				++c;
+			}
+			bool negative = false;
+			if (c < s.end && (*c == '-' || *c == '+')) {
+				negative = (*c == '-');
+				++c;
+			}
+			long long value = 0;
+			for (; c < s.end && *c >= '0' && *c <= '9'; ++c) {
+				value = value * 10 + (*c - '0');
+			}
+			return static_cast<int>(negative ? -value : value);
+		}
+
+		/**
+		 * Parses a leading decimal number like atof, independent of the locale: optional sign,
+		 * digits with an optional '.', and an optional exponent. Yields 0 if there are no digits.
+		 */
+		float ParseFloat(StringRef s) {
+			// Powers of ten that are exact as doubles
+			static const double pow10[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+			};
+
+			const char* c = s.begin;
+			while (c < s.end && IsSpace(*c)) {
+				++c;
+			}
+			bool negative = false;
+			if (c < s.end && (*c == '-' || *c == '+')) {
+				negative = (*c == '-');
+				++c;
+			}
+
+			unsigned long long mantissa = 0;
+			int digits = 0; // significant digits kept in mantissa
+			int exponent = 0;
+			for (; c < s.end && *c >= '0' && *c <= '9'; ++c) {
+				if (digits < 19) {
+					mantissa = mantissa * 10 + (*c - '0');
+					if (mantissa != 0) {
+						++digits;
+					}
+				}
+				else {
+					++exponent; // too many digits to keep, only their magnitude matters
+				}
+			}
+			if (c < s.end && *c == '.') {
+				for (++c; c < s.end && *c >= '0' && *c <= '9'; ++c) {
+					if (digits < 19) {
+						mantissa = mantissa * 10 + (*c - '0');
+						if (mantissa != 0) {
+							++digits;
+						}
+						--exponent;
+					}
+				}
+			}
+			if (c < s.end && (*c == 'e' || *c == 'E')) {
+				const char* e = c + 1;
+				bool negativeExponent = false;
+				if (e < s.end && (*e == '-' || *e == '+')) {
+					negativeExponent = (*e == '-');
+					++e;
+				}
+				if (e < s.end && *e >= '0' && *e <= '9') {
+					int value = 0;
+					for (; e < s.end && *e >= '0' && *e <= '9'; ++e) {
+						if (value < 10000) {
+							value = value * 10 + (*e - '0');
+						}
+					}
+					exponent += negativeExponent ? -value : value;
+				}
 			}
 
-			auto locals = SetLocals();
+			double value = static_cast<double>(mantissa);
+			if (exponent < 0) {
+				value = (exponent >= -22) ? value / pow10[-exponent] : value * std::pow(10.0, exponent);
+			}
+			else if (exponent > 0) {
+				value = (exponent <= 22) ? value * pow10[exponent] : value * std::pow(10.0, exponent);
+			}
+			return static_cast<float>(negative ? -value : value);
+		}
+
+		// bools are read as numbers, as reading them with a stream did: anything but a
+		// non-zero number, "true" included, is false
+		bool ParseBool(StringRef s) {
+			return ParseInt(s) != 0;
+		}
 
-			std::string line;
-			Sigma::parser::Entity* currentEntity = nullptr;
+		/**
+		 * Builds the entity handed to the callback, reusing it, its component slots and their
+		 * property vectors from one entity to the next.
+		 */
+		class EntityBuilder {
+		public:
+			EntityBuilder(const SCParser::EntityCallback& onEntity) : onEntity(onEntity), haveEntity(false) { }
 
-			while (getline(in, line)) {
+			void Begin(const char* name, size_t length, int id) {
+				Finish();
+				this->haveEntity = true;
+				this->entity.name.assign(name, length);
+				this->entity.id = id;
+			}
+
+			bool HasEntity() const { return this->haveEntity; }
+			Entity& Current() { return this->entity; }
+
+			Component* AddComponent(const char* type, size_t length) {
+				Component* component = AddComponent(type, length, 0);
+				component->typeID = ComponentTypeHash(component->type.c_str());
+				return component;
+			}
+
+			// Adds a component whose type ID is already known
+			Component* AddComponent(const char* type, size_t length, ComponentID typeID) {
+				if (!this->spare.empty()) {
+					this->entity.components.push_back(std::move(this->spare.back()));
+					this->spare.pop_back();
+				}
+				else {
+					this->entity.components.push_back(Component());
+				}
+				Component* component = &this->entity.components.back();
+				component->type.assign(type, length);
+				component->typeID = typeID;
+				return component;
+			}
+
+			// Hands the current entity, if any, to the callback
+			void Finish() {
+				if (!this->haveEntity) {
+					return;
+				}
+				this->onEntity(this->entity);
+				for (auto citr = this->entity.components.begin(); citr != this->entity.components.end(); ++citr) {
+					citr->properties.clear();
+					this->spare.push_back(std::move(*citr));
+				}
+				this->entity.components.clear();
+				this->haveEntity = false;
+			}
+		private:
+			const SCParser::EntityCallback& onEntity;
+			Entity entity;
+			std::vector<Component> spare; // component slots of previous entities
+			bool haveEntity;
+		};
+
+		bool ParseText(const char* data, size_t size, const std::string& fname, EntityBuilder& builder) {
+			// The component whose property lines are being read, if any
+			Component* component = nullptr;
+			Component orphan; // a component that precedes any entity, parsed and dropped
+			NameCache names;
+			const Property::Name idName("id");
+
+			const char* cursor = data;
+			const char* end = data + size;
+			while (cursor < end) {
+				const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+				if (lineEnd == nullptr) {
+					lineEnd = end;
+				}
 				// strip line's whitespace
-				line = rtrim(line);
+				StringRef line = RTrim(StringRef(cursor, lineEnd));
+				cursor = lineEnd + 1;
+
+				if (component != nullptr) {
+					if (!line.empty() && line.begin[0] == '>') { // property line
+						const char* equals = static_cast<const char*>(memchr(line.begin, '=', line.size()));
+						if (equals == nullptr || equals + 1 >= line.end) {
+							LOG_WARN << "Malformed property line in " << fname << ": " << std::string(line.begin, line.end);
+							continue;
+						}
+						const Property::Name& propName = names.Get(StringRef(line.begin + 1, equals));
+						StringRef propValue(equals + 1, line.end - 1);
+						char propType = line.end[-1];
+
+						if (propType == 'f') { // float
+							component->properties.push_back(Property(propName, ParseFloat(propValue)));
+						}
+						else if (propType == 's') { // string
+							component->properties.push_back(Property(propName, propValue.begin, propValue.size()));
+						}
+						else if (propType == 'i') { // int
+							component->properties.push_back(Property(propName, ParseInt(propValue)));
+						}
+						else if (propType == 'b') { // bool
+							component->properties.push_back(Property(propName, ParseBool(propValue)));
+						}
+						continue;
+					}
+					else if (!line.empty() && line.begin[0] == '#') { // id
+						component->properties.push_back(Property(idName, ParseInt(StringRef(line.begin + 1, line.end))));
+						continue;
+					}
+					// Any other line ends the component and is handled below
+					if (component == &orphan) {
+						LOG_DEBUG << "Attempted to add component to undefined entity.";
+					}
+					component = nullptr;
+				}
+
 				// Strip C style comments
-				line = rcomment(line);
-
-				char key[1];
-				key[0] = line.substr(0,1)[0];
-				if (key[0] == '@') { // name
-					if (currentEntity != nullptr) {
-						this->entities.push_back(*currentEntity); // Copy
-						delete currentEntity; // delete the heap original
+				line = RTrim(RComment(line));
+				if (line.empty()) {
+					continue;
+				}
+
+				char key = line.begin[0];
+				if (key == '@') { // name
+					builder.Begin(line.begin + 1, line.size() - 1, 0);
+				}
+				else if (key == '#') { // id
+					if (builder.HasEntity()) {
+						builder.Current().id = ParseInt(StringRef(line.begin + 1, line.end));
 					}
-					currentEntity = new Sigma::parser::Entity();
-					currentEntity->name = line.substr(1);
-				}
-				else if (key[0] == '#') { // id
-					currentEntity->id = atoi(line.substr(1).c_str());
-				}
-				else if (key[0] == '&') { // component type
-					Sigma::parser::Component c;
-					c.type = line.substr(1);
-					while (getline(in, line)) {
-						// strip line's whitespace
-						line = rtrim(line);
-						if (line.substr(0,1) == ">") { // property line
-							std::string propName = line.substr(1, line.find("=") - 1);
-							std::string propValue = line.substr(line.find("=") + 1);
-							std::string propType = propValue.substr(propValue.size() - 1);
-							propValue = propValue.substr(0, propValue.size() - 1);
-
-							if (propType == "f") { // float
-								Property p(propName, static_cast<float>(atof(propValue.c_str())));
-								c.properties.push_back(p);
-							}
-							else if (propType == "s") { // string
-								Property p(propName, propValue);
-								c.properties.push_back(p);
-							}
-							else if (propType == "i") { // int
-								Property p(propName, atoi(propValue.c_str()));
-								c.properties.push_back(p);
+				}
+				else if (key == '&') { // component type
+					if (builder.HasEntity()) {
+						component = builder.AddComponent(line.begin + 1, line.size() - 1);
+					}
+					else {
+						orphan.properties.clear();
+						component = &orphan;
+					}
+				}
+			}
+			if (component == &orphan) {
+				LOG_DEBUG << "Attempted to add component to undefined entity.";
+			}
+			builder.Finish();
+			return true;
+		}
+
+		/**
+		 * Reads a compiled scene (see SCBFormat.h). Every offset, index and count is checked
+		 * against the file size, so a truncated or corrupt file fails instead of reading out of bounds.
+		 *
+		 * Each string of the file is located once, and each property name interned once, so
+		 * reading a property is a table lookup plus storing its value.
+		 */
+		bool ParseBinary(const char* data, size_t size, const std::string& fname, EntityBuilder& builder) {
+			if (size < scb::HEADER_SIZE || scb::ReadU32(data + 4) != scb::VERSION) {
+				LOG_ERROR << "Unsupported scb file " << fname;
+				return false;
+			}
+			uint32_t entityCount = scb::ReadU32(data + 8);
+			uint32_t stringCount = scb::ReadU32(data + 12);
+			uint32_t stringsOffset = scb::ReadU32(data + 16);
+			uint32_t entitiesOffset = scb::ReadU32(data + 20);
+			// Every string takes at least a byte, so a corrupt count can't make us allocate much
+			if (scb::ReadU32(data + 24) != size || stringsOffset > entitiesOffset || entitiesOffset > size ||
+					stringCount > entitiesOffset - stringsOffset) {
+				LOG_ERROR << "Corrupt scb file " << fname;
+				return false;
+			}
+
+			std::vector<StringRef> strings(stringCount);
+			const char* cursor = data + stringsOffset;
+			const char* end = data + entitiesOffset;
+			uint32_t length;
+			for (uint32_t i = 0; i < stringCount; ++i) {
+				if (!scb::ReadVarint(cursor, end, length) || length > static_cast<uint32_t>(end - cursor)) {
+					LOG_ERROR << "Corrupt scb file " << fname;
+					return false;
+				}
+				strings[i] = StringRef(cursor, cursor + length);
+				cursor += length;
+			}
+
+			// The interned property names, by string index; NO_NAME until a property uses the string
+			const uint32_t NO_NAME = 0xFFFFFFFF;
+			std::vector<Property::Name> names;
+			std::vector<uint32_t> nameOf(stringCount, NO_NAME);
+
+			bool valid = true;
+			cursor = data + entitiesOffset;
+			end = data + size;
+			// Reads a varint, flagging the file invalid if it runs past the end
+			auto read = [&] () -> uint32_t {
+				uint32_t value = 0;
+				if (valid && !scb::ReadVarint(cursor, end, value)) {
+					valid = false;
+				}
+				return value;
+			};
+			// Reads a string index, flagging the file invalid if it is out of range
+			auto readString = [&] () -> StringRef {
+				uint32_t index = read();
+				if (index >= stringCount) {
+					valid = false;
+					return StringRef();
+				}
+				return strings[index];
+			};
+
+			for (uint32_t e = 0; e < entityCount && valid; ++e) {
+				int id = scb::UnZigZag(read());
+				StringRef name = readString();
+				uint32_t componentCount = read();
+				if (!valid) {
+					break;
+				}
+				builder.Begin(name.begin, name.size(), id);
+
+				for (uint32_t c = 0; c < componentCount && valid; ++c) {
+					StringRef type = readString();
+					if (!valid || end - cursor < 4) {
+						valid = false;
+						break;
+					}
+					ComponentID typeID = scb::ReadU32(cursor);
+					cursor += 4;
+					uint32_t propertyCount = read();
+					// Each property takes at least two bytes
+					if (!valid || propertyCount > static_cast<uint32_t>(end - cursor) / 2) {
+						valid = false;
+						break;
+					}
+					Component* component = builder.AddComponent(type.begin, type.size(), typeID);
+					component->properties.reserve(propertyCount);
+
+					for (uint32_t p = 0; p < propertyCount && valid; ++p) {
+						uint32_t index = read();
+						if (!valid || index >= stringCount || cursor == end) {
+							valid = false;
+							break;
+						}
+						if (nameOf[index] == NO_NAME) {
+							nameOf[index] = static_cast<uint32_t>(names.size());
+							names.push_back(Property::Name(std::string(strings[index].begin, strings[index].end)));
+						}
+						const Property::Name& propName = names[nameOf[index]];
+
+						switch (static_cast<unsigned char>(*cursor++)) {
+						case scb::KIND_FLOAT:
+							if (end - cursor < 4) {
+								valid = false;
+								break;
 							}
-							else if (propType == "b") {
-								// bool can be represented in many ways.
-								// Let us rely on the implementation of the std lib to match the value against the representations it knows.
-								bool b;
-								std::stringstream ss(propValue);
-								ss >> b;
-								Property p(propName, b);
-								c.properties.push_back(p);
+							component->properties.push_back(Property(propName, scb::BitsFloat(scb::ReadU32(cursor))));
+							cursor += 4;
+							break;
+						case scb::KIND_INT: {
+							int value = scb::UnZigZag(read());
+							component->properties.push_back(Property(propName, value));
+							break;
+						}
+						case scb::KIND_FALSE:
+							component->properties.push_back(Property(propName, false));
+							break;
+						case scb::KIND_TRUE:
+							component->properties.push_back(Property(propName, true));
+							break;
+						case scb::KIND_STRING: {
+							StringRef value = readString();
+							if (valid) {
+								component->properties.push_back(Property(propName, value.begin, value.size()));
 							}
-						} else if (line.substr(0,1) == "#") { // id
-							Property p("id", atoi(line.substr(1).c_str()));
-							c.properties.push_back(p);
-						} else {
 							break;
 						}
-					}
-					if(currentEntity != nullptr) {
-						currentEntity->components.push_back(c);
-					}
-					else {
-						LOG_DEBUG << "Attempted to add component to undefined entity.";
+						default:
+							valid = false;
+							break;
+						}
 					}
 				}
+				if (valid) {
+					builder.Finish();
+				}
+			}
+
+			if (!valid) {
+				LOG_ERROR << "Corrupt scb file " << fname;
+				return false;
+			}
+			return true;
+		}
+	}
+
+		bool SCParser::Parse(const std::string& fname, const EntityCallback& onEntity) {
+			this->fname = fname;
+			MappedFile file;
+
+			// Some type of error opening the file
+			if (!file.Open(this->fname)) {
+				LOG_ERROR << "Cannot open sc file " << fname;
+				return false;
 			}
-			if (currentEntity != nullptr) {
-				this->entities.push_back(*currentEntity); // copy
-				delete currentEntity; // delete the heap original
+
+			EntityBuilder builder(onEntity);
+			if (file.Size() >= sizeof(scb::MAGIC) && memcmp(file.Data(), scb::MAGIC, sizeof(scb::MAGIC)) == 0) {
+				return ParseBinary(file.Data(), file.Size(), fname, builder);
 			}
+			return ParseText(file.Data(), file.Size(), fname, builder); // Successfully parsed a file. It might have been empty though.
+		}
 
-			return true; // Successfully parsed a file. It might have been empty though.
+		bool SCParser::Parse(const std::string& fname) {
+			return Parse(fname, [this] (Sigma::parser::Entity& e) {
+				this->entities.push_back(std::move(e));
+			});
 		}
 
 		unsigned int SCParser::EntityCount() {
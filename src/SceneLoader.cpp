@@ -0,0 +1,97 @@
+#include "SceneLoader.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace Sigma {
+	SceneLoader::SceneLoader(FactorySystem& factory, unsigned int workers) : factory(factory), workers(workers) {
+		if (this->workers == 0) {
+			unsigned int cores = std::thread::hardware_concurrency();
+			this->workers = cores > 1 ? cores - 1 : 1;
+		}
+	}
+
+	bool SceneLoader::Load(const std::string& fname, const CreateCallback& create, const ProgressCallback& onProgress) {
+		// The whole scene is parsed first, so the workers can run ahead of creation
+		std::vector<parser::Entity> entities;
+		parser::SCParser parser;
+		if (!parser.Parse(fname, [&entities] (parser::Entity& e) { entities.push_back(std::move(e)); })) {
+			return false;
+		}
+
+		// Every component in scene order, as (entity, component) indices
+		std::vector<std::pair<size_t, size_t>> components;
+		for (size_t e = 0; e < entities.size(); ++e) {
+			for (size_t c = 0; c < entities[e].components.size(); ++c) {
+				components.push_back(std::make_pair(e, c));
+			}
+		}
+		const size_t total = components.size();
+
+		std::mutex mutex;
+		std::condition_variable preloaded;
+		std::vector<bool> ready(total, false); // guarded by mutex
+		std::atomic<size_t> next(0);
+
+		auto work = [&] () {
+			for (size_t i = next++; i < total; i = next++) {
+				const parser::Component& component = entities[components[i].first].components[components[i].second];
+				try {
+					this->factory.preload(component.typeID, component.properties);
+				}
+				catch (const std::exception& e) {
+					// The factory will run into the same problem and report it
+					LOG_WARN << "Failed to preload " << component.type << ": " << e.what();
+				}
+				std::lock_guard<std::mutex> lock(mutex);
+				ready[i] = true;
+				preloaded.notify_one();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		unsigned int threadCount = static_cast<unsigned int>(std::min<size_t>(this->workers, total));
+		for (unsigned int t = 0; t < threadCount; ++t) {
+			threads.push_back(std::thread(work));
+		}
+
+		auto join = [&threads] () {
+			for (auto titr = threads.begin(); titr != threads.end(); ++titr) {
+				titr->join();
+			}
+		};
+
+		// Create the components in scene order; later components may refer to earlier ones
+		try {
+			for (size_t i = 0; i < total; ++i) {
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					preloaded.wait(lock, [&ready, i] () { return ready[i]; });
+				}
+				parser::Entity& entity = entities[components[i].first];
+				parser::Component& component = entity.components[components[i].second];
+				if (create) {
+					create(entity, component);
+				}
+				else {
+					this->factory.create(component.typeID, entity.id, component.properties);
+				}
+				if (onProgress) {
+					onProgress(i + 1, total);
+				}
+			}
+		}
+		catch (...) {
+			next = total; // stop the workers
+			join();
+			throw;
+		}
+		join();
+		return true;
+	}
+}
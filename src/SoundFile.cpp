@@ -346,11 +346,12 @@ namespace Sigma {
 				}
 				}
 				break;
-			case PCM:
-				sf.hasmeta = true;
-				break;
 			default:
-				sf.hasmeta = true;
+				// Nothing to read; a file shared between decoders is only written while it has no meta
+				this->hasmeta = true;
+				if(!sf.hasmeta) {
+					sf.hasmeta = true;
+				}
 				break;
 			}
 		}
@@ -0,0 +1,115 @@
+#include "SystemScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Sigma {
+	namespace {
+		bool Shares(const std::vector<ComponentID>& a, const std::vector<ComponentID>& b) {
+			for (auto aitr = a.begin(); aitr != a.end(); ++aitr) {
+				if (std::find(b.begin(), b.end(), *aitr) != b.end()) {
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+
+	bool SystemAccess::ConflictsWith(const SystemAccess& other) const {
+		return Shares(this->writes, other.writes) || Shares(this->writes, other.reads) || Shares(this->reads, other.writes);
+	}
+
+	SystemScheduler::SystemScheduler(JobSystem& jobs) : jobs(jobs), frameTime(0.0), remaining(0) { }
+
+	void SystemScheduler::Add(const std::string& name, const SystemAccess& access, UpdateFunction update) {
+		size_t added = this->systems.size();
+		this->systems.push_back(System(access, update));
+		this->timings.push_back(SystemTime(name));
+		for (size_t s = 0; s < added; ++s) {
+			if (this->systems[s].access.ConflictsWith(access)) {
+				this->systems[s].successors.push_back(added);
+				++this->systems[added].predecessors;
+			}
+		}
+		this->waiting.reset(new std::atomic<unsigned int>[this->systems.size()]);
+	}
+
+	void SystemScheduler::Update(double delta) {
+		auto frameStart = std::chrono::high_resolution_clock::now();
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->remaining = this->systems.size();
+			this->error = nullptr;
+		}
+		for (size_t s = 0; s < this->systems.size(); ++s) {
+			this->waiting[s] = this->systems[s].predecessors;
+		}
+		for (size_t s = 0; s < this->systems.size(); ++s) {
+			if (this->systems[s].predecessors == 0) {
+				Start(s, delta);
+			}
+		}
+
+		// Run the main thread systems as they become ready, until every system is done
+		std::unique_lock<std::mutex> lock(this->mutex);
+		while (true) {
+			this->changed.wait(lock, [this] () { return !this->mainReady.empty() || this->remaining == 0; });
+			if (this->mainReady.empty()) {
+				break;
+			}
+			size_t system = this->mainReady.back();
+			this->mainReady.pop_back();
+			lock.unlock();
+			std::exception_ptr error;
+			try {
+				Run(system, delta);
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+			Finish(system, delta, error);
+			lock.lock();
+		}
+		std::exception_ptr error = this->error;
+		lock.unlock();
+
+		this->frameTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - frameStart).count();
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	void SystemScheduler::Start(size_t system, double delta) {
+		if (this->systems[system].access.mainThread) {
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->mainReady.push_back(system);
+			this->changed.notify_one();
+		}
+		else {
+			this->jobs.Submit([this, system, delta] () { Run(system, delta); },
+				[this, system, delta] (std::exception_ptr error) { Finish(system, delta, error); });
+		}
+	}
+
+	void SystemScheduler::Run(size_t system, double delta) {
+		auto start = std::chrono::high_resolution_clock::now();
+		this->systems[system].update(delta);
+		this->timings[system].seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void SystemScheduler::Finish(size_t system, double delta, std::exception_ptr error) {
+		// Successors are started before this system counts as done, so the frame can't end early
+		const std::vector<size_t>& successors = this->systems[system].successors;
+		for (auto sitr = successors.begin(); sitr != successors.end(); ++sitr) {
+			if (--this->waiting[*sitr] == 0) {
+				Start(*sitr, delta);
+			}
+		}
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (error && !this->error) {
+			this->error = error;
+		}
+		--this->remaining;
+		this->changed.notify_one();
+	}
+}
@@ -0,0 +1,28 @@
+#include "TransformHierarchy.h"
+
+namespace Sigma {
+	const uint32_t TransformHierarchy::NONE;
+	const uint32_t TransformHierarchy::UNVISITED;
+	const uint32_t TransformHierarchy::VISITING;
+
+	TransformHierarchy::TransformHierarchy() : depth(0) { }
+
+	void TransformHierarchy::Clear(size_t count) {
+		for (size_t d = 0; d < this->depth; ++d) {
+			this->levels[d].clear();
+		}
+		this->depth = 0;
+		this->depths.assign(count, UNVISITED);
+	}
+
+	void TransformHierarchy::Place(uint32_t index, uint32_t depth) {
+		this->depths[index] = depth;
+		if (depth >= this->levels.size()) {
+			this->levels.resize(depth + 1);
+		}
+		if (depth >= this->depth) {
+			this->depth = depth + 1;
+		}
+		this->levels[depth].push_back(index);
+	}
+}
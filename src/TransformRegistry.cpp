@@ -0,0 +1,70 @@
+#include "TransformRegistry.h"
+
+#include <memory>
+#include <vector>
+
+namespace Sigma {
+	namespace {
+		const unsigned int PAGE_BITS = 10;
+		const size_t PAGE_SIZE = 1 << PAGE_BITS;
+
+		struct Entry {
+			Entry() : entityID(0), transform(nullptr) { }
+			id_t entityID; // the full ID, to tell generations of the index apart
+			GLTransform* transform; // nullptr if the slot is free
+		};
+
+		std::vector<std::unique_ptr<Entry[]>>& Pages() {
+			static std::vector<std::unique_ptr<Entry[]>> pages; // entity index --> entry
+			return pages;
+		}
+
+		Entry* Find(id_t entityID) {
+			const id_t index = EntityIndex(entityID);
+			std::vector<std::unique_ptr<Entry[]>>& pages = Pages();
+			if ((index >> PAGE_BITS) >= pages.size() || !pages[index >> PAGE_BITS]) {
+				return nullptr;
+			}
+			return &pages[index >> PAGE_BITS][index & (PAGE_SIZE - 1)];
+		}
+	}
+
+	bool TransformRegistry::Register(id_t entityID, GLTransform* transform) {
+		if (!transform) {
+			return false;
+		}
+		const id_t index = EntityIndex(entityID);
+		std::vector<std::unique_ptr<Entry[]>>& pages = Pages();
+		if ((index >> PAGE_BITS) >= pages.size()) {
+			pages.resize((index >> PAGE_BITS) + 1);
+		}
+		if (!pages[index >> PAGE_BITS]) {
+			pages[index >> PAGE_BITS].reset(new Entry[PAGE_SIZE]);
+		}
+
+		Entry& entry = pages[index >> PAGE_BITS][index & (PAGE_SIZE - 1)];
+		if (entry.transform && entry.entityID == entityID) {
+			return false;
+		}
+		// A stale generation of the index is replaced
+		entry.entityID = entityID;
+		entry.transform = transform;
+		return true;
+	}
+
+	void TransformRegistry::Unregister(id_t entityID, const GLTransform* transform) {
+		Entry* entry = Find(entityID);
+		if (entry && entry->entityID == entityID && entry->transform == transform) {
+			entry->transform = nullptr;
+		}
+	}
+
+	GLTransform* TransformRegistry::Get(id_t entityID) {
+		const Entry* entry = Find(entityID);
+		return (entry && entry->entityID == entityID) ? entry->transform : nullptr;
+	}
+
+	void TransformRegistry::Clear() {
+		Pages().clear();
+	}
+}
@@ -0,0 +1,298 @@
+#include "TransformStore.h"
+
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SIGMA_TRANSFORM_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Sigma {
+	const TransformStore::Handle TransformStore::NONE;
+	const size_t TransformStore::SLOTS_PER_PAGE;
+
+	namespace {
+		// The scalar version of the SSE kernel, doing the same operations in the same order
+		void ComposeSlot(TransformStore::Page& page, size_t i) {
+			const float x = page.qx[i], y = page.qy[i], z = page.qz[i], w = page.qw[i];
+			const float tx = 2.0f * x, ty = 2.0f * y, tz = 2.0f * z, tw = 2.0f * w;
+			float* m = page.local[i];
+			m[0] = (1.0f - ty * y - tz * z) * page.sx[i];
+			m[1] = (tx * y + tw * z) * page.sx[i];
+			m[2] = (tx * z - tw * y) * page.sx[i];
+			m[3] = 0.0f;
+			m[4] = (tx * y - tw * z) * page.sy[i];
+			m[5] = (1.0f - tx * x - tz * z) * page.sy[i];
+			m[6] = (ty * z + tw * x) * page.sy[i];
+			m[7] = 0.0f;
+			m[8] = (tx * z + tw * y) * page.sz[i];
+			m[9] = (ty * z - tw * x) * page.sz[i];
+			m[10] = (1.0f - tx * x - ty * y) * page.sz[i];
+			m[11] = 0.0f;
+			m[12] = page.px[i];
+			m[13] = page.py[i];
+			m[14] = page.pz[i];
+			m[15] = 1.0f;
+			page.flags[i] = (page.flags[i] & ~TransformStore::LOCAL_DIRTY) | TransformStore::WORLD_DIRTY;
+		}
+
+		// out = a * b, column-major; out must not be a or b
+		void Multiply(const float* a, const float* b, float* out) {
+#ifdef SIGMA_TRANSFORM_SSE
+			const __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+			for (int c = 0; c < 4; ++c) {
+				const float* column = b + c * 4;
+				__m128 result = _mm_mul_ps(a0, _mm_set1_ps(column[0]));
+				result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(column[1])));
+				result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(column[2])));
+				result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_set1_ps(column[3])));
+				_mm_storeu_ps(out + c * 4, result);
+			}
+#else
+			for (int c = 0; c < 4; ++c) {
+				for (int r = 0; r < 4; ++r) {
+					out[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1] + a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+				}
+			}
+#endif
+		}
+	}
+
+	TransformStore& TransformStore::Instance() {
+		static TransformStore* store = new TransformStore();
+		return *store;
+	}
+
+	TransformStore::TransformStore() : count(0), structureVersion(1), orderVersion(0) { }
+
+	bool TransformStore::HasSIMD() {
+#ifdef SIGMA_TRANSFORM_SSE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	TransformStore::Handle TransformStore::Create() {
+		uint32_t index;
+		if (!this->freeSlots.empty()) {
+			index = this->freeSlots.back();
+			this->freeSlots.pop_back();
+		}
+		else {
+			if (this->count >= (size_t(1) << HANDLE_INDEX_BITS) - 1) { // the last index would make NONE
+				LOG_ERROR << "Out of transform slots";
+				return NONE;
+			}
+			index = static_cast<uint32_t>(this->count++);
+			if ((index >> PAGE_BITS) >= this->pages.size()) {
+				this->pages.push_back(std::unique_ptr<Page>(new Page()));
+			}
+		}
+
+		Page& page = *this->pages[index >> PAGE_BITS];
+		const size_t slot = index & (SLOTS_PER_PAGE - 1);
+		page.px[slot] = page.py[slot] = page.pz[slot] = 0.0f;
+		page.qx[slot] = page.qy[slot] = page.qz[slot] = 0.0f;
+		page.qw[slot] = 1.0f;
+		page.sx[slot] = page.sy[slot] = page.sz[slot] = 1.0f;
+		page.parent[slot] = NONE;
+		page.worldVersion[slot] = 0;
+		page.parentVersion[slot] = 0;
+		page.flags[slot] = ALIVE | LOCAL_DIRTY | WORLD_DIRTY;
+		page.dirty = true;
+		++this->structureVersion;
+		return (static_cast<Handle>(page.generation[slot]) << HANDLE_INDEX_BITS) | index;
+	}
+
+	void TransformStore::Destroy(Handle handle) {
+		if (!Valid(handle)) {
+			return;
+		}
+		Page& page = PageOf(handle);
+		const size_t slot = Slot(handle);
+		page.flags[slot] = 0;
+		++page.generation[slot];
+		this->freeSlots.push_back(static_cast<uint32_t>(Index(handle)));
+		++this->structureVersion;
+	}
+
+	void TransformStore::Copy(Handle from, Handle to) {
+		if (!Valid(from) || !Valid(to) || from == to) {
+			return;
+		}
+		const Page& source = PageOf(from);
+		const size_t i = Slot(from);
+		SetPosition(to, source.px[i], source.py[i], source.pz[i]);
+		SetOrientation(to, source.qx[i], source.qy[i], source.qz[i], source.qw[i]);
+		SetScale(to, source.sx[i], source.sy[i], source.sz[i]);
+		SetParent(to, source.parent[i]);
+	}
+
+	void TransformStore::SetParent(Handle handle, Handle parent) {
+		Page& page = PageOf(handle);
+		const size_t slot = Slot(handle);
+		page.parent[slot] = parent;
+		page.flags[slot] |= WORLD_DIRTY;
+		++this->structureVersion;
+	}
+
+	const float* TransformStore::GetWorldMatrix(Handle handle) {
+		Page& page = PageOf(handle);
+		const size_t slot = Slot(handle);
+		if (Valid(page.parent[slot])) {
+			GetWorldMatrix(page.parent[slot]);
+		}
+		if (page.flags[slot] & LOCAL_DIRTY) {
+			ComposeSlot(page, slot);
+		}
+		UpdateWorld(Index(handle));
+		return page.world[slot];
+	}
+
+	void TransformStore::UpdateWorld(size_t index) {
+		Page& page = *this->pages[index >> PAGE_BITS];
+		const size_t slot = index & (SLOTS_PER_PAGE - 1);
+		const Handle parent = page.parent[slot];
+		Page* parentPage = nullptr;
+		size_t parentSlot = 0;
+		if (parent != NONE) {
+			if (Valid(parent)) {
+				parentPage = &PageOf(parent);
+				parentSlot = Slot(parent);
+				if (parentPage->worldVersion[parentSlot] != page.parentVersion[slot]) {
+					page.flags[slot] |= WORLD_DIRTY;
+				}
+			}
+			else {
+				// The parent was destroyed
+				page.parent[slot] = NONE;
+				page.flags[slot] |= WORLD_DIRTY;
+			}
+		}
+
+		if (page.flags[slot] & WORLD_DIRTY) {
+			if (parentPage) {
+				Multiply(parentPage->world[parentSlot], page.local[slot], page.world[slot]);
+				page.parentVersion[slot] = parentPage->worldVersion[parentSlot];
+			}
+			else {
+				std::copy(page.local[slot], page.local[slot] + 16, page.world[slot]);
+			}
+			++page.worldVersion[slot];
+			page.flags[slot] &= ~WORLD_DIRTY;
+		}
+	}
+
+	void TransformStore::ComposeLocal(Page& page, size_t begin, size_t end, bool simd) {
+		size_t i = begin;
+#ifdef SIGMA_TRANSFORM_SSE
+		if (simd) {
+			const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+			for (; i + 4 <= end; i += 4) {
+				const bool dirty[4] = { (page.flags[i] & LOCAL_DIRTY) != 0, (page.flags[i + 1] & LOCAL_DIRTY) != 0,
+					(page.flags[i + 2] & LOCAL_DIRTY) != 0, (page.flags[i + 3] & LOCAL_DIRTY) != 0 };
+				if (!dirty[0] && !dirty[1] && !dirty[2] && !dirty[3]) {
+					continue;
+				}
+
+				const __m128 x = _mm_loadu_ps(page.qx + i), y = _mm_loadu_ps(page.qy + i);
+				const __m128 z = _mm_loadu_ps(page.qz + i), w = _mm_loadu_ps(page.qw + i);
+				const __m128 tx = _mm_mul_ps(two, x), ty = _mm_mul_ps(two, y), tz = _mm_mul_ps(two, z), tw = _mm_mul_ps(two, w);
+				const __m128 sx = _mm_loadu_ps(page.sx + i), sy = _mm_loadu_ps(page.sy + i), sz = _mm_loadu_ps(page.sz + i);
+
+				// Each register holds one element of the four matrices; transposing turns them
+				// into one column of each matrix.
+				__m128 c0 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, _mm_mul_ps(ty, y)), _mm_mul_ps(tz, z)), sx);
+				__m128 c1 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(tx, y), _mm_mul_ps(tw, z)), sx);
+				__m128 c2 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(tx, z), _mm_mul_ps(tw, y)), sx);
+				__m128 c3 = zero;
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+				const __m128 column0[4] = { c0, c1, c2, c3 };
+
+				c0 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(tx, y), _mm_mul_ps(tw, z)), sy);
+				c1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, _mm_mul_ps(tx, x)), _mm_mul_ps(tz, z)), sy);
+				c2 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(ty, z), _mm_mul_ps(tw, x)), sy);
+				c3 = zero;
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+				const __m128 column1[4] = { c0, c1, c2, c3 };
+
+				c0 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(tx, z), _mm_mul_ps(tw, y)), sz);
+				c1 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(ty, z), _mm_mul_ps(tw, x)), sz);
+				c2 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, _mm_mul_ps(tx, x)), _mm_mul_ps(ty, y)), sz);
+				c3 = zero;
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+				const __m128 column2[4] = { c0, c1, c2, c3 };
+
+				c0 = _mm_loadu_ps(page.px + i);
+				c1 = _mm_loadu_ps(page.py + i);
+				c2 = _mm_loadu_ps(page.pz + i);
+				c3 = one;
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+				const __m128 column3[4] = { c0, c1, c2, c3 };
+
+				for (size_t lane = 0; lane < 4; ++lane) {
+					if (dirty[lane]) {
+						float* m = page.local[i + lane];
+						_mm_storeu_ps(m, column0[lane]);
+						_mm_storeu_ps(m + 4, column1[lane]);
+						_mm_storeu_ps(m + 8, column2[lane]);
+						_mm_storeu_ps(m + 12, column3[lane]);
+						page.flags[i + lane] = (page.flags[i + lane] & ~LOCAL_DIRTY) | WORLD_DIRTY;
+					}
+				}
+			}
+		}
+#else
+		(void)simd;
+#endif
+		for (; i < end; ++i) {
+			if (page.flags[i] & LOCAL_DIRTY) {
+				ComposeSlot(page, i);
+			}
+		}
+	}
+
+	void TransformStore::BuildOrder() {
+		auto parentOf = [this] (uint32_t index) -> uint32_t {
+			const Handle parent = this->pages[index >> PAGE_BITS]->parent[index & (SLOTS_PER_PAGE - 1)];
+			return Valid(parent) ? static_cast<uint32_t>(Index(parent)) : TransformHierarchy::NONE;
+		};
+		this->hierarchy.Clear(this->count);
+		for (size_t index = 0; index < this->count; ++index) {
+			if (this->pages[index >> PAGE_BITS]->flags[index & (SLOTS_PER_PAGE - 1)] & ALIVE) {
+				this->hierarchy.Add(static_cast<uint32_t>(index), parentOf);
+			}
+		}
+		this->orderVersion = this->structureVersion;
+	}
+
+	void TransformStore::Update(JobSystem* jobs) {
+		if (this->orderVersion != this->structureVersion) {
+			BuildOrder();
+		}
+
+		// Local matrices, a page per job
+		const size_t used = this->count;
+		std::unique_ptr<Page>* pages = this->pages.data();
+		auto composePages = [pages, used] (size_t begin, size_t end) {
+			for (size_t p = begin; p < end; ++p) {
+				Page& page = *pages[p];
+				if (page.dirty) {
+					page.dirty = false;
+					ComposeLocal(page, 0, std::min(SLOTS_PER_PAGE, used - p * SLOTS_PER_PAGE));
+				}
+			}
+		};
+		const size_t pageCount = (used + SLOTS_PER_PAGE - 1) / SLOTS_PER_PAGE;
+		if (jobs) {
+			jobs->ParallelFor(0, pageCount, 1, composePages);
+		}
+		else {
+			composePages(0, pageCount);
+		}
+
+		// World matrices, a depth at a time
+		this->hierarchy.Update(jobs, 256, [this] (uint32_t index) { UpdateWorld(index); });
+	}
+}
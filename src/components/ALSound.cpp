@@ -16,9 +16,17 @@ namespace Sigma {
 			this->sourceid = 0;
 		}
 	}
-	void ALSound::Update() {
+	void ALSound::Prepare() {
+		this->file.reset();
+		if(playing && playlist.size() > 0) {
+			this->file = master->GetSoundFile(playlist[playindex]).lock();
+			if(this->file) {
+				this->file->ProcessMeta();
+			}
+		}
+	}
+	void ALSound::Update(FrameAllocator& scratch) {
 		ALint param;
-		long sfi;
 		int i;
 		int buflen;
 		int bufbytes;
@@ -33,18 +41,17 @@ namespace Sigma {
 			alGetSourcei(this->sourceid, AL_BUFFERS_PROCESSED, &param);
 			albuf = master->buffers[this->buffers[this->bufferindex]]->GetID();
 			if(param != 0 && playlist.size() > 0) {
-				sfi = playlist[playindex];
-				if(master->GetSoundFile(sfi).expired()) {
+				if(!this->file) {
 					return;
 				}
-				sfp = std::shared_ptr<resource::SoundFile>(master->GetSoundFile(sfi));
+				sfp = this->file;
 				if(stream) {
 					chancount = sfp->Channels();
 					samplerate = sfp->Frequency();
 					samplecount = samplerate * 2; // 2 sec buffers
 					buflen = chancount * samplecount;
 					bufbytes = buflen * sizeof(short);
-					buf = new short[buflen];
+					buf = static_cast<short*>(scratch.Allocate(bufbytes));
 					if(++this->bufferindex >= this->buffercount) {
 						this->bufferindex = 0;
 						LOG_DEBUG1 << "ALSound: Buffer-set wrap around";
@@ -83,7 +90,6 @@ namespace Sigma {
 							playing = false;
 						}
 					}
-					delete buf;
 				}
 			}
 			else if(param == this->buffercount && stream) {
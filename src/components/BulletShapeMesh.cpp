@@ -3,6 +3,17 @@
 
 namespace Sigma {
 
+	void CollisionMesh::Build(const MeshData& mesh) {
+		for (size_t i = 0; i < mesh.faces.size(); ++i) {
+			const Sigma::Face& f = mesh.faces[i];
+			const Sigma::Vertex& v1 = mesh.verts[f.v1];
+			const Sigma::Vertex& v2 = mesh.verts[f.v2];
+			const Sigma::Vertex& v3 = mesh.verts[f.v3];
+			this->triangles.addTriangle(btVector3(v1.x, v1.y, v1.z), btVector3(v2.x, v2.y, v2.z), btVector3(v3.x, v3.y, v3.z));
+		}
+		this->bvh.reset(new btBvhTriangleMeshShape(&this->triangles, false));
+	}
+
 	void Sigma::BulletShapeMesh::SetMesh(const GLMesh* mesh, btVector3* scale) {
 		this->btmesh = new btTriangleMesh();
 		for (unsigned int i = 0; i < mesh->GetFaceCount(); ++i) {
@@ -21,6 +32,11 @@ namespace Sigma {
 		SetMesh(mesh, new btVector3(scale, scale, scale));
 	}
 	
+	void Sigma::BulletShapeMesh::SetMesh(std::shared_ptr<CollisionMesh> mesh, const float scale) {
+		this->collisionMesh = mesh;
+		this->shape = new btScaledBvhTriangleMeshShape(mesh->bvh.get(), btVector3(scale, scale, scale));
+	}
+
 	// for backward compatibility, uses scale = 1.0f
 	void Sigma::BulletShapeMesh::SetMesh(const GLMesh* mesh) {
 		SetMesh(mesh, 1.0f);
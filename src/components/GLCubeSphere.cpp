@@ -7,11 +7,18 @@
 #include <sstream>
 
 #include "Sigma.h"
+#include "systems/GLState.h"
+#include "systems/GLUniform.h"
 
 const float epsilon = 0.0001f;
 
 // For std::find
 namespace Sigma {
+	namespace {
+		const GLUniform<GLint> cubeMapUniform("cubeMap");
+		const GLUniform<GLint> cubeNormalMapUniform("cubeNormalMap");
+	}
+
 	bool operator ==(const Vertex &lhs, const Vertex &rhs) { return ((abs(rhs.x - lhs.x) < epsilon) &&
 																	 (abs(rhs.y - lhs.y) < epsilon) &&
 																	 (abs(rhs.z - lhs.z) < epsilon)); }
@@ -25,6 +32,7 @@ namespace Sigma {
         if(this->_cubeNormalMap != 0) {
             glDeleteTextures(1, &this->_cubeNormalMap);
 		}
+        GLState::Get().Invalidate();
     }
 
     void GLCubeSphere::InitializeBuffers() {
@@ -75,11 +83,8 @@ namespace Sigma {
 		// shader program was compiled and linked in GLMesh::InitializeBuffers.
 		//  Now we can set relevant custom uniform values
 		this->shader->Use();
-		this->shader->AddUniform("cubeMap");
-		glUniform1i((*this->shader)("cubeMap"), 0);
-		this->shader->AddUniform("cubeNormalMap");
-		glUniform1i((*this->shader)("cubeNormalMap"), 1);
-		this->shader->UnUse();
+		cubeMapUniform.Set(*this->shader, 0);
+		cubeNormalMapUniform.Set(*this->shader, 1);
 
     } // function InitializeBuffers
 
@@ -201,45 +206,40 @@ namespace Sigma {
         }
     } // function Refine
 
-	void GLCubeSphere::Render(glm::mediump_float *view, glm::mediump_float *proj) {
+	glm::mat4 GLCubeSphere::DrawMatrix(const glm::mat4& view) const {
+        glm::mat4 model = this->modelMatrix;
         if(this->_fixToCamera) {
-            glm::mediump_float *view_ptr = view;
-            glm::mat4 view_matrix;
-
-            for(int i=0; i < 4; i++) {
-                for(int j=0; j < 4; j++) {
-                    view_matrix[i][j] = (*view_ptr++);
-                }
-            }
-
             // Extract position from view matrix
-            glm::mat3 rotMat(view_matrix);
-            glm::vec3 d(view_matrix[3]);
+            glm::mat3 rotMat(view);
+            glm::vec3 d(view[3]);
             glm::vec3 position = -d * rotMat;
-            this->Transform()->TranslateTo(position);
+            // Move the drawn matrix rather than the transform, which the simulation may be using
+            model[3] = glm::vec4(position, 1.0f);
+        }
+        return model;
+    } // function DrawMatrix
 
-			glDepthFunc(GL_LEQUAL);
+	void GLCubeSphere::Render(glm::mediump_float *view, glm::mediump_float *proj) {
+        GLState& state = GLState::Get();
+        if(this->_fixToCamera) {
+			state.DepthFunc(GL_LEQUAL);
         }
 
         // bind cubemap textures
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, this->_cubeMap);
+        state.BindTexture(0, GL_TEXTURE_CUBE_MAP, this->_cubeMap);
         if(this->_cubeNormalMap != 0){
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, this->_cubeNormalMap);
+            state.BindTexture(1, GL_TEXTURE_CUBE_MAP, this->_cubeNormalMap);
         }
 
         // render da mesh
         GLMesh::Render(view, proj);
 
-		// unbind that which GLMesh does not unbind
+		// unbind the normal cube map, so it isn't left on a unit the next mesh binds a 2D map to
         if(this->_cubeNormalMap != 0){
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+            state.BindTexture(1, GL_TEXTURE_CUBE_MAP, 0);
         }
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+        state.BindTexture(0, GL_TEXTURE_CUBE_MAP, 0);
 
-		glDepthFunc(GL_LESS);
+		state.DepthFunc(GL_LESS);
     } // function Render
 } // namespace Sigma
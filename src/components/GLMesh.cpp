@@ -12,13 +12,58 @@
 #include <iostream>
 #include <sstream>
 #include "resources/GLTexture.h"
+#include "resources/ResourceCache.h"
 #include "systems/OpenGLSystem.h"
+#include "systems/GLState.h"
+#include "systems/GLUniform.h"
 
 namespace Sigma{
 
 	// static member initialization
 	const std::string GLMesh::DEFAULT_SHADER = "shaders/mesh_deferred";
 
+	struct MeshGeometry {
+		GLuint vao;
+		std::vector<GLuint> buffers;
+
+		// Deleted with the last mesh drawing it, on the thread owning the OpenGL context
+		~MeshGeometry() {
+			glDeleteBuffers(this->buffers.size(), &this->buffers[0]);
+			glDeleteVertexArrays(1, &this->vao);
+			GLState::Get().Invalidate();
+		}
+	};
+
+	namespace {
+		// Parsed mesh files, shared by every GLMesh and collision shape loaded from them
+		resource::ResourceCache<MeshData> meshCache;
+
+		// The geometry set up for each mesh file and shader program, while meshes draw it
+		std::map<std::pair<std::string, GLuint>, std::weak_ptr<MeshGeometry>> sharedGeometry;
+
+		// The uniforms of the mesh shaders; the matrices are in the FrameData and ObjectData blocks
+		const GLUniform<GLint> texEnabledUniform("texEnabled");
+		const GLUniform<GLint> ambientTexEnabledUniform("ambientTexEnabled");
+		const GLUniform<GLint> diffuseTexEnabledUniform("diffuseTexEnabled");
+		const GLUniform<GLint> texAmbUniform("texAmb");
+		const GLUniform<GLint> texDiffUniform("texDiff");
+		const GLUniform<GLfloat> specularHardnessUniform("specularHardness");
+
+		// Returns the GL texture of a material map, or 0 if it couldn't be loaded
+		GLuint LoadMaterialTexture(const MaterialTexture& map, const char* kind) {
+			std::string filename = map.file;
+			convert_path(filename);
+			LOG << "Loading " << kind << " texture: " << map.path + filename;
+			// Keyed by the name in the material file, the file is relative to the mtl file
+			resource::GLTexture* texture = OpenGLSystem::LoadTexture(filename, map.path + filename);
+			if (!texture) {
+				LOG_WARN << "Error loading " << kind << " texture: " << map.path + filename;
+				return 0;
+			}
+			return texture->GetID();
+		}
+	}
+
 	GLMesh::GLMesh(const id_t entityID) : IGLComponent(entityID) {
 		memset(&this->buffers, 0, sizeof(this->buffers));
 		this->vao = 0;
@@ -36,17 +81,31 @@ namespace Sigma{
 			assert(0 && "Shader must be loaded before buffers can be initialized.");
 		}
 
+		GLState& state = GLState::Get();
+
+		// Meshes of a file already set up for this shader draw its vertex array
+		std::weak_ptr<MeshGeometry>* shared = nullptr;
+		if (!this->meshFile.empty()) {
+			shared = &sharedGeometry[std::make_pair(this->meshFile, this->shader->GetProgram())];
+			this->geometry = shared->lock();
+			if (this->geometry) {
+				this->vao = this->geometry->vao;
+				std::copy(this->geometry->buffers.begin(), this->geometry->buffers.end(), this->buffers);
+				return;
+			}
+		}
+
 		// We must create a vao and then store it in our GLMesh.
 		if (this->vao == 0) {
 			glGenVertexArrays(1, &this->vao); // Generate the VAO
 		}
-		glBindVertexArray(this->vao); // Bind the VAO
+		state.BindVertexArray(this->vao); // Bind the VAO
 
 		if (this->verts.size() > 0) {
 			if (this->buffers[this->VertBufIndex] == 0) {
 				glGenBuffers(1, &this->buffers[this->VertBufIndex]); 	// Generate the vertex buffer.
 			}
-			glBindBuffer(GL_ARRAY_BUFFER, this->buffers[this->VertBufIndex]); // Bind the vertex buffer.
+			state.BindBuffer(GL_ARRAY_BUFFER, this->buffers[this->VertBufIndex]); // Bind the vertex buffer.
 			glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * this->verts.size(), &this->verts.front(), GL_STATIC_DRAW); // Stores the verts in the vertex buffer.
 			GLint posLocation = glGetAttribLocation((*shader).GetProgram(), "in_Position"); // Find the location in the shader where the vertex buffer data will be placed.
 			glVertexAttribPointer(posLocation, 3, GL_FLOAT, GL_FALSE, 0, 0); // Tell the VAO the vertex data will be stored at the location we just found.
@@ -56,7 +115,7 @@ namespace Sigma{
 			if (this->buffers[this->UVBufIndex] == 0) {
 				glGenBuffers(1, &this->buffers[this->UVBufIndex]); 	// Generate the vertex buffer.
 			}
-			glBindBuffer(GL_ARRAY_BUFFER, this->buffers[this->UVBufIndex]); // Bind the vertex buffer.
+			state.BindBuffer(GL_ARRAY_BUFFER, this->buffers[this->UVBufIndex]); // Bind the vertex buffer.
 			glBufferData(GL_ARRAY_BUFFER, sizeof(TexCoord) * this->texCoords.size(), &this->texCoords.front(), GL_STATIC_DRAW); // Stores the verts in the vertex buffer.
 			GLint uvLocation = glGetAttribLocation((*shader).GetProgram(), "in_UV"); // Find the location in the shader where the vertex buffer data will be placed.
 			glVertexAttribPointer(uvLocation, 2, GL_FLOAT, GL_FALSE, 0, 0); // Tell the VAO the vertex data will be stored at the location we just found.
@@ -66,7 +125,7 @@ namespace Sigma{
 			if (this->buffers[this->ColorBufIndex] == 0) {
 				glGenBuffers(1, &this->buffers[this->ColorBufIndex]);
 			}
-			glBindBuffer(GL_ARRAY_BUFFER, this->buffers[this->ColorBufIndex]);
+			state.BindBuffer(GL_ARRAY_BUFFER, this->buffers[this->ColorBufIndex]);
 			glBufferData(GL_ARRAY_BUFFER, sizeof(Color) * this->colors.size(), &this->colors.front(), GL_STATIC_DRAW);
 			GLint colLocation = glGetAttribLocation((*shader).GetProgram(), "in_Color");
 			glVertexAttribPointer(colLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
@@ -76,101 +135,113 @@ namespace Sigma{
 			if (this->buffers[this->ElemBufIndex] == 0) {
 				glGenBuffers(1, &this->buffers[this->ElemBufIndex]); // Generate the element buffer.
 			}
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->buffers[this->ElemBufIndex]); // Bind the element buffer.
+			state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->buffers[this->ElemBufIndex]); // Bind the element buffer.
 			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Face) * this->faces.size(), &this->faces.front(), GL_STATIC_DRAW); // Store the faces in the element buffer.
 		}
 		if (this->vertNorms.size() > 0) {
 			if (this->buffers[this->NormalBufIndex] == 0) {
 				glGenBuffers(1, &this->buffers[this->NormalBufIndex]);
 			}
-			glBindBuffer(GL_ARRAY_BUFFER, this->buffers[this->NormalBufIndex]);
+			state.BindBuffer(GL_ARRAY_BUFFER, this->buffers[this->NormalBufIndex]);
 			glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex)*this->vertNorms.size(), &this->vertNorms[0], GL_STATIC_DRAW);
 			GLint normalLocation = glGetAttribLocation((*shader).GetProgram(), "in_Normal");
 			glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
 			glEnableVertexAttribArray(normalLocation);
 		}
 
-		glBindVertexArray(0); // Reset the buffer binding because we are good programmers.
+		state.BindVertexArray(0); // Reset the buffer binding because we are good programmers.
 
+		// The samplers' units are part of the program, so they are set once
 		this->shader->Use();
-		this->shader->AddUniform("in_Model");
-		this->shader->AddUniform("in_View");
-		this->shader->AddUniform("in_Proj");
-		this->shader->AddUniform("texEnabled");
-		this->shader->AddUniform("ambientTexEnabled");
-		this->shader->AddUniform("diffuseTexEnabled");
-		this->shader->AddUniform("texAmb");
-		this->shader->AddUniform("texDiff");
-		this->shader->AddUniform("specularHardness");
-		this->shader->UnUse();
+		texAmbUniform.Set(*this->shader, 1);
+		texDiffUniform.Set(*this->shader, 0);
+
+		if (shared) {
+			this->geometry = std::make_shared<MeshGeometry>();
+			this->geometry->vao = this->vao;
+			this->geometry->buffers.assign(this->buffers, this->buffers + sizeof(this->buffers) / sizeof(this->buffers[0]));
+			*shared = this->geometry;
+		}
 	}
 
-	void GLMesh::Render(glm::mediump_float *view, glm::mediump_float *proj) {
-		glm::mat4 modelMatrix = this->Transform()->GetMatrix();
-
-		//if(this->parentTransform != 0) {
-		//	modelMatrix = this->parentTransform->GetMatrix() * modelMatrix;
-		//}
+	void GLMesh::DeleteBuffers() {
+		if (!this->geometry) {
+			IGLComponent::DeleteBuffers();
+			return;
+		}
+		memset(this->buffers, 0, sizeof(this->buffers));
+		this->vao = 0;
+		this->geometry.reset();
+	}
 
-		this->shader->Use();
-		glUniformMatrix4fv((*this->shader)("in_Model"), 1, GL_FALSE, &modelMatrix[0][0]);
-		glUniformMatrix4fv((*this->shader)("in_View"), 1, GL_FALSE, view);
-		glUniformMatrix4fv((*this->shader)("in_Proj"), 1, GL_FALSE, proj);
+	void GLMesh::Render(glm::mediump_float *view, glm::mediump_float *proj) {
+		RenderInstances(view, proj, 1);
+	}
 
-		glBindVertexArray(this->Vao());
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->GetBuffer(this->ElemBufIndex));
+	void GLMesh::RenderInstances(glm::mediump_float *view, glm::mediump_float *proj, unsigned int instances) {
+		// The matrices are in the blocks OpenGLSystem binds, one model matrix per instance
+		GLSLShader& shader = *this->shader;
+		shader.Use();
 
-		if(this->cull_face == 0) {
-			glDisable(GL_CULL_FACE);
-		}
-		else {
-			glCullFace(this->cull_face);
-		}
+		// Draws sorted by the render queue share their program, VAO and culling with the
+		// previous draw, so the state is left as it is for the next one.
+		GLState& state = GLState::Get();
+		state.BindVertexArray(this->Vao());
+		state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->GetBuffer(this->ElemBufIndex));
+		state.CullFace(this->cull_face);
 
-		glActiveTexture(GL_TEXTURE0);
 		size_t prev = 0;
 		for (int i = 0, cur = this->MeshGroup_ElementCount(0); cur != 0; prev = cur, cur = this->MeshGroup_ElementCount(++i)) {
 			if (this->faceGroups.size() > 0) {
 				Material& mat = this->mats[this->faceGroups[prev]];
 
 				if (mat.ambientMap) {
-					glUniform1i((*this->shader)("texEnabled"), 1);
-					glUniform1i((*this->shader)("ambientTexEnabled"), 1);
-					glUniform1i((*this->shader)("texAmb"), 1);
-					glActiveTexture(GL_TEXTURE1);
-					glBindTexture(GL_TEXTURE_2D, mat.ambientMap);
+					texEnabledUniform.Set(shader, 1);
+					ambientTexEnabledUniform.Set(shader, 1);
+					state.BindTexture(1, GL_TEXTURE_2D, mat.ambientMap);
 				} else {
-					glUniform1i((*this->shader)("ambientTexEnabled"), 0);
+					ambientTexEnabledUniform.Set(shader, 0);
 				}
 
 				if (mat.diffuseMap) {
-					glUniform1i((*this->shader)("texEnabled"), 1);
-					glUniform1i((*this->shader)("diffuseTexEnabled"), 1);
-					glUniform1i((*this->shader)("texDiff"), 0);
-					glActiveTexture(GL_TEXTURE0);
-					glBindTexture(GL_TEXTURE_2D, mat.diffuseMap);
+					texEnabledUniform.Set(shader, 1);
+					diffuseTexEnabledUniform.Set(shader, 1);
+					state.BindTexture(0, GL_TEXTURE_2D, mat.diffuseMap);
 				} else {
-					glUniform1i((*this->shader)("diffuseTexEnabled"), 0);
+					diffuseTexEnabledUniform.Set(shader, 0);
 				}
 
-				glUniform1f((*this->shader)("specularHardness"), mat.hardness);
+				specularHardnessUniform.Set(shader, mat.hardness);
 			}
 			else {
-				glUniform1i((*this->shader)("texEnabled"), 0);
-				glUniform1i((*this->shader)("diffuseTexEnabled"), 0);
-				glUniform1i((*this->shader)("ambientTexEnabled"), 0);
+				texEnabledUniform.Set(shader, 0);
+				diffuseTexEnabledUniform.Set(shader, 0);
+				ambientTexEnabledUniform.Set(shader, 0);
 			}
-			glDrawElements(this->DrawMode(), cur, GL_UNSIGNED_INT, (void*)prev);
+			glDrawElementsInstanced(this->DrawMode(), cur, GL_UNSIGNED_INT, (void*)prev, instances);
 		}
+	} // function RenderInstances
 
-		// reset defaults
-		glEnable(GL_CULL_FACE);
-		glCullFace(GL_BACK);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,0);
-		glBindVertexArray(0);
-		glBindTexture(GL_TEXTURE_2D, 0);
-		this->shader->UnUse();
-	} // function Render
+	bool GLMesh::InstancesWith(const IGLComponent& other) const {
+		// Only meshes of the same file and shader share geometry, so other is such a GLMesh
+		if (!this->geometry || other.Vao() != this->vao) {
+			return false;
+		}
+		const GLMesh& mesh = static_cast<const GLMesh&>(other);
+		return mesh.cull_face == this->cull_face
+			&& mesh.texReplace == this->texReplace && mesh.texReplaceWith == this->texReplaceWith;
+	}
+
+	unsigned int GLMesh::MaterialKey() const {
+		if (this->faceGroups.empty()) {
+			return 0;
+		}
+		auto mat = this->mats.find(this->faceGroups.begin()->second);
+		if (mat == this->mats.end()) {
+			return 0;
+		}
+		return mat->second.diffuseMap ? mat->second.diffuseMap : mat->second.ambientMap;
+	}
 
 	bool operator ==(const VertexIndices &lhs, const VertexIndices &rhs) {
 		return (lhs.vertex==rhs.vertex &&
@@ -180,6 +251,58 @@ namespace Sigma{
 	}
 
 	bool GLMesh::LoadMesh(std::string fname) {
+		std::shared_ptr<const MeshData> data = GetMeshData(fname);
+		if (!data) {
+			return false;
+		}
+
+		this->meshFile = fname;
+		this->groupIndex = data->groupIndex;
+		this->faces = data->faces;
+		this->faceGroups = data->faceGroups;
+		this->verts = data->verts;
+		this->vertNorms = data->vertNorms;
+		this->texCoords = data->texCoords;
+		this->colors = data->colors;
+		this->mats = data->mats;
+		LoadTextures(*data);
+		return true;
+	} // function LoadMesh
+
+	std::shared_ptr<const MeshData> GLMesh::GetMeshData(const std::string& fname) {
+		return meshCache.Load(fname, &GLMesh::LoadMeshData);
+	}
+
+	void GLMesh::LoadTextures(const MeshData& data) {
+		for (auto titr = data.matTextures.begin(); titr != data.matTextures.end(); ++titr) {
+			Material& m = this->mats[titr->first];
+			const MaterialTextures& textures = titr->second;
+
+			if (!textures.diffuse.file.empty()) {
+				if (texReplaceWith.length() > 0 && texReplace == textures.diffuse.file) {
+					resource::GLTexture* texture = OpenGLSystem::LoadTexture(texReplaceWith, "");
+					if (texture) {
+						LOG << "Using diffuse texture: " << texReplaceWith;
+						m.diffuseMap = texture->GetID();
+					}
+					else {
+						LOG_WARN << "Error loading diffuse texture: " << texReplaceWith;
+					}
+				}
+				else {
+					m.diffuseMap = LoadMaterialTexture(textures.diffuse, "diffuse");
+				}
+			}
+			if (!textures.ambient.file.empty()) {
+				m.ambientMap = LoadMaterialTexture(textures.ambient, "ambient");
+			}
+			if (!textures.normal.file.empty()) {
+				m.normalMap = LoadMaterialTexture(textures.normal, "normal or bump");
+			}
+		}
+	} // function LoadTextures
+
+	bool GLMesh::LoadMeshData(const std::string& fname, MeshData& data) {
 		// Extract the path from the filename.
 		std::string path;
 		if (fname.find("/") != std::string::npos) {
@@ -301,11 +424,11 @@ namespace Sigma{
 				temp_face_indices.push_back(current_face);
 			}
 			else if (line.substr(0,1) == "g") { // Face group
-				this->groupIndex.push_back(temp_face_indices.size());
+				data.groupIndex.push_back(temp_face_indices.size());
 			}
 			else if (line.substr(0, line.find(' ')) == "mtllib") { // Material library
 				// Add the path to the filename to load it relative to the obj file.
-				ParseMTL(path + line.substr(line.find(' ') + 1));
+				ParseMTL(path + line.substr(line.find(' ') + 1), data);
 			}
 			else if (line.substr(0, line.find(' ')) == "usemtl") { // Use material
 				std::string mtlname = line.substr(line.find(' ') + 1);
@@ -314,14 +437,14 @@ namespace Sigma{
 				currentMtlGroup = mtlname;
 
 				// Push back color (for now)
-				Material m = this->mats[mtlname];
+				const Material& m = data.mats[mtlname];
 				glm::vec3 amb(m.ka[0], m.ka[1], m.ka[2]);
 				glm::vec3 spec(m.ks[0], m.ks[1], m.ks[2]);
 				glm::vec3 dif(m.kd[0], m.kd[1], m.kd[2]);
 
 				glm::vec3 color = amb + dif + spec;
 				temp_colors.push_back(Color(color.r, color.g, color.b));
-				this->faceGroups[temp_face_indices.size()] = currentMtlGroup;
+				data.faceGroups[temp_face_indices.size()] = currentMtlGroup;
 				current_color++;
 			}
 			else if ((line.substr(0,1) == "#") || (line.size() == 0)) { // Comment or blank line
@@ -350,17 +473,17 @@ namespace Sigma{
 				// if this combination of indicies doesn't exist,
 				// add the data to the attribute arrays
 				if (result == unique_vertices.end()) {
-					v[j] = this->verts.size();
+					v[j] = data.verts.size();
 
-					this->verts.push_back(temp_verts[temp_face_indices[i].v[j].vertex]);
+					data.verts.push_back(temp_verts[temp_face_indices[i].v[j].vertex]);
 					if (temp_uvs.size() > 0) {
-						this->texCoords.push_back(temp_uvs[temp_face_indices[i].v[j].uv]);
+						data.texCoords.push_back(temp_uvs[temp_face_indices[i].v[j].uv]);
 					}
 					if (temp_normals.size() > 0) {
-						this->vertNorms.push_back(temp_normals[temp_face_indices[i].v[j].normal]);
+						data.vertNorms.push_back(temp_normals[temp_face_indices[i].v[j].normal]);
 					}
 					if (temp_colors.size() > 0) {
-						this->colors.push_back(temp_colors[temp_face_indices[i].v[j].color]);
+						data.colors.push_back(temp_colors[temp_face_indices[i].v[j].color]);
 					}
 					unique_vertices.push_back(temp_face_indices[i].v[j]);
 				}
@@ -372,17 +495,17 @@ namespace Sigma{
 			}
 
 			// Push it back
-			this->faces.push_back(Face(v[0], v[1], v[2]));
+			data.faces.push_back(Face(v[0], v[1], v[2]));
 		}
 
 		// Check if vertex normals exist
-		if(vertNorms.size() == 0) {
+		if(data.vertNorms.size() == 0) {
 			std::vector<Vertex> surfaceNorms;
 
 			// compute surface normals
-			for(size_t i = 0; i < faces.size(); i++) {
+			for(size_t i = 0; i < data.faces.size(); i++) {
 				glm::vec3 vector1, vector2, cross, normal;
-				Vertex vert1(verts[faces[i].v1]), vert2(verts[faces[i].v2]), vert3(verts[faces[i].v3]);
+				Vertex vert1(data.verts[data.faces[i].v1]), vert2(data.verts[data.faces[i].v2]), vert3(data.verts[data.faces[i].v3]);
 
 				vector1 = glm::normalize(glm::vec3(vert2.x-vert1.x, vert2.y-vert1.y, vert2.z-vert1.z));
 				vector2 = glm::normalize(glm::vec3(vert3.x-vert1.x, vert3.y-vert1.y, vert3.z-vert1.z));
@@ -394,11 +517,11 @@ namespace Sigma{
 
 			// compute vertex normals
 			// should probably compute adjacency first, this could be slow
-			for(size_t i = 0; i < verts.size(); i++) {
+			for(size_t i = 0; i < data.verts.size(); i++) {
 				Vertex total_normals(0.0f, 0.0f, 0.0f);
 
-				for(size_t j = 0; j < faces.size(); j++) {
-					if (faces[j].v1 == i || faces[j].v2 == i || faces[j].v3 == i) {
+				for(size_t j = 0; j < data.faces.size(); j++) {
+					if (data.faces[j].v1 == i || data.faces[j].v2 == i || data.faces[j].v3 == i) {
 						total_normals.x += surfaceNorms[j].x;
 						total_normals.y += surfaceNorms[j].y;
 						total_normals.z += surfaceNorms[j].z;
@@ -408,23 +531,23 @@ namespace Sigma{
 				if(!(total_normals.x == 0.0f && total_normals.y == 0.0f && total_normals.z == 0.0f)) {
 					glm::vec3 final_normal(total_normals.x, total_normals.y, total_normals.z);
 					final_normal = glm::normalize(final_normal);
-					vertNorms.push_back(Vertex(final_normal.x, final_normal.y, final_normal.z));
+					data.vertNorms.push_back(Vertex(final_normal.x, final_normal.y, final_normal.z));
 				}
 				else {
-					vertNorms.push_back(Vertex(total_normals.x, total_normals.y, total_normals.z));
+					data.vertNorms.push_back(Vertex(total_normals.x, total_normals.y, total_normals.z));
 				}
 			}
 
 			surfaceNorms.clear();
 		}
 		return true;
-	} // function LoadMesh
+	} // function LoadMeshData
 
 	void GLMesh::LoadShader() {
 		IGLComponent::LoadShader(GLMesh::DEFAULT_SHADER);
 	}
 
-	void GLMesh::ParseMTL(std::string fname) {
+	void GLMesh::ParseMTL(const std::string& fname, MeshData& data) {
 		// Extract the path from the filename.
 		std::string path;
 		if (fname.find("/") != std::string::npos) {
@@ -451,6 +574,7 @@ namespace Sigma{
 				std::string name;
 				s >> name;
 				Material m;
+				MaterialTextures textures; // Loaded by LoadTextures, on the main thread
 				getline(in, line);
 				s.clear();
 				s.str(line);
@@ -490,81 +614,20 @@ namespace Sigma{
 					else if (label == "map_Kd") {
 						std::string filename;
 						s >> filename;
-						filename = trim(filename);
-						if(filename.length() > 0 && texReplaceWith.length() > 0 && texReplace == filename) {
-							if (OpenGLSystem::textures.find(texReplaceWith) != OpenGLSystem::textures.end()) {
-								std::cerr << "Using diffuse texture: " << texReplaceWith << std::endl;
-								m.diffuseMap = Sigma::OpenGLSystem::textures[texReplaceWith].GetID();
-							}
-						} else {
-							filename = convert_path(filename);
-							LOG << "Loading diffuse texture: " << path + filename;
-							resource::GLTexture texture;
-							if (OpenGLSystem::textures.find(filename) == OpenGLSystem::textures.end()) {
-								texture.LoadDataFromFile(path + filename);
-								if (texture.GetID() != 0) {
-									OpenGLSystem::textures[filename] = texture;
-								}
-							}
-
-							// Add the path to the filename to load it relative to the mtl file
-							if (OpenGLSystem::textures.find(filename) != OpenGLSystem::textures.end()) {
-								m.diffuseMap = Sigma::OpenGLSystem::textures[filename].GetID();
-							}
-						}
-						if (m.diffuseMap == 0) {
-							LOG_WARN << "Error loading diffuse texture: " << path + filename;
-						}
+						textures.diffuse.file = trim(filename);
+						textures.diffuse.path = path;
 					}
 					else if (label == "map_Ka") {
 						std::string filename;
 						s >> filename;
-						filename = trim(filename);
-						filename = convert_path(filename);
-						LOG << "Loading ambient texture: " << path + filename;
-						// Add the path to the filename to load it relative to the mtl file
-						resource::GLTexture texture;
-						if (OpenGLSystem::textures.find(filename) == OpenGLSystem::textures.end()) {
-							texture.LoadDataFromFile(path + filename);
-							if (texture.GetID() != 0) {
-								OpenGLSystem::textures[filename] = texture;
-							}
-						}
-
-						// It should be loaded, but in case an error occurred double check for it.
-						if (OpenGLSystem::textures.find(filename) != OpenGLSystem::textures.end()) {
-							m.ambientMap = Sigma::OpenGLSystem::textures[filename].GetID();
-						}
-
-						// Add the path to the filename to load it relative to the mtl file
-						if (m.ambientMap == 0) {
-							LOG_WARN << "Error loading ambient texture: " << path + filename;
-						}
+						textures.ambient.file = trim(filename);
+						textures.ambient.path = path;
 					}
 					else if (label == "map_Bump") {
 						std::string filename;
 						s >> filename;
-						filename = trim(filename);
-						filename = convert_path(filename);
-						LOG << "Loading normal or bump texture: " << path + filename;
-						// Add the path to the filename to load it relative to the mtl file
-						resource::GLTexture texture;
-						if (OpenGLSystem::textures.find(filename) == OpenGLSystem::textures.end()) {
-							texture.LoadDataFromFile(path + filename);
-							if (texture.GetID() != 0) {
-								OpenGLSystem::textures[filename] = texture;
-							}
-						}
-
-						// It should be loaded, but in case an error occurred double check for it.
-						if (OpenGLSystem::textures.find(filename) != OpenGLSystem::textures.end()) {
-							m.normalMap = Sigma::OpenGLSystem::textures[filename].GetID();
-						}
-
-						// Add the path to the filename to load it relative to the mtl file
-						if (m.normalMap == 0) {
-							LOG_WARN << "Error loading normal texture: " << path + filename;
-						}
+						textures.normal.file = trim(filename);
+						textures.normal.path = path;
 					}
 					else {
 						// Blank line
@@ -584,7 +647,8 @@ namespace Sigma{
 						break;
 					}
 				}
-				this->mats[name] = m;
+				data.mats[name] = m;
+				data.matTextures[name] = textures;
 			}
 		}
 	} // function ParseMTL
@@ -1,9 +1,15 @@
 #include "components/GLScreenQuad.h"
 #include "resources/GLTexture.h"
+#include "systems/GLState.h"
+#include "systems/GLUniform.h"
 
 #include "Sigma.h"
 
 namespace Sigma {
+	namespace {
+		const GLUniform<GLint> textureUniform("in_Texture");
+	}
+
 	GLScreenQuad::GLScreenQuad(const id_t  entityID) : GLMesh(entityID), texture(nullptr), x(0), y(0), w(0), h(0), inverted(false) {}
 	GLScreenQuad::~GLScreenQuad() {}
 
@@ -44,17 +50,17 @@ namespace Sigma {
 	void GLScreenQuad::Render(glm::mediump_float *view, glm::mediump_float *proj) {
 		//this->shader->Use();
 
-		glDisable(GL_CULL_FACE);
-		glDisable(GL_DEPTH_TEST);
-		glDepthMask(GL_FALSE);
+		GLState& state = GLState::Get();
+		state.CullFace(0);
+		state.DepthTest(false);
+		state.DepthMask(false);
 
-		glBindVertexArray(this->vao);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->GetBuffer(this->ElemBufIndex));
+		state.BindVertexArray(this->vao);
+		state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->GetBuffer(this->ElemBufIndex));
 
 		if(this->texture) {
-			glUniform1i(glGetUniformLocation((*this->shader).GetProgram(), "in_Texture"), 0);
-			glBindTexture(GL_TEXTURE_2D, this->texture->GetID());
-			glActiveTexture(GL_TEXTURE0);
+			textureUniform.Set(*this->shader, 0);
+			state.BindTexture(0, GL_TEXTURE_2D, this->texture->GetID());
 		}
 
 		size_t prev = 0;
@@ -62,16 +68,7 @@ namespace Sigma {
 			glDrawElements(this->DrawMode(), cur, GL_UNSIGNED_INT, (void*)prev);
 		}
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,0);
-		glBindVertexArray(0);
-
-		// Clear the texture for next frame
-
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		glEnable(GL_DEPTH_TEST);
-		glDepthMask(GL_TRUE);
-		glEnable(GL_CULL_FACE);
+		// Culling and depth stay off, the next draw sets what it needs
 
 		//this->shader->UnUse();
 	}
@@ -3,11 +3,21 @@
 #include "GL/glew.h"
 #endif
 #include "resources/GLTexture.h"
+#include "systems/GLState.h"
+#include "systems/GLUniform.h"
 
 namespace Sigma{
 
     const std::string GLSprite::DEFAULT_SHADER = "shaders/sprite";
 
+	namespace {
+		// The uniforms of the sprite shader
+		const GLUniform<glm::mat4> modelUniform("in_Model");
+		const GLUniform<glm::mat4> viewUniform("in_View");
+		const GLUniform<glm::mat4> projUniform("in_Proj");
+		const GLUniform<GLint> texUniform("tex");
+	}
+
     GLSprite::GLSprite( const id_t entityID /*= 0*/ ) : Sigma::IGLComponent(entityID), texture(nullptr)  {
         this->drawMode = GL_TRIANGLES;
         this->ElemBufIndex = 2;
@@ -46,11 +56,12 @@ namespace Sigma{
         };
 
         // We must create a vao and then store it in our GLSprite.
+        GLState& state = GLState::Get();
         glGenVertexArrays(1, &this->vao);
-        glBindVertexArray(this->vao);
+        state.BindVertexArray(this->vao);
 
         glGenBuffers(1, &this->buffers[this->VertBufIndex]);
-        glBindBuffer(GL_ARRAY_BUFFER, this->buffers[this->VertBufIndex]);
+        state.BindBuffer(GL_ARRAY_BUFFER, this->buffers[this->VertBufIndex]);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vert), vert, GL_STATIC_DRAW);
         GLint posLocation = glGetAttribLocation((*shader).GetProgram(), "in_Position");
         glVertexAttribPointer(posLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
@@ -58,30 +69,26 @@ namespace Sigma{
 
         static const GLushort elem[] = { 0, 1, 2, 3, 4, 5 };
         glGenBuffers(1, &this->buffers[this->ElemBufIndex]);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->buffers[this->ElemBufIndex]);
+        state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->buffers[this->ElemBufIndex]);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(elem), elem, GL_STATIC_DRAW);
 
         glGenBuffers(1, &this->buffers[this->ColorBufIndex]);
-        glBindBuffer(GL_ARRAY_BUFFER, this->buffers[this->ColorBufIndex]);
+        state.BindBuffer(GL_ARRAY_BUFFER, this->buffers[this->ColorBufIndex]);
         glBufferData(GL_ARRAY_BUFFER, sizeof(col), col, GL_STATIC_DRAW);
         GLint colLocation = glGetAttribLocation((*shader).GetProgram(), "in_Color");
         glVertexAttribPointer(colLocation, 3, GL_FLOAT, GL_FALSE, 0, 0);
         glEnableVertexAttribArray(colLocation);
 
         glGenBuffers(1, &this->buffers[this->UVBufIndex]);
-        glBindBuffer(GL_ARRAY_BUFFER, this->buffers[this->UVBufIndex]);
+        state.BindBuffer(GL_ARRAY_BUFFER, this->buffers[this->UVBufIndex]);
         glBufferData(GL_ARRAY_BUFFER,sizeof(uv),uv,GL_STATIC_DRAW);
         GLint uvlocation = glGetAttribLocation((*shader).GetProgram(),"in_UV");
         glVertexAttribPointer(uvlocation, 2, GL_FLOAT, GL_FALSE, 0, NULL);
         glEnableVertexAttribArray(uvlocation);
 
-		glBindVertexArray(0);
+		state.BindVertexArray(0);
 		this->shader->Use();
-		this->shader->AddUniform("in_Model");
-		this->shader->AddUniform("in_View");
-		this->shader->AddUniform("in_Proj");
-		this->shader->AddUniform("tex");
-		this->shader->UnUse();
+		texUniform.Set(*this->shader, 0);
     }
 
 	void GLSprite::LoadShader() {
@@ -90,30 +97,28 @@ namespace Sigma{
     }
 
     void GLSprite::Render(glm::mediump_float *view, glm::mediump_float *proj) {
-        this->shader->Use();
-
-		glm::mat4 modelMatrix = this->Transform()->GetMatrix();
+        GLSLShader& shader = *this->shader;
+        shader.Use();
 
-        glUniformMatrix4fv((*this->shader)("in_Model"), 1, GL_FALSE, &modelMatrix[0][0]);
-        glUniformMatrix4fv((*this->shader)("in_View"), 1, GL_FALSE, view);
-        glUniformMatrix4fv((*this->shader)("in_Proj"), 1, GL_FALSE, proj);
+        modelUniform.Set(shader, this->modelMatrix);
+        glUniformMatrix4fv(viewUniform.Location(shader), 1, GL_FALSE, view);
+        glUniformMatrix4fv(projUniform.Location(shader), 1, GL_FALSE, proj);
 
-        glBindVertexArray(this->Vao());
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->GetBuffer(this->ElemBufIndex));
+        GLState& state = GLState::Get();
+        state.BindVertexArray(this->Vao());
+        state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->GetBuffer(this->ElemBufIndex));
+        state.CullFace(GL_BACK);
 
 		// Check to make sure we have a valid texture
 		if (this->texture) {
-			glUniform1i((*this->shader)("tex"), 0);
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, this->texture->GetID());
+			state.BindTexture(0, GL_TEXTURE_2D, this->texture->GetID());
 		}
 
         glDrawElements(this->DrawMode(), this->MeshGroup_ElementCount(), GL_UNSIGNED_SHORT, (void*)0);
+    }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,0);
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        this->shader->UnUse();
+    unsigned int GLSprite::MaterialKey() const {
+        return this->texture ? this->texture->GetID() : 0;
     }
 
 	void GLSprite::SetTexture(Sigma::resource::GLTexture* texture) {
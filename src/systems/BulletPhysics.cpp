@@ -2,10 +2,13 @@
 #include "components/BulletShapeMesh.h"
 #include "components/GLMesh.h"
 #include "components/BulletShapeSphere.h"
+#include "PropertyBindings.h"
 
 namespace Sigma {
 	// We need ctor and dstor to be exported to a dll even if they don't do anything
-	BulletPhysics::BulletPhysics() {}
+	BulletPhysics::BulletPhysics()
+		: broadphase(nullptr), collisionConfiguration(nullptr), dispatcher(nullptr), solver(nullptr),
+		dynamicsWorld(nullptr), mover(nullptr), moverSphere(nullptr) {}
 	BulletPhysics::~BulletPhysics() {
 		if (this->mover != nullptr) {
 			delete this->mover;
@@ -62,49 +65,67 @@ namespace Sigma {
 		return retval;
 	}
 
+	std::map<std::string,Sigma::IFactory::PreloadFunction> BulletPhysics::getPreloadFunctions()
+	{
+		using namespace std::placeholders;
+		std::map<std::string,Sigma::IFactory::PreloadFunction> retval;
+		retval["BulletShapeMesh"] = std::bind(&BulletPhysics::PreloadBulletShapeMesh,this,_1);
+		return retval;
+	}
+
+	namespace {
+		struct BulletShapeProperties {
+			PlacementProperties placement;
+			std::string meshFile;
+		};
+
+		PropertyBindings<BulletShapeProperties> MakeBulletShapeMeshBindings() {
+			PropertyBindings<BulletShapeProperties> bindings;
+			BindPlacement(bindings, &BulletShapeProperties::placement);
+			bindings.Bind("meshFile", &BulletShapeProperties::meshFile);
+			return bindings;
+		}
+
+		bool BuildCollisionMesh(const std::string& meshFile, CollisionMesh& mesh) {
+			std::shared_ptr<const MeshData> data = GLMesh::GetMeshData(meshFile);
+			if (!data) {
+				return false;
+			}
+			mesh.Build(*data);
+			return true;
+		}
+
+		struct BulletShapeSphereProperties {
+			BulletShapeSphereProperties(BulletShapeSphere* sphere) : sphere(sphere) { }
+			BulletShapeSphere* sphere;
+			PlacementProperties placement;
+		};
+
+		PropertyBindings<BulletShapeSphereProperties> MakeBulletShapeSphereBindings() {
+			PropertyBindings<BulletShapeSphereProperties> bindings;
+			BindPlacement(bindings, &BulletShapeSphereProperties::placement);
+			bindings.Bind("radius", [] (BulletShapeSphereProperties& t, const Property& p) { t.sphere->SetRadius(p.Get<float>()); });
+			return bindings;
+		}
+	}
+
 	IComponent* BulletPhysics::createBulletShapeMesh(const id_t entityID, const std::vector<Property> &properties) {
-		BulletShapeMesh* mesh = new BulletShapeMesh(entityID);
+		static const PropertyBindings<BulletShapeProperties> bindings = MakeBulletShapeMeshBindings();
 
-		float scale = 1.0f;
-		float x = 0.0f;
-		float y = 0.0f;
-		float z = 0.0f;
-		float rx = 0.0f;
-		float ry = 0.0f;
-		float rz = 0.0f;
+		BulletShapeMesh* mesh = new BulletShapeMesh(entityID);
 
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &*propitr;
+		BulletShapeProperties props;
+		bindings.Apply(props, properties);
+		const PlacementProperties& place = props.placement;
 
-			if (p->GetName() == "scale") {
-				scale = p->Get<float>();
-			}
-			else if (p->GetName() == "x") {
-				x = p->Get<float>();
-			}
-			else if (p->GetName() == "y") {
-				y = p->Get<float>();
-			}
-			else if (p->GetName() == "z") {
-				z = p->Get<float>();
-			}
-			else if (p->GetName() == "rx") {
-				rx = p->Get<float>();
-			}
-			else if (p->GetName() == "ry") {
-				ry = p->Get<float>();
-			}
-			else if (p->GetName() == "rz") {
-				rz = p->Get<float>();
-			}
-			else if (p->GetName() == "meshFile") {
-				LOG << "Loading mesh: " << p->Get<std::string>();
-				GLMesh meshFile(0);
-				meshFile.LoadMesh(p->Get<std::string>());
-				mesh->SetMesh(&meshFile, scale);
+		if (!props.meshFile.empty()) {
+			LOG << "Loading mesh: " << props.meshFile;
+			std::shared_ptr<CollisionMesh> collisionMesh = this->collisionMeshes.Load(props.meshFile, BuildCollisionMesh);
+			if (collisionMesh) {
+				mesh->SetMesh(collisionMesh, place.scale);
 			}
 		}
-		mesh->InitializeRigidBody(x, y, z, rx, ry, rz);
+		mesh->InitializeRigidBody(place.x, place.y, place.z, place.rx, place.ry, place.rz);
 
 		this->dynamicsWorld->addRigidBody(mesh->GetRigidBody());
 
@@ -113,44 +134,26 @@ namespace Sigma {
 		return mesh;
 	}
 
-	IComponent* BulletPhysics::createBulletShapeSphere(const id_t entityID, const std::vector<Property> &properties) {
-		BulletShapeSphere* sphere = new BulletShapeSphere(entityID);
+	void BulletPhysics::PreloadBulletShapeMesh(const std::vector<Property> &properties) {
+		static const PropertyBindings<BulletShapeProperties> bindings = MakeBulletShapeMeshBindings();
 
-		float scale = 1.0f;
-		float x = 0.0f;
-		float y = 0.0f;
-		float z = 0.0f;
-		float rx = 0.0f;
-		float ry = 0.0f;
-		float rz = 0.0f;
+		BulletShapeProperties props;
+		bindings.Apply(props, properties);
+		if (!props.meshFile.empty()) {
+			this->collisionMeshes.Load(props.meshFile, BuildCollisionMesh);
+		}
+	}
 
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &*propitr;
+	IComponent* BulletPhysics::createBulletShapeSphere(const id_t entityID, const std::vector<Property> &properties) {
+		static const PropertyBindings<BulletShapeSphereProperties> bindings = MakeBulletShapeSphereBindings();
 
-			if (p->GetName() == "x") {
-				x = p->Get<float>();
-			}
-			else if (p->GetName() == "y") {
-				y = p->Get<float>();
-			}
-			else if (p->GetName() == "z") {
-				z = p->Get<float>();
-			}
-			else if (p->GetName() == "rx") {
-				rx = p->Get<float>();
-			}
-			else if (p->GetName() == "ry") {
-				ry = p->Get<float>();
-			}
-			else if (p->GetName() == "rz") {
-				rz = p->Get<float>();
-			}
-			else if (p->GetName() == "radius") {
-				sphere->SetRadius(p->Get<float>());
-			}
-		}
+		BulletShapeSphere* sphere = new BulletShapeSphere(entityID);
 
-		sphere->InitializeRigidBody(x, y, z, rx, ry, rz);
+		BulletShapeSphereProperties props(sphere);
+		bindings.Apply(props, properties);
+		const PlacementProperties& place = props.placement;
+
+		sphere->InitializeRigidBody(place.x, place.y, place.z, place.rx, place.ry, place.rz);
 
 		this->dynamicsWorld->addRigidBody(sphere->GetRigidBody());
 
@@ -159,10 +162,24 @@ namespace Sigma {
 		return sphere;
 	}
 
+	void BulletPhysics::cleanupComponent(IBulletShape* component) {
+		if (this->dynamicsWorld != nullptr && component->GetRigidBody() != nullptr) {
+			this->dynamicsWorld->removeRigidBody(component->GetRigidBody());
+		}
+	}
+
+	SystemAccess BulletPhysics::DataAccess() {
+		// The movers write the transforms of the bodies and the view they control
+		return SystemAccess().Writes("IBulletShape").Writes("GLTransform");
+	}
+
 	bool BulletPhysics::Update(const double delta) {
+		UpdateScope scope(*this); // contact callbacks may remove shapes
+
 		this->mover->UpdateForces(delta);
 
-		dynamicsWorld->stepSimulation(delta, 10);
+		// The caller steps at a fixed rate (see FixedStepClock), so no substeps of our own
+		dynamicsWorld->stepSimulation(delta, 0);
 
 		this->mover->UpdateTransform();
 
@@ -26,20 +26,49 @@ namespace Sigma{
     IComponent* FactorySystem::create(const std::string& type,
                                const id_t entityID,
                                const std::vector<Property> &properties){
-        if(registeredFactoryFunctions.find(type) != registeredFactoryFunctions.end()){
-						LOG << "Creating component of type: " << type;
-            return registeredFactoryFunctions[type](entityID, properties);
+        return create(ComponentTypeHash(type.c_str()), entityID, properties);
+    }
+
+    IComponent* FactorySystem::create(ComponentID typeID,
+                               const id_t entityID,
+                               const std::vector<Property> &properties){
+        auto factoryFunc = registeredFactoryFunctions.find(typeID);
+        if(factoryFunc != registeredFactoryFunctions.end()){
+						LOG << "Creating component of type: " << factoryFunc->second.first;
+            return factoryFunc->second.second(entityID, properties);
         } else{
-            LOG_DEBUG << "Error: Couldn't find component: " << type;
+            LOG_DEBUG << "Error: Couldn't find component with type ID: " << typeID;
             return nullptr;
         }
     }
 
+    void FactorySystem::preload(const std::string& type,
+                               const std::vector<Property> &properties) const{
+        preload(ComponentTypeHash(type.c_str()), properties);
+    }
+
+    void FactorySystem::preload(ComponentID typeID,
+                               const std::vector<Property> &properties) const{
+        auto preloadFunc = registeredPreloadFunctions.find(typeID);
+        if(preloadFunc != registeredPreloadFunctions.end()){
+            preloadFunc->second(properties);
+        }
+    }
+
     void FactorySystem::register_Factory(IFactory& Factory){
 			const auto& factoryfunctions = Factory.getFactoryFunctions();
 			for(auto FactoryFunc = factoryfunctions.begin(); FactoryFunc != factoryfunctions.end(); ++FactoryFunc){
 				LOG << "Registering component factory of type: " << FactoryFunc->first ;
-				registeredFactoryFunctions[FactoryFunc->first]=FactoryFunc->second;
+				ComponentID typeID = ComponentTypeHash(FactoryFunc->first.c_str());
+				auto registered = registeredFactoryFunctions.find(typeID);
+				if(registered != registeredFactoryFunctions.end() && registered->second.first != FactoryFunc->first){
+					LOG_ERROR << "Component types " << registered->second.first << " and " << FactoryFunc->first << " have the same type ID, rename one of them.";
+				}
+				registeredFactoryFunctions[typeID]=std::make_pair(FactoryFunc->first, FactoryFunc->second);
+			}
+			const auto& preloadfunctions = Factory.getPreloadFunctions();
+			for(auto PreloadFunc = preloadfunctions.begin(); PreloadFunc != preloadfunctions.end(); ++PreloadFunc){
+				registeredPreloadFunctions[ComponentTypeHash(PreloadFunc->first.c_str())]=PreloadFunc->second;
 			}
 		}
 
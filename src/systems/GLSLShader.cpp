@@ -3,11 +3,20 @@
 //Last Modified: February 2, 2011
 
 #include "systems/GLSLShader.h"
+#include "systems/UniformBlocks.h"
 #include <iostream>
 #include <fstream>
 
 #include "Sigma.h"
 
+namespace {
+	//The names of the uniform slots, by slot
+	std::vector<std::string>& SlotNames() {
+		static std::vector<std::string> names;
+		return names;
+	}
+}
+
 GLSLShader::GLSLShader(void)
 {
 	_totalShaders=0;
@@ -82,14 +91,18 @@ void GLSLShader::CreateAndLinkProgram() {
 	glDeleteShader(_shaders[VERTEX_SHADER]);
 	glDeleteShader(_shaders[FRAGMENT_SHADER]);
 	glDeleteShader(_shaders[GEOMETRY_SHADER]);
+
+	Sigma::BindUniformBlocks(_program);
+	_slotLocations.clear();
+	ResolveSlots();
 }
 
 void GLSLShader::Use() {
-	glUseProgram(_program);
+	Sigma::GLState::Get().UseProgram(_program);
 }
 
 void GLSLShader::UnUse() {
-	glUseProgram(0);
+	Sigma::GLState::Get().UseProgram(0);
 }
 
 void GLSLShader::AddAttribute(const std::string attribute) {
@@ -97,17 +110,35 @@ void GLSLShader::AddAttribute(const std::string attribute) {
 }
 
 //An indexer that returns the location of the attribute
-GLuint GLSLShader::operator [](const std::string attribute) {
+GLuint GLSLShader::operator [](const std::string& attribute) {
 	return _attributeList[attribute];
 }
 
-void GLSLShader::AddUniform(const std::string uniform) {
+void GLSLShader::AddUniform(const std::string& uniform) {
 	_uniformLocationList[uniform] = glGetUniformLocation(_program, uniform.c_str());
 }
 
-GLuint GLSLShader::operator()(const std::string uniform){
+GLuint GLSLShader::operator()(const std::string& uniform){
 	return _uniformLocationList[uniform];
 }
+
+unsigned int GLSLShader::UniformSlot(const std::string& uniform) {
+	std::vector<std::string>& names = SlotNames();
+	for (size_t i = 0; i < names.size(); ++i) {
+		if (names[i] == uniform) {
+			return static_cast<unsigned int>(i);
+		}
+	}
+	names.push_back(uniform);
+	return static_cast<unsigned int>(names.size() - 1);
+}
+
+void GLSLShader::ResolveSlots() {
+	const std::vector<std::string>& names = SlotNames();
+	for (size_t i = _slotLocations.size(); i < names.size(); ++i) {
+		_slotLocations.push_back(glGetUniformLocation(_program, names[i].c_str()));
+	}
+}
 GLuint GLSLShader::GetProgram() const {
 	return _program;
 }
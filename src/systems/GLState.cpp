@@ -0,0 +1,220 @@
+#include "systems/GLState.h"
+
+namespace Sigma {
+	namespace {
+		const GLuint UNKNOWN = 0xFFFFFFFF; // never a valid name or mode, so the next call sets the state
+	}
+
+	GLState& GLState::Get() {
+		static GLState state;
+		return state;
+	}
+
+	GLState::GLState() : issued(0), avoided(0) {
+		Invalidate();
+	}
+
+	void GLState::Invalidate() {
+		this->program = UNKNOWN;
+		this->vao = UNKNOWN;
+		this->arrayBuffer = UNKNOWN;
+		this->elementBuffer = UNKNOWN;
+		this->uniformBuffer = UNKNOWN;
+		for (unsigned int i = 0; i < UNIFORM_BINDINGS; ++i) {
+			this->uniformRanges[i].buffer = UNKNOWN;
+		}
+		this->activeUnit = UNKNOWN;
+		for (unsigned int i = 0; i < TEXTURE_UNITS; ++i) {
+			this->texture2D[i] = UNKNOWN;
+			this->textureCube[i] = UNKNOWN;
+		}
+		this->blend = UNKNOWN;
+		this->blendSource = UNKNOWN;
+		this->blendDestination = UNKNOWN;
+		this->depthTest = UNKNOWN;
+		this->depthFunc = UNKNOWN;
+		this->depthMask = UNKNOWN;
+		this->cullFace = UNKNOWN;
+		this->drawFramebuffer = UNKNOWN;
+		this->readFramebuffer = UNKNOWN;
+	}
+
+	bool GLState::Change(GLuint& tracked, GLuint value) {
+		if (tracked == value) {
+			++this->avoided;
+			return false;
+		}
+		tracked = value;
+		++this->issued;
+		return true;
+	}
+
+	void GLState::UseProgram(GLuint program) {
+		if (Change(this->program, program)) {
+			glUseProgram(program);
+		}
+	}
+
+	void GLState::BindVertexArray(GLuint vao) {
+		if (Change(this->vao, vao)) {
+			glBindVertexArray(vao);
+			this->elementBuffer = UNKNOWN;
+		}
+	}
+
+	void GLState::BindBuffer(GLenum target, GLuint buffer) {
+		GLuint* tracked = nullptr;
+		switch (target) {
+		case GL_ARRAY_BUFFER:
+			tracked = &this->arrayBuffer;
+			break;
+		case GL_ELEMENT_ARRAY_BUFFER:
+			tracked = &this->elementBuffer;
+			break;
+		case GL_UNIFORM_BUFFER:
+			tracked = &this->uniformBuffer;
+			break;
+		}
+		if (!tracked) {
+			++this->issued;
+			glBindBuffer(target, buffer);
+		}
+		else if (Change(*tracked, buffer)) {
+			glBindBuffer(target, buffer);
+		}
+	}
+
+	void GLState::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+		if (target == GL_UNIFORM_BUFFER && index < UNIFORM_BINDINGS) {
+			Range& range = this->uniformRanges[index];
+			if (range.buffer == buffer && range.offset == offset && range.size == size) {
+				++this->avoided;
+				return;
+			}
+			range.buffer = buffer;
+			range.offset = offset;
+			range.size = size;
+		}
+		if (target == GL_UNIFORM_BUFFER) {
+			this->uniformBuffer = buffer; // the range is bound to the target too
+		}
+		++this->issued;
+		glBindBufferRange(target, index, buffer, offset, size);
+	}
+
+	void GLState::ActiveTexture(GLuint unit) {
+		if (Change(this->activeUnit, unit)) {
+			glActiveTexture(GL_TEXTURE0 + unit);
+		}
+	}
+
+	void GLState::BindTexture(GLenum target, GLuint texture) {
+		GLuint* tracked = nullptr;
+		if (this->activeUnit < TEXTURE_UNITS) {
+			if (target == GL_TEXTURE_2D) {
+				tracked = &this->texture2D[this->activeUnit];
+			}
+			else if (target == GL_TEXTURE_CUBE_MAP) {
+				tracked = &this->textureCube[this->activeUnit];
+			}
+		}
+		if (!tracked) {
+			++this->issued;
+			glBindTexture(target, texture);
+		}
+		else if (Change(*tracked, texture)) {
+			glBindTexture(target, texture);
+		}
+	}
+
+	void GLState::BindTexture(GLuint unit, GLenum target, GLuint texture) {
+		// Check the unit's binding first, so a bound texture doesn't cost an active unit change
+		if (unit < TEXTURE_UNITS) {
+			GLuint tracked = (target == GL_TEXTURE_2D) ? this->texture2D[unit] :
+				(target == GL_TEXTURE_CUBE_MAP) ? this->textureCube[unit] : UNKNOWN;
+			if (tracked == texture) {
+				++this->avoided;
+				return;
+			}
+		}
+		ActiveTexture(unit);
+		BindTexture(target, texture);
+	}
+
+	void GLState::Blend(bool enabled) {
+		if (Change(this->blend, enabled ? 1 : 0)) {
+			if (enabled) {
+				glEnable(GL_BLEND);
+			}
+			else {
+				glDisable(GL_BLEND);
+			}
+		}
+	}
+
+	void GLState::BlendFunc(GLenum source, GLenum destination) {
+		if (this->blendSource == source && this->blendDestination == destination) {
+			++this->avoided;
+			return;
+		}
+		this->blendSource = source;
+		this->blendDestination = destination;
+		++this->issued;
+		glBlendFunc(source, destination);
+	}
+
+	void GLState::DepthTest(bool enabled) {
+		if (Change(this->depthTest, enabled ? 1 : 0)) {
+			if (enabled) {
+				glEnable(GL_DEPTH_TEST);
+			}
+			else {
+				glDisable(GL_DEPTH_TEST);
+			}
+		}
+	}
+
+	void GLState::DepthFunc(GLenum func) {
+		if (Change(this->depthFunc, func)) {
+			glDepthFunc(func);
+		}
+	}
+
+	void GLState::DepthMask(bool write) {
+		if (Change(this->depthMask, write ? 1 : 0)) {
+			glDepthMask(write ? GL_TRUE : GL_FALSE);
+		}
+	}
+
+	void GLState::CullFace(GLenum mode) {
+		const GLenum previous = this->cullFace;
+		if (!Change(this->cullFace, mode)) {
+			return;
+		}
+		if (mode == 0) {
+			glDisable(GL_CULL_FACE);
+		}
+		else {
+			if (previous == 0 || previous == UNKNOWN) {
+				++this->issued;
+				glEnable(GL_CULL_FACE);
+			}
+			glCullFace(mode);
+		}
+	}
+
+	void GLState::BindFramebuffer(GLenum target, GLuint framebuffer) {
+		if (target == GL_FRAMEBUFFER) {
+			if (this->drawFramebuffer == framebuffer && this->readFramebuffer == framebuffer) {
+				++this->avoided;
+				return;
+			}
+			this->drawFramebuffer = this->readFramebuffer = framebuffer;
+			++this->issued;
+			glBindFramebuffer(target, framebuffer);
+		}
+		else if (Change((target == GL_READ_FRAMEBUFFER) ? this->readFramebuffer : this->drawFramebuffer, framebuffer)) {
+			glBindFramebuffer(target, framebuffer);
+		}
+	}
+}
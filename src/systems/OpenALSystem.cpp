@@ -1,12 +1,15 @@
 #include "systems/OpenALSystem.h"
 
 #include "Sigma.h"
+#include "PropertyBindings.h"
 
 namespace Sigma {
 
 	// We need ctor and dstor to be exported to a dll even if they don't do anything
 	// this avoids needing to export getFactoryFunctions() which is only used by Sigma
-	OpenALSystem::OpenALSystem() : nextindex(1), device(nullptr), context(nullptr) { }
+	OpenALSystem::OpenALSystem() : nextindex(1), device(nullptr), context(nullptr), jobs(nullptr) {
+		this->RegisterBucket(&this->sounds);
+	}
 	OpenALSystem::~OpenALSystem() { }
 
 	bool OpenALSystem::Start() {
@@ -50,21 +53,29 @@ namespace Sigma {
 			return this->audioindex[name];
 		}
 	}
+	namespace {
+		bool ReadSoundFile(const std::string& filename, resource::SoundFile& sound) {
+			sound.LoadFromFile(filename);
+			return sound.isLoaded();
+		}
+	}
+
 	long OpenALSystem::LoadSoundFile(std::string filename) {
 		if (audioindex.find(filename) == audioindex.end()) {
-			std::shared_ptr<resource::SoundFile> sound;
-			long i = OpenALSystem::CreateSoundFile();
-			sound = this->audiofiles[i];
-			sound->LoadFromFile(filename);
-			if (sound->isLoaded()) {
+			// Read here unless PreloadALSource already read it
+			std::shared_ptr<resource::SoundFile> sound = this->preloadedfiles.Load(filename, ReadSoundFile);
+			this->preloadedfiles.Remove(filename);
+			if (sound) {
+				long i = nextindex++;
+				this->audiofiles[i] = sound;
 				this->audioindex[filename] = i;
 				return i;
 			} else {
 				LOG_WARN << "Failed to load sound from " << filename;
-				this->audiofiles.erase(i);
 				return 0;
 			}
 		} else {
+			this->preloadedfiles.Remove(filename); // in case a later preload read it again
 			return this->audioindex[filename];
 		}
 	}
@@ -89,66 +100,77 @@ namespace Sigma {
 		alListenerfv(AL_ORIENTATION, fo);
 	}
 
+	namespace {
+		struct ALSoundProperties {
+			ALSoundProperties(ALSound* sound) : sound(sound) { }
+			ALSound* sound;
+			PlacementProperties placement;
+			std::vector<std::string> soundFilenames;
+		};
+
+		PropertyBindings<ALSoundProperties> MakeALSoundBindings() {
+			PropertyBindings<ALSoundProperties> bindings;
+			BindPlacement(bindings, &ALSoundProperties::placement);
+			bindings.Bind("gain", [] (ALSoundProperties& t, const Property& p) { t.sound->Gain(p.Get<float>()); })
+				.Bind("rel", [] (ALSoundProperties& t, const Property& p) { t.sound->Relative(p.Get<bool>()); })
+				.Bind("rolloff", [] (ALSoundProperties& t, const Property& p) { t.sound->Rolloff(p.Get<float>()); })
+				.Bind("maxdist", [] (ALSoundProperties& t, const Property& p) { t.sound->MaxDistance(p.Get<float>()); })
+				.Bind("refdist", [] (ALSoundProperties& t, const Property& p) { t.sound->ReferenceDistance(p.Get<float>()); })
+				.Bind("loop", [] (ALSoundProperties& t, const Property&) { t.sound->PlayMode(ORDERING_NONE, PLAYBACK_LOOP); })
+				.Bind("soundFilename", [] (ALSoundProperties& t, const Property& p) { t.soundFilenames.push_back(p.Get<std::string>()); });
+			return bindings;
+		}
+
+		// What the preloader reads of an ALSound's properties
+		struct ALSoundPreloadProperties {
+			std::vector<std::string> soundFilenames;
+		};
+
+		PropertyBindings<ALSoundPreloadProperties> MakeALSoundPreloadBindings() {
+			PropertyBindings<ALSoundPreloadProperties> bindings;
+			bindings.Bind("soundFilename", [] (ALSoundPreloadProperties& t, const Property& p) { t.soundFilenames.push_back(p.Get<std::string>()); });
+			return bindings;
+		}
+	}
+
 	IComponent* OpenALSystem::CreateALSource(const id_t entityID, const std::vector<Property> &properties) {
+		static const PropertyBindings<ALSoundProperties> bindings = MakeALSoundBindings();
+
 		ALSound * sound = new ALSound(entityID, this);
 
 		sound->Generate();
 
-		std::string soundFilename;
-
-		long index;
-		float x, y, z;
-		bool loop = false;
-		x = y = z = 0.0f;
+		ALSoundProperties props(sound);
+		bindings.Apply(props, properties);
 
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &(*propitr);
-
-			if (p->GetName() == "x") {
-				x = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "y") {
-				y = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "z") {
-				z = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "gain") {
-				sound->Gain(p->Get<float>());
-			}
-			else if (p->GetName() == "rel") {
-				sound->Relative(p->Get<bool>());
-			}
-			else if (p->GetName() == "rolloff") {
-				sound->Rolloff(p->Get<float>());
-			}
-			else if (p->GetName() == "maxdist") {
-				sound->MaxDistance(p->Get<float>());
-			}
-			else if (p->GetName() == "refdist") {
-				sound->ReferenceDistance(p->Get<float>());
-			}
-			else if (p->GetName() == "loop") {
-				sound->PlayMode(ORDERING_NONE, PLAYBACK_LOOP);
-				continue;
-			}
-			else if (p->GetName() == "soundFilename") {
-				soundFilename = p->Get<std::string>();
-				index = LoadSoundFile(soundFilename);
-				sound->AddSound(index);
-				loop = false;
-				continue;
-			}
+		for (auto fitr = props.soundFilenames.begin(); fitr != props.soundFilenames.end(); ++fitr) {
+			sound->AddSound(LoadSoundFile(*fitr));
 		}
 
-		sound->Position(x,y,z);
+		sound->Position(props.placement.x, props.placement.y, props.placement.z);
 
 		this->addComponent(entityID, sound);
+		this->sounds.add(sound);
 		return sound;
 	}
+	void OpenALSystem::PreloadALSource(const std::vector<Property> &properties) {
+		static const PropertyBindings<ALSoundPreloadProperties> bindings = MakeALSoundPreloadBindings();
+
+		ALSoundPreloadProperties props;
+		bindings.Apply(props, properties);
+		for (auto fitr = props.soundFilenames.begin(); fitr != props.soundFilenames.end(); ++fitr) {
+			this->preloadedfiles.Load(*fitr, ReadSoundFile);
+		}
+	}
+	std::map<std::string, Sigma::IFactory::PreloadFunction>
+			OpenALSystem::getPreloadFunctions() {
+		using namespace std::placeholders;
+
+		std::map<std::string, Sigma::IFactory::PreloadFunction> retval;
+		retval["ALSound"] = std::bind(&OpenALSystem::PreloadALSource,this,_1);
+
+		return retval;
+	}
 	std::map<std::string, Sigma::IFactory::FactoryFunction>
 			OpenALSystem::getFactoryFunctions() {
 		using namespace std::placeholders;
@@ -160,23 +182,65 @@ namespace Sigma {
 	}
 
 	void OpenALSystem::StopAll() {
-		for (auto eitr = this->_Components.begin(); eitr != this->_Components.end(); ++eitr) {
-			for (auto citr = eitr->second.begin(); citr != eitr->second.end(); ++citr) {
-				ALSound *sound = dynamic_cast<ALSound *>(citr->second.get());
-				sound->Stop();
-			}
+		for (auto citr = this->sounds.begin(); citr != this->sounds.end(); ++citr) {
+			(*citr)->Stop();
 		}
 	}
+	SystemAccess OpenALSystem::DataAccess() {
+		// Only streams the sounds, the listener is moved by UpdateTransform
+		return SystemAccess().Writes(ALSound::getStaticComponentTypeID());
+	}
+
+	void OpenALSystem::Subscribe(EventBus& bus) {
+		bus.Subscribe<ListenerMovedEvent>([this] (const ListenerMovedEvent& e) {
+			UpdateTransform(e.position, e.forward, e.up);
+		});
+	}
+
 	bool OpenALSystem::Update() {
-		for (auto eitr = this->_Components.begin(); eitr != this->_Components.end(); ++eitr) {
-			for (auto citr = eitr->second.begin(); citr != eitr->second.end(); ++citr) {
-				ALSound *sound = dynamic_cast<ALSound *>(citr->second.get());
-				sound->Update();
+		UpdateScope scope(*this);
+		// The sounds share the sound files and their map, so those are looked up here, before
+		// the sounds update in parallel
+		for (auto citr = this->sounds.begin(); citr != this->sounds.end(); ++citr) {
+			(*citr)->Prepare();
+		}
+		if (this->jobs) {
+			// Each sound decodes into its own source, and OpenAL calls are thread safe
+			auto sound = this->sounds.begin();
+			JobSystem* jobs = this->jobs;
+			jobs->ParallelFor(0, this->sounds.size(), 1, [sound, jobs] (size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					sound[i]->Update(jobs->GetFrameAllocator());
+				}
+			});
+		}
+		else {
+			for (auto citr = this->sounds.begin(); citr != this->sounds.end(); ++citr) {
+				(*citr)->Update(this->scratch);
 			}
+			this->scratch.Reset();
 		}
 		return false;
 	}
+	void OpenALSystem::cleanupComponent(IComponent* component) {
+		// Only ALSounds are in sounds, so the downcast is safe
+		if (this->sounds.contains(component)) {
+			ALSound* sound = static_cast<ALSound*>(component);
+			sound->Stop();
+			alSourcei(sound->sourceid, AL_BUFFER, 0); // unqueue the buffers so they can be reused
+			for (int b = 0; b < sound->buffercount; ++b) {
+				this->freebuffers.push_back(sound->buffers[b]);
+			}
+			sound->buffercount = 0;
+			sound->Destroy();
+		}
+	}
 	int OpenALSystem::AllocateBuffer() {
+		if (!this->freebuffers.empty()) {
+			int x = this->freebuffers.back();
+			this->freebuffers.pop_back();
+			return x;
+		}
 		int x;
 		std::unique_ptr<resource::ALBuffer> testbuff(new resource::ALBuffer());
 		testbuff->GenerateBuffer();
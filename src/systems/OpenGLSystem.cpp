@@ -9,6 +9,11 @@
 #include "components/GLScreenQuad.h"
 #include "components/PointLight.h"
 #include "components/SpotLight.h"
+#include "PropertyBindings.h"
+#include "strutils.h"
+#include "TransformRegistry.h"
+#include "systems/GLState.h"
+#include "systems/GLUniform.h"
 
 #include "Sigma.h"
 
@@ -23,47 +28,64 @@ extern "C" const GLubyte * gluErrorString (GLenum error);
 #include "glm/glm.hpp"
 #include "glm/ext.hpp"
 
+#include <algorithm>
+
 namespace Sigma{
+	namespace {
+		// The uniforms the render passes set outside of the blocks in UniformBlocks.h
+		const GLUniform<GLfloat> ambLightIntensityUniform("ambLightIntensity");
+		const GLUniform<GLfloat> diffuseLightIntensityUniform("diffuseLightIntensity");
+		const GLUniform<GLfloat> specularLightIntensityUniform("specularLightIntensity");
+		const GLUniform<glm::vec4> ambientColorUniform("ambientColor");
+		const GLUniform<GLint> colorBufferUniform("colorBuffer");
+		const GLUniform<GLint> diffuseBufferUniform("diffuseBuffer");
+		const GLUniform<GLint> normalBufferUniform("normalBuffer");
+		const GLUniform<GLint> depthBufferUniform("depthBuffer");
+
+		// The [first, last) batches of the render queue's [first, last) positions, pass being a PassRange
+		std::pair<size_t, size_t> BatchRange(const std::vector<RenderQueue::Run>& batches, std::pair<size_t, size_t> pass) {
+			auto byBegin = [] (const RenderQueue::Run& run, size_t position) { return run.begin < position; };
+			auto first = std::lower_bound(batches.begin(), batches.end(), pass.first, byBegin);
+			auto last = std::lower_bound(first, batches.end(), pass.second, byBegin);
+			return std::make_pair(static_cast<size_t>(first - batches.begin()), static_cast<size_t>(last - batches.begin()));
+		}
+	}
+
 	// RenderTarget methods
 	RenderTarget::~RenderTarget() {
 		glDeleteTextures(this->texture_ids.size(), &this->texture_ids[0]); // Perhaps should check if texture was created for this RT or is used elsewhere
 		glDeleteRenderbuffers(1, &this->depth_id);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
 		glDeleteFramebuffers(1, &this->fbo_id);
+		GLState::Get().Invalidate();
 	}
 
+	// The draw buffers are part of the framebuffer, so they are set once, in initRenderTarget
 	void RenderTarget::BindWrite() {
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->fbo_id);
-
-		std::vector<GLenum> buffers;
-
-		for(unsigned int i=0; i < this->texture_ids.size(); i++) {
-			buffers.push_back(GL_COLOR_ATTACHMENT0 + i);
-		}
-
-		glDrawBuffers(this->texture_ids.size(), &buffers[0]);
+		GLState::Get().BindFramebuffer(GL_DRAW_FRAMEBUFFER, this->fbo_id);
 	}
 
 	void RenderTarget::BindRead() {
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, this->fbo_id);
+		GLState::Get().BindFramebuffer(GL_READ_FRAMEBUFFER, this->fbo_id);
 	}
 
 	void RenderTarget::UnbindWrite() {
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-
-		std::vector<GLenum> buffers;
-		buffers.push_back(GL_COLOR_ATTACHMENT0);
-		glDrawBuffers(1, &buffers[0]);
+		GLState::Get().BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 	}
 
 	void RenderTarget::UnbindRead() {
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+		GLState::Get().BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
 	}
 
 	std::map<std::string, Sigma::resource::GLTexture> OpenGLSystem::textures;
+	resource::ResourceCache<resource::ImageData> OpenGLSystem::images;
 
 	OpenGLSystem::OpenGLSystem() : windowWidth(1024), windowHeight(768), deltaAccumulator(0.0),
-		framerate(60.0f), pointQuad(1000), ambientQuad(1001), spotQuad(1002) {}
+		jobs(nullptr), pipelined(false), clock(nullptr), framerate(60.0f), pointQuad(1000), ambientQuad(1001), spotQuad(1002) {
+		this->RegisterBucket(&this->glComponents);
+		this->RegisterBucket(&this->pointLights);
+		this->RegisterBucket(&this->spotLights);
+	}
 
 
 	std::map<std::string, Sigma::IFactory::FactoryFunction> OpenGLSystem::getFactoryFunctions() {
@@ -83,42 +105,277 @@ namespace Sigma{
 		return retval;
 	}
 
-	IComponent* OpenGLSystem::createGLView(const id_t entityID, const std::vector<Property> &properties) {
-		this->views.push_back(new IGLView(entityID));
+	std::map<std::string, Sigma::IFactory::PreloadFunction> OpenGLSystem::getPreloadFunctions() {
+		using namespace std::placeholders;
 
-		float x=0.0f, y=0.0f, z=0.0f, rx=0.0f, ry=0.0f, rz=0.0f;
+		std::map<std::string, Sigma::IFactory::PreloadFunction> retval;
+		retval["GLMesh"] = std::bind(&OpenGLSystem::PreloadGLMesh,this,_1);
+		retval["GLSprite"] = std::bind(&OpenGLSystem::PreloadGLSprite,this,_1);
+		retval["GLScreenQuad"] = std::bind(&OpenGLSystem::PreloadScreenQuad,this,_1);
 
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &(*propitr);
+		return retval;
+	}
 
-			if (p->GetName() == "x") {
-				x = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "y") {
-				y = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "z") {
-				z = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "rx") {
-				rx = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "ry") {
-				ry = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "rz") {
-				rz = p->Get<float>();
-				continue;
+	namespace {
+		bool DecodeImage(const std::string& path, resource::ImageData& image) {
+			return image.LoadFromFile(path);
+		}
+	}
+
+	resource::GLTexture* OpenGLSystem::LoadTexture(const std::string& name, const std::string& path) {
+		if (path.empty()) {
+			auto found = textures.find(name);
+			return found != textures.end() ? &found->second : nullptr;
+		}
+
+		auto found = textures.find(name);
+		if (found != textures.end()) {
+			return &found->second;
+		}
+
+		// The image stays in the cache until ReleaseDecodedImages, so later preloads of the
+		// same file don't decode it again
+		std::shared_ptr<resource::ImageData> image = images.Load(path, DecodeImage);
+		if (!image) {
+			return nullptr;
+		}
+
+		resource::GLTexture texture;
+		texture.LoadDataFromImage(*image);
+		if (texture.GetID() == 0) {
+			return nullptr;
+		}
+		resource::GLTexture& loaded = textures[name];
+		loaded = texture;
+		return &loaded;
+	}
+
+	void OpenGLSystem::PreloadTexture(const std::string& path) {
+		images.Load(path, DecodeImage);
+	}
+
+	void OpenGLSystem::ReleaseDecodedImages() {
+		images.Clear();
+	}
+
+	namespace {
+		// Creation parameters of each component type, with their defaults, filled in by a PropertyBindings table.
+		// Properties that map straight onto the component are set through the component pointer.
+		struct GLViewProperties {
+			PlacementProperties placement;
+		};
+
+		PropertyBindings<GLViewProperties> MakeGLViewBindings() {
+			PropertyBindings<GLViewProperties> bindings;
+			BindPlacement(bindings, &GLViewProperties::placement);
+			return bindings;
+		}
+
+		struct GLSpriteProperties {
+			PlacementProperties placement;
+			std::string textureFilename;
+		};
+
+		PropertyBindings<GLSpriteProperties> MakeGLSpriteBindings() {
+			PropertyBindings<GLSpriteProperties> bindings;
+			BindPlacement(bindings, &GLSpriteProperties::placement);
+			bindings.Bind("textureFilename", &GLSpriteProperties::textureFilename);
+			return bindings;
+		}
+
+		struct GLIcoSphereProperties {
+			GLIcoSphereProperties(GLIcoSphere* sphere) : sphere(sphere), shader("shaders/icosphere") { }
+			GLIcoSphere* sphere;
+			PlacementProperties placement;
+			std::string shader;
+		};
+
+		PropertyBindings<GLIcoSphereProperties> MakeGLIcoSphereBindings() {
+			PropertyBindings<GLIcoSphereProperties> bindings;
+			BindPlacement(bindings, &GLIcoSphereProperties::placement);
+			bindings.Bind("shader", &GLIcoSphereProperties::shader)
+				.Bind("lightEnabled", [] (GLIcoSphereProperties& t, const Property& p) { t.sphere->SetLightingEnabled(p.Get<bool>()); });
+			return bindings;
+		}
+
+		struct GLCubeSphereProperties {
+			GLCubeSphereProperties(GLCubeSphere* sphere) : sphere(sphere), shader("shaders/cubesphere"), cullface("back"),
+				subdivisionLevels(1), fixToCamera(false) { }
+			GLCubeSphere* sphere;
+			PlacementProperties placement;
+			std::string texture;
+			std::string shader;
+			std::string cullface;
+			int subdivisionLevels;
+			bool fixToCamera;
+		};
+
+		PropertyBindings<GLCubeSphereProperties> MakeGLCubeSphereBindings() {
+			PropertyBindings<GLCubeSphereProperties> bindings;
+			BindPlacement(bindings, &GLCubeSphereProperties::placement);
+			bindings.Bind("subdivision_levels", &GLCubeSphereProperties::subdivisionLevels)
+				.Bind("texture", &GLCubeSphereProperties::texture)
+				.Bind("shader", &GLCubeSphereProperties::shader)
+				.Bind("cullface", &GLCubeSphereProperties::cullface)
+				.Bind("fix_to_camera", &GLCubeSphereProperties::fixToCamera)
+				.Bind("lightEnabled", [] (GLCubeSphereProperties& t, const Property& p) { t.sphere->SetLightingEnabled(p.Get<bool>()); });
+			return bindings;
+		}
+
+		struct GLMeshProperties {
+			GLMeshProperties(GLMesh* mesh) : mesh(mesh), cullface("back"), parent(0), hasParent(false) { }
+			GLMesh* mesh;
+			PlacementProperties placement;
+			std::string shader;
+			std::string cullface;
+			int parent;
+			bool hasParent;
+		};
+
+		PropertyBindings<GLMeshProperties> MakeGLMeshBindings() {
+			PropertyBindings<GLMeshProperties> bindings;
+			BindPlacement(bindings, &GLMeshProperties::placement);
+			bindings.Bind("shader", &GLMeshProperties::shader)
+				.Bind("cullface", &GLMeshProperties::cullface)
+				.Bind("meshFile", [] (GLMeshProperties& t, const Property& p) { t.mesh->LoadMesh(p.Get<std::string>()); })
+				.Bind("textureReplace", [] (GLMeshProperties& t, const Property& p) { t.mesh->texReplace = p.Get<std::string>(); })
+				.Bind("replaceWith", [] (GLMeshProperties& t, const Property& p) { t.mesh->texReplaceWith = p.Get<std::string>(); })
+				.Bind("parent", [] (GLMeshProperties& t, const Property& p) { t.parent = p.Get<int>(); t.hasParent = true; })
+				.Bind("lightEnabled", [] (GLMeshProperties& t, const Property& p) { t.mesh->SetLightingEnabled(p.Get<bool>()); });
+			return bindings;
+		}
+
+		// What the preloader reads of a GLMesh's properties
+		struct GLMeshPreloadProperties {
+			std::string meshFile;
+			std::string textureReplace;
+		};
+
+		PropertyBindings<GLMeshPreloadProperties> MakeGLMeshPreloadBindings() {
+			PropertyBindings<GLMeshPreloadProperties> bindings;
+			bindings.Bind("meshFile", &GLMeshPreloadProperties::meshFile)
+				.Bind("textureReplace", &GLMeshPreloadProperties::textureReplace);
+			return bindings;
+		}
+
+		struct GLScreenQuadProperties {
+			GLScreenQuadProperties() : x(0.0f), y(0.0f), w(0.0f), h(0.0f), textureInMemory(false) { }
+			float x, y, w, h;
+			std::string textureName;
+			bool textureInMemory;
+		};
+
+		PropertyBindings<GLScreenQuadProperties> MakeGLScreenQuadBindings() {
+			PropertyBindings<GLScreenQuadProperties> bindings;
+			bindings.Bind("left", &GLScreenQuadProperties::x)
+				.Bind("top", &GLScreenQuadProperties::y)
+				.Bind("width", &GLScreenQuadProperties::w)
+				.Bind("height", &GLScreenQuadProperties::h)
+				.Bind("textureName", [] (GLScreenQuadProperties& t, const Property& p) { t.textureName = p.Get<std::string>(); t.textureInMemory = true; })
+				.Bind("textureFileName", &GLScreenQuadProperties::textureName);
+			return bindings;
+		}
+
+		PropertyBindings<PointLight> MakePointLightBindings() {
+			PropertyBindings<PointLight> bindings;
+			bindings.Bind("x", [] (PointLight& t, const Property& p) { t.position.x = p.Get<float>(); })
+				.Bind("y", [] (PointLight& t, const Property& p) { t.position.y = p.Get<float>(); })
+				.Bind("z", [] (PointLight& t, const Property& p) { t.position.z = p.Get<float>(); })
+				.Bind("cr", [] (PointLight& t, const Property& p) { t.color.r = p.Get<float>(); })
+				.Bind("cg", [] (PointLight& t, const Property& p) { t.color.g = p.Get<float>(); })
+				.Bind("cb", [] (PointLight& t, const Property& p) { t.color.b = p.Get<float>(); })
+				.Bind("ca", [] (PointLight& t, const Property& p) { t.color.a = p.Get<float>(); })
+				.Bind("intensity", &PointLight::intensity)
+				.Bind("radius", &PointLight::radius)
+				.Bind("falloff", &PointLight::falloff);
+			return bindings;
+		}
+
+		struct SpotLightProperties {
+			SpotLightProperties(SpotLight* light) : light(light), parent(0), hasParent(false) { }
+			SpotLight* light;
+			PlacementProperties placement;
+			int parent;
+			bool hasParent;
+		};
+
+		PropertyBindings<SpotLightProperties> MakeSpotLightBindings() {
+			PropertyBindings<SpotLightProperties> bindings;
+			BindPlacement(bindings, &SpotLightProperties::placement);
+			bindings.Bind("intensity", [] (SpotLightProperties& t, const Property& p) { t.light->intensity = p.Get<float>(); })
+				.Bind("cr", [] (SpotLightProperties& t, const Property& p) { t.light->color.r = p.Get<float>(); })
+				.Bind("cg", [] (SpotLightProperties& t, const Property& p) { t.light->color.g = p.Get<float>(); })
+				.Bind("cb", [] (SpotLightProperties& t, const Property& p) { t.light->color.b = p.Get<float>(); })
+				.Bind("ca", [] (SpotLightProperties& t, const Property& p) { t.light->color.a = p.Get<float>(); })
+				.Bind("innerAngle", [] (SpotLightProperties& t, const Property& p) {
+					t.light->innerAngle = p.Get<float>();
+					t.light->cosInnerAngle = glm::cos(t.light->innerAngle);
+				})
+				.Bind("outerAngle", [] (SpotLightProperties& t, const Property& p) {
+					t.light->outerAngle = p.Get<float>();
+					t.light->cosOuterAngle = glm::cos(t.light->outerAngle);
+				})
+				.Bind("parent", [] (SpotLightProperties& t, const Property& p) { t.parent = p.Get<int>(); t.hasParent = true; });
+			return bindings;
+		}
+	}
+
+	void OpenGLSystem::PreloadGLMesh(const std::vector<Property> &properties) {
+		static const PropertyBindings<GLMeshPreloadProperties> bindings = MakeGLMeshPreloadBindings();
+
+		GLMeshPreloadProperties props;
+		bindings.Apply(props, properties);
+		if (props.meshFile.empty()) {
+			return;
+		}
+
+		std::shared_ptr<const MeshData> data = GLMesh::GetMeshData(props.meshFile);
+		if (!data) {
+			return;
+		}
+		for (auto titr = data->matTextures.begin(); titr != data->matTextures.end(); ++titr) {
+			const MaterialTexture* maps[] = { &titr->second.ambient, &titr->second.diffuse, &titr->second.normal };
+			for (int i = 0; i < 3; ++i) {
+				if (!maps[i]->file.empty() && maps[i]->file != props.textureReplace) {
+					std::string filename = maps[i]->file;
+					PreloadTexture(maps[i]->path + convert_path(filename));
+				}
 			}
 		}
+	}
+
+	void OpenGLSystem::PreloadGLSprite(const std::vector<Property> &properties) {
+		static const PropertyBindings<GLSpriteProperties> bindings = MakeGLSpriteBindings();
+
+		GLSpriteProperties props;
+		bindings.Apply(props, properties);
+		if (!props.textureFilename.empty()) {
+			PreloadTexture(props.textureFilename);
+		}
+	}
+
+	void OpenGLSystem::PreloadScreenQuad(const std::vector<Property> &properties) {
+		static const PropertyBindings<GLScreenQuadProperties> bindings = MakeGLScreenQuadBindings();
+
+		GLScreenQuadProperties props;
+		bindings.Apply(props, properties);
+		// A texture named by textureName is made in memory, not read from a file
+		if (!props.textureInMemory && !props.textureName.empty()) {
+			PreloadTexture(props.textureName);
+		}
+	}
+
+	IComponent* OpenGLSystem::createGLView(const id_t entityID, const std::vector<Property> &properties) {
+		static const PropertyBindings<GLViewProperties> bindings = MakeGLViewBindings();
+
+		this->views.push_back(new IGLView(entityID));
+
+		GLViewProperties props;
+		bindings.Apply(props, properties);
+		const PlacementProperties& place = props.placement;
 
-		this->views[this->views.size() - 1]->Transform()->TranslateTo(x,y,z);
-		this->views[this->views.size() - 1]->Transform()->Rotate(rx,ry,rz);
+		this->views[this->views.size() - 1]->Transform()->TranslateTo(place.x,place.y,place.z);
+		this->views[this->views.size() - 1]->Transform()->Rotate(place.rx,place.ry,place.rz);
 
 		this->addComponent(entityID, this->views[this->views.size() - 1]);
 
@@ -126,325 +383,132 @@ namespace Sigma{
 	}
 
 	IComponent* OpenGLSystem::createGLSprite(const id_t entityID, const std::vector<Property> &properties) {
+		static const PropertyBindings<GLSpriteProperties> bindings = MakeGLSpriteBindings();
+
 		GLSprite* spr = new GLSprite(entityID);
-		float scale = 1.0f;
-		float x = 0.0f;
-		float y = 0.0f;
-		float z = 0.0f;
-		int componentID = 0;
-		std::string textureFilename;
-
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &(*propitr);
-			if (p->GetName() == "scale") {
-				scale = p->Get<float>();
-			}
-			else if (p->GetName() == "x") {
-				x = p->Get<float>();
-			}
-			else if (p->GetName() == "y") {
-				y = p->Get<float>();
-			}
-			else if (p->GetName() == "z") {
-				z = p->Get<float>();
-			}
-			else if (p->GetName() == "id") {
-				componentID = p->Get<int>();
-			}
-			else if (p->GetName() == "textureFilename"){
-				textureFilename = p->Get<std::string>();
-			}
-		}
 
-		// Check if the texture is loaded and load it if not.
-		if (textures.find(textureFilename) == textures.end()) {
-			Sigma::resource::GLTexture texture;
-			texture.LoadDataFromFile(textureFilename);
-			if (texture.GetID() != 0) {
-				Sigma::OpenGLSystem::textures[textureFilename] = texture;
-			}
-		}
+		GLSpriteProperties props;
+		bindings.Apply(props, properties);
+		const PlacementProperties& place = props.placement;
+		const std::string& textureFilename = props.textureFilename;
 
-		// It should be loaded, but in case an error occurred double check for it.
-		if (textures.find(textureFilename) != textures.end()) {
-			spr->SetTexture(&Sigma::OpenGLSystem::textures[textureFilename]);
+		// Check if the texture is loaded and load it if not.
+		resource::GLTexture* texture = LoadTexture(textureFilename, textureFilename);
+		if (texture) {
+			spr->SetTexture(texture);
 		}
 		spr->LoadShader();
-		spr->Transform()->Scale(glm::vec3(scale));
-		spr->Transform()->Translate(x,y,z);
+		spr->Transform()->Scale(glm::vec3(place.scale));
+		spr->Transform()->Translate(place.x,place.y,place.z);
 		spr->InitializeBuffers();
 		this->addComponent(entityID,spr);
+		this->glComponents.add(spr);
+		TransformRegistry::Register(entityID, spr->Transform());
 		return spr;
 	}
 
 	IComponent* OpenGLSystem::createGLIcoSphere(const id_t entityID, const std::vector<Property> &properties) {
+		static const PropertyBindings<GLIcoSphereProperties> bindings = MakeGLIcoSphereBindings();
+
 		Sigma::GLIcoSphere* sphere = new Sigma::GLIcoSphere(entityID);
-		float scale = 1.0f;
-		float x = 0.0f;
-		float y = 0.0f;
-		float z = 0.0f;
-
-		int componentID = 0;
-		std::string shader_name = "shaders/icosphere";
-
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &(*propitr);
-			if (p->GetName() == "scale") {
-				scale = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "x") {
-				x = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "y") {
-				y = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "z") {
-				z = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "id") {
-				componentID = p->Get<int>();
-			}
-			else if (p->GetName() == "shader"){
-				shader_name = p->Get<std::string>();
-			}
-			else if (p->GetName() == "lightEnabled") {
-				sphere->SetLightingEnabled(p->Get<bool>());
-			}
-		}
-		sphere->Transform()->Scale(scale,scale,scale);
-		sphere->Transform()->Translate(x,y,z);
-		sphere->LoadShader(shader_name);
+
+		GLIcoSphereProperties props(sphere);
+		bindings.Apply(props, properties);
+		const PlacementProperties& place = props.placement;
+
+		sphere->Transform()->Scale(place.scale,place.scale,place.scale);
+		sphere->Transform()->Translate(place.x,place.y,place.z);
+		sphere->LoadShader(props.shader);
 		sphere->InitializeBuffers();
 		sphere->SetCullFace("back");
 		this->addComponent(entityID,sphere);
+		this->glComponents.add(sphere);
+		TransformRegistry::Register(entityID, sphere->Transform());
 		return sphere;
 	}
 
 	IComponent* OpenGLSystem::createGLCubeSphere(const id_t entityID, const std::vector<Property> &properties) {
-		Sigma::GLCubeSphere* sphere = new Sigma::GLCubeSphere(entityID);
+		static const PropertyBindings<GLCubeSphereProperties> bindings = MakeGLCubeSphereBindings();
 
-		std::string texture_name = "";
-		std::string shader_name = "shaders/cubesphere";
-		std::string cull_face = "back";
-		int subdivision_levels = 1;
-		float rotation_speed = 0.0f;
-		bool fix_to_camera = false;
-
-		float scale = 1.0f;
-		float x = 0.0f;
-		float y = 0.0f;
-		float z = 0.0f;
-		float rx = 0.0f;
-		float ry = 0.0f;
-		float rz = 0.0f;
-		int componentID = 0;
-
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &(*propitr);
-			if (p->GetName() == "scale") {
-				scale = p->Get<float>();
-			}
-			else if (p->GetName() == "x") {
-				x = p->Get<float>();
-			}
-			else if (p->GetName() == "y") {
-				y = p->Get<float>();
-			}
-			else if (p->GetName() == "z") {
-				z = p->Get<float>();
-			}
-			else if (p->GetName() == "rx") {
-				rx = p->Get<float>();
-			}
-			else if (p->GetName() == "ry") {
-				ry = p->Get<float>();
-			}
-			else if (p->GetName() == "rz") {
-				rz = p->Get<float>();
-			}
-			else if (p->GetName() == "subdivision_levels") {
-				subdivision_levels = p->Get<int>();
-			}
-			else if (p->GetName() == "texture") {
-				texture_name = p->Get<std::string>();
-			}
-			else if (p->GetName() == "shader") {
-				shader_name = p->Get<std::string>();
-			}
-			else if (p->GetName() == "id") {
-				componentID = p->Get<int>();
-			}
-			else if (p->GetName() == "cullface") {
-				cull_face = p->Get<std::string>();
-			}
-			else if (p->GetName() == "fix_to_camera") {
-				fix_to_camera = p->Get<bool>();
-			}
-			else if (p->GetName() == "lightEnabled") {
-				sphere->SetLightingEnabled(p->Get<bool>());
-			}
-		}
+		Sigma::GLCubeSphere* sphere = new Sigma::GLCubeSphere(entityID);
 
-		sphere->SetSubdivisions(subdivision_levels);
-		sphere->SetFixToCamera(fix_to_camera);
-		sphere->SetCullFace(cull_face);
-		sphere->Transform()->Scale(scale,scale,scale);
-		sphere->Transform()->Rotate(rx,ry,rz);
-		sphere->Transform()->Translate(x,y,z);
-		sphere->LoadShader(shader_name);
-		sphere->LoadTexture(texture_name);
+		GLCubeSphereProperties props(sphere);
+		bindings.Apply(props, properties);
+		const PlacementProperties& place = props.placement;
+
+		sphere->SetSubdivisions(props.subdivisionLevels);
+		sphere->SetFixToCamera(props.fixToCamera);
+		sphere->SetCullFace(props.cullface);
+		sphere->Transform()->Scale(place.scale,place.scale,place.scale);
+		sphere->Transform()->Rotate(place.rx,place.ry,place.rz);
+		sphere->Transform()->Translate(place.x,place.y,place.z);
+		sphere->LoadShader(props.shader);
+		sphere->LoadTexture(props.texture);
 		sphere->InitializeBuffers();
 
 		this->addComponent(entityID,sphere);
+		this->glComponents.add(sphere);
+		TransformRegistry::Register(entityID, sphere->Transform());
 		return sphere;
 	}
 
 	IComponent* OpenGLSystem::createGLMesh(const id_t entityID, const std::vector<Property> &properties) {
+		static const PropertyBindings<GLMeshProperties> bindings = MakeGLMeshBindings();
+
 		Sigma::GLMesh* mesh = new Sigma::GLMesh(entityID);
 
-		float scale = 1.0f;
-		float x = 0.0f;
-		float y = 0.0f;
-		float z = 0.0f;
-		float rx = 0.0f;
-		float ry = 0.0f;
-		float rz = 0.0f;
-		int componentID = 0;
-		std::string cull_face = "back";
-		std::string shaderfile = "";
-
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &*propitr;
-			if (p->GetName() == "scale") {
-				scale = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "x") {
-				x = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "y") {
-				y = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "z") {
-				z = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "rx") {
-				rx = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "ry") {
-				ry = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "rz") {
-				rz = p->Get<float>();
-				continue;
-			}
-			else if (p->GetName() == "meshFile") {
-				mesh->LoadMesh(p->Get<std::string>());
-			}
-			else if (p->GetName() == "shader") {
-				shaderfile = p->Get<std::string>();
-			}
-			else if (p->GetName() == "textureReplace") {
-				mesh->texReplace = p->Get<std::string>();
-			}
-			else if (p->GetName() == "replaceWith") {
-				mesh->texReplaceWith = p->Get<std::string>();
-			}
-			else if (p->GetName() == "id") {
-				componentID = p->Get<int>();
-			}
-			else if (p->GetName() == "parent") {
-				GLTransform *th, *pr;
-				int index = p->Get<int>();
-				th = mesh->Transform();
-				if(index == -1) {
-					pr = this->GetView()->Transform();
-				}
-				else {
-					pr = this->GetTransformFor(index);
-				}
-				if(th && pr) {
-					th->SetParentTransform(pr);
-				}
+		GLMeshProperties props(mesh);
+		bindings.Apply(props, properties);
+		const PlacementProperties& place = props.placement;
+
+		if (props.hasParent) {
+			GLTransform *th, *pr;
+			th = mesh->Transform();
+			if(props.parent == -1) {
+				pr = this->GetView()->Transform();
 			}
-			else if (p->GetName() == "cullface") {
-				cull_face = p->Get<std::string>();
+			else {
+				pr = this->GetTransformFor(props.parent);
 			}
-			else if (p->GetName() == "lightEnabled") {
-				mesh->SetLightingEnabled(p->Get<bool>());
+			if(th && pr) {
+				th->SetParentTransform(pr);
 			}
 		}
 
-		mesh->SetCullFace(cull_face);
-		mesh->Transform()->Scale(scale,scale,scale);
-		mesh->Transform()->Translate(x,y,z);
-		mesh->Transform()->Rotate(rx,ry,rz);
-		if(shaderfile != "") {
-			mesh->LoadShader(shaderfile);
+		mesh->SetCullFace(props.cullface);
+		mesh->Transform()->Scale(place.scale,place.scale,place.scale);
+		mesh->Transform()->Translate(place.x,place.y,place.z);
+		mesh->Transform()->Rotate(place.rx,place.ry,place.rz);
+		if(props.shader != "") {
+			mesh->LoadShader(props.shader);
 		}
 		else {
 			mesh->LoadShader(); // load default
 		}
 		mesh->InitializeBuffers();
 		this->addComponent(entityID,mesh);
+		this->glComponents.add(mesh);
+		TransformRegistry::Register(entityID, mesh->Transform());
 		return mesh;
 	}
 
 	IComponent* OpenGLSystem::createScreenQuad(const id_t entityID, const std::vector<Property> &properties) {
-		Sigma::GLScreenQuad* quad = new Sigma::GLScreenQuad(entityID);
-
-		float x = 0.0f;
-		float y = 0.0f;
-		float w = 0.0f;
-		float h = 0.0f;
+		static const PropertyBindings<GLScreenQuadProperties> bindings = MakeGLScreenQuadBindings();
 
-		int componentID = 0;
-		std::string textureName;
-		bool textureInMemory = false;
+		Sigma::GLScreenQuad* quad = new Sigma::GLScreenQuad(entityID);
 
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &(*propitr);
-			if (p->GetName() == "left") {
-				x = p->Get<float>();
-			}
-			else if (p->GetName() == "top") {
-				y = p->Get<float>();
-			}
-			else if (p->GetName() == "width") {
-				w = p->Get<float>();
-			}
-			else if (p->GetName() == "height") {
-				h = p->Get<float>();
-			}
-			else if (p->GetName() == "textureName") {
-				textureName = p->Get<std::string>();
-				textureInMemory = true;
-			}
-			else if (p->GetName() == "textureFileName") {
-				textureName = p->Get<std::string>();
-			}
-		}
+		GLScreenQuadProperties props;
+		bindings.Apply(props, properties);
+		const std::string& textureName = props.textureName;
 
 		// Check if the texture is loaded and load it if not.
 		if (textures.find(textureName) == textures.end()) {
 			Sigma::resource::GLTexture texture;
-			if (textureInMemory) { // We are using an in memory texture. It will be populated somewhere else
+			if (props.textureInMemory) { // We are using an in memory texture. It will be populated somewhere else
 				Sigma::OpenGLSystem::textures[textureName] = texture;
 			}
 			else { // The texture in on disk so load it.
-				texture.LoadDataFromFile(textureName);
-				if (texture.GetID() != 0) {
-					Sigma::OpenGLSystem::textures[textureName] = texture;
-				}
+				LoadTexture(textureName, textureName);
 			}
 		}
 
@@ -453,8 +517,8 @@ namespace Sigma{
 			quad->SetTexture(&Sigma::OpenGLSystem::textures[textureName]);
 		}
 
-		quad->SetPosition(x, y);
-		quad->SetSize(w, h);
+		quad->SetPosition(props.x, props.y);
+		quad->SetSize(props.w, props.h);
 		quad->LoadShader("shaders/quad");
 		quad->InitializeBuffers();
 		this->screensSpaceComp.push_back(std::unique_ptr<IGLComponent>(quad));
@@ -463,109 +527,40 @@ namespace Sigma{
 	}
 
 	IComponent* OpenGLSystem::createPointLight(const id_t entityID, const std::vector<Property> &properties) {
+		static const PropertyBindings<PointLight> bindings = MakePointLightBindings();
+
 		Sigma::PointLight *light = new Sigma::PointLight(entityID);
 
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &*propitr;
-			if (p->GetName() == "x") {
-				light->position.x = p->Get<float>();
-			}
-			else if (p->GetName() == "y") {
-				light->position.y = p->Get<float>();
-			}
-			else if (p->GetName() == "z") {
-				light->position.z = p->Get<float>();
-			}
-			else if (p->GetName() == "intensity") {
-				light->intensity = p->Get<float>();
-			}
-			else if (p->GetName() == "cr") {
-				light->color.r = p->Get<float>();
-			}
-			else if (p->GetName() == "cg") {
-				light->color.g = p->Get<float>();
-			}
-			else if (p->GetName() == "cb") {
-				light->color.b = p->Get<float>();
-			}
-			else if (p->GetName() == "ca") {
-				light->color.a = p->Get<float>();
-			}
-			else if (p->GetName() == "radius") {
-				light->radius = p->Get<float>();
-			}
-			else if (p->GetName() == "falloff") {
-				light->falloff = p->Get<float>();
-			}
-		}
+		bindings.Apply(*light, properties);
 
 		this->addComponent(entityID, light);
+		this->pointLights.add(light);
 		return light;
 	}
 
 	IComponent* OpenGLSystem::createSpotLight(const id_t entityID, const std::vector<Property> &properties) {
+		static const PropertyBindings<SpotLightProperties> bindings = MakeSpotLightBindings();
+
 		Sigma::SpotLight *light = new Sigma::SpotLight(entityID);
 
-		float x=0.0f, y=0.0f, z=0.0f;
-		float rx=0.0f, ry=0.0f, rz=0.0f;
+		SpotLightProperties props(light);
+		bindings.Apply(props, properties);
+		const PlacementProperties& place = props.placement;
 
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &*propitr;
-			if (p->GetName() == "x") {
-				x = p->Get<float>();
-			}
-			else if (p->GetName() == "y") {
-				y = p->Get<float>();
-			}
-			else if (p->GetName() == "z") {
-				z = p->Get<float>();
-			}
-			else if (p->GetName() == "rx") {
-				rx = p->Get<float>();
-			}
-			else if (p->GetName() == "ry") {
-				ry = p->Get<float>();
-			}
-			else if (p->GetName() == "rz") {
-				rz = p->Get<float>();
-			}
-			else if (p->GetName() == "intensity") {
-				light->intensity = p->Get<float>();
-			}
-			else if (p->GetName() == "cr") {
-				light->color.r = p->Get<float>();
-			}
-			else if (p->GetName() == "cg") {
-				light->color.g = p->Get<float>();
-			}
-			else if (p->GetName() == "cb") {
-				light->color.b = p->Get<float>();
-			}
-			else if (p->GetName() == "ca") {
-				light->color.a = p->Get<float>();
-			}
-			else if (p->GetName() == "innerAngle") {
-				light->innerAngle = p->Get<float>();
-				light->cosInnerAngle = glm::cos(light->innerAngle);
-			}
-			else if (p->GetName() == "outerAngle") {
-				light->outerAngle = p->Get<float>();
-				light->cosOuterAngle = glm::cos(light->outerAngle);
-			}
-			else if (p->GetName() == "parent") {
-				GLTransform *th, *pr;
-				th = &light->transform;
-				pr = this->GetTransformFor(p->Get<int>());
-				if(th && pr) {
-					th->SetParentTransform(pr);
-				}
+		if (props.hasParent) {
+			GLTransform *th, *pr;
+			th = &light->transform;
+			pr = this->GetTransformFor(props.parent);
+			if(th && pr) {
+				th->SetParentTransform(pr);
 			}
 		}
 
-		light->transform.TranslateTo(x, y, z);
-		light->transform.Rotate(rx, ry, rz);
+		light->transform.TranslateTo(place.x, place.y, place.z);
+		light->transform.Rotate(place.rx, place.ry, place.rz);
 
 		this->addComponent(entityID, light);
+		this->spotLights.add(light);
 
 		return light;
 	}
@@ -583,9 +578,10 @@ namespace Sigma{
 
 	void OpenGLSystem::initRenderTarget(unsigned int rtID) {
 		RenderTarget *rt = this->renderTargets[rtID].get();
+		GLState& state = GLState::Get();
 
 		// Make sure we're on the back buffer
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		state.BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 		// Get backbuffer depth bit width
 		int depthBits;
@@ -611,12 +607,19 @@ namespace Sigma{
 		glGenFramebuffers(1, &rt->fbo_id);
 		printOpenGLError();
 
-		glBindFramebuffer(GL_FRAMEBUFFER, rt->fbo_id);
+		state.BindFramebuffer(GL_FRAMEBUFFER, rt->fbo_id);
 
+		std::vector<GLenum> buffers;
 		for(unsigned int i=0; i < rt->texture_ids.size(); ++i) {
 			//Attach 2D texture to this FBO
 			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0+i, GL_TEXTURE_2D, rt->texture_ids[i], 0);
 			printOpenGLError();
+			buffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+		}
+
+		// Draw to every texture; the FBO keeps this, so binding it is enough from now on
+		if(!buffers.empty()) {
+			glDrawBuffers(buffers.size(), &buffers[0]);
 		}
 
 		if(rt->hasDepth) {
@@ -639,7 +642,7 @@ namespace Sigma{
 		}
 
 		// Unbind objects
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		state.BindFramebuffer(GL_FRAMEBUFFER, 0);
 	}
 
 	void OpenGLSystem::createRTBuffer(unsigned int rtID, GLint format, GLenum internalFormat, GLenum type) {
@@ -649,7 +652,7 @@ namespace Sigma{
 		GLuint texture_id;
 
 		glGenTextures(1, &texture_id);
-		glBindTexture(GL_TEXTURE_2D, texture_id);
+		GLState::Get().BindTexture(GL_TEXTURE_2D, texture_id);
 
 		// Texture params for full screen quad
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -667,38 +670,227 @@ namespace Sigma{
 		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0+rt->texture_ids.size(), GL_TEXTURE_2D, texture_id, 0);
 
 		this->renderTargets[rtID]->texture_ids.push_back(texture_id);
+	}
+
+	SystemAccess OpenGLSystem::DataAccess(bool pipelined) {
+		if (pipelined) {
+			// Only draws the published snapshot, which CaptureSnapshot never writes, through the
+			// components; of their state it only sets the model matrices to draw with
+			return SystemAccess().Reads(IGLComponent::getStaticComponentTypeID()).Writes("GLModelMatrix").Reads("GLTexture").OnMainThread();
+		}
+		// Takes its own snapshot first
+		return SnapshotAccess().Writes(IGLComponent::getStaticComponentTypeID()).Writes("GLModelMatrix").Reads("GLTexture").OnMainThread();
+	}
+
+	SystemAccess OpenGLSystem::SnapshotAccess() {
+		// Updating the cached matrices writes the transforms; the components' shaders,
+		// materials and vertex arrays sort the draws, and the view places the camera
+		return SystemAccess().Writes("GLTransform").Reads(IGLComponent::getStaticComponentTypeID())
+			.Reads(GLSixDOFView::getStaticComponentTypeID())
+			.Reads(PointLight::getStaticComponentTypeID()).Reads(SpotLight::getStaticComponentTypeID());
+	}
 
-		glBindTexture(GL_TEXTURE_2D, 0);
+	void RenderSnapshot::Remove(const ModelKey& key) {
+		for (auto mitr = this->models.begin(); mitr != this->models.end(); ++mitr) {
+			if (mitr->key == key) {
+				this->queue.Remove(static_cast<uint32_t>(mitr - this->models.begin()));
+				this->models.erase(mitr);
+				return;
+			}
+		}
+	}
+
+	void OpenGLSystem::Subscribe(EventBus& bus) {
+		bus.Subscribe<SpotLightSwitchEvent>([this] (const SpotLightSwitchEvent& e) {
+			SpotLight* light = static_cast<SpotLight*>(getComponent(e.entityID, SpotLight::getStaticComponentTypeID()));
+			if (light) {
+				light->enabled = e.enabled;
+			}
+			else {
+				LOG_WARN << "No spot light to switch on entity " << e.entityID;
+			}
+		});
+	}
+
+	void OpenGLSystem::CaptureSnapshot() {
+		RenderSnapshot& snapshot = this->snapshots.Pending();
+		const RenderSnapshot& last = this->snapshots.Published();
+
+		// If the simulation stepped since the last snapshot, its current states become the
+		// previous ones; otherwise the previous states stay and only the blend moves on.
+		// Without a clock the latest states are drawn as they are.
+		snapshot.step = this->clock ? this->clock->TotalSteps() : 0;
+		const bool stepped = !this->clock || snapshot.step != last.step;
+		const float alpha = this->clock ? this->clock->Alpha() : 1.0f;
+
+		// Bring every world matrix up to date in one batch, parents first, across the job
+		// system's threads; reading them below only returns the stored matrices.
+		TransformStore::Instance().Update(this->jobs);
+
+		// Setup the view matrix and position variables
+		snapshot.currentView = glm::mat4();
+		if (this->views.size() > 0) {
+			snapshot.currentView = this->views[this->views.size() - 1]->GetViewMatrix();
+		}
+		snapshot.previousView = stepped ? last.currentView : last.previousView;
+		snapshot.viewMatrix = InterpolateMatrix(snapshot.previousView, snapshot.currentView, alpha);
+		snapshot.viewPosition = glm::vec3(glm::inverse(snapshot.viewMatrix)[3]);
+
+		// Setup the projection matrix
+		glm::mat4 viewProj = this->ProjectionMatrix * snapshot.viewMatrix;
+		snapshot.viewProjInv = glm::inverse(viewProj);
+
+		// Calculate frustum for culling, without writing it to the view
+		Frustum frustum;
+		frustum.Extract(viewProj);
+
+		auto components = this->glComponents.begin();
+		snapshot.models.resize(this->glComponents.size());
+		for (size_t i = 0; i < snapshot.models.size(); ++i) {
+			snapshot.models[i].component = components[i];
+			snapshot.models[i].key = RenderSnapshot::ModelKey(components[i]->GetEntityID(), components[i]->getComponentTypeID());
+			snapshot.models[i].current = components[i]->Transform()->GetMatrix();
+		}
+
+		// Blend the models between their last two states. Components keep their order until
+		// some come or go, and the ones that moved in the order just aren't blended for a frame.
+		RenderSnapshot::Model* models = snapshot.models.data();
+		auto blendModels = [models, &last, stepped, alpha] (size_t begin, size_t end) {
+			BlendModels(models, begin, end, last.models, stepped, alpha, InterpolateMatrix);
+		};
+		if (this->jobs) {
+			this->jobs->ParallelFor(0, snapshot.models.size(), 64, blendModels);
+		}
+		else {
+			blendModels(0, snapshot.models.size());
+		}
+
+		// Queue the models, grouped by pass and state and then front to back
+		snapshot.queue.Clear();
+		for (size_t i = 0; i < snapshot.models.size(); ++i) {
+			IGLComponent* component = snapshot.models[i].component;
+			GLSLShader* shader = component->GetShader().get();
+			const glm::vec4 position = snapshot.viewMatrix * snapshot.models[i].matrix[3];
+			snapshot.queue.Submit(RenderQueue::MakeKey(
+				component->IsLightingEnabled() ? RenderSnapshot::PASS_GBUFFER : RenderSnapshot::PASS_UNLIT,
+				shader ? shader->GetProgram() : 0, component->MaterialKey(), component->Vao(), -position.z),
+				static_cast<uint32_t>(i));
+		}
+		snapshot.queue.Sort();
+
+		snapshot.pointLights.clear();
+		for (auto litr = this->pointLights.begin(); litr != this->pointLights.end(); ++litr) {
+			PointLight *light = *litr;
+			if (frustum.intersectsSphere(light->position, light->radius)) {
+				RenderSnapshot::PointLightState state = { light->position, light->radius, light->color };
+				snapshot.pointLights.push_back(state);
+			}
+		}
+
+		snapshot.spotLights.clear();
+		for (auto litr = this->spotLights.begin(); litr != this->spotLights.end(); ++litr) {
+			SpotLight *spotLight = *litr;
+			if (spotLight->IsEnabled()) {
+				RenderSnapshot::SpotLightState state = { spotLight->transform.ExtractPosition(), spotLight->transform.GetForward(),
+					spotLight->color, spotLight->cosInnerAngle, spotLight->cosOuterAngle };
+				snapshot.spotLights.push_back(state);
+			}
+		}
 	}
 
 	bool OpenGLSystem::Update(const double delta) {
+		UpdateScope scope(*this);
 		this->deltaAccumulator += delta;
 
 		// Check if the deltaAccumulator is greater than 1/<framerate>th of a second.
 		//  ..if so, it's time to render a new frame
-		if (this->deltaAccumulator > (1.0 / this->framerate)) {
+		if (this->framerate <= 0.0 || this->deltaAccumulator > (1.0 / this->framerate)) {
 
 			/////////////////////
 			// Rendering Setup //
 			/////////////////////
 
-			glm::vec3 viewPosition;
-			glm::mat4 viewProjInv;
-
-			// Setup the view matrix and position variables
-			glm::mat4 viewMatrix;
-			if (this->views.size() > 0) {
-				viewMatrix = this->views[this->views.size() - 1]->GetViewMatrix();
-				viewPosition = this->views[this->views.size() - 1]->Transform()->GetPosition();
+			// In pipelined mode the snapshot was captured and published by the caller
+			if (!this->pipelined) {
+				CaptureSnapshot();
+				PublishSnapshot();
+			}
+			const RenderSnapshot& snapshot = this->snapshots.Published();
+			// Components removed since the snapshot was taken are gone, skip their draws
+			const RenderQueue* renderQueue = &snapshot.queue;
+			if (this->snapshots.HasRemovals()) {
+				this->drawQueue.Clear();
+				const std::vector<RenderQueue::Item>& items = snapshot.queue.Items();
+				for (auto itr = items.begin(); itr != items.end(); ++itr) {
+					if (!this->snapshots.IsRemoved(snapshot.models[itr->index].key)) {
+						this->drawQueue.Submit(itr->key, itr->index);
+					}
+				}
+				renderQueue = &this->drawQueue;
+			}
+			const std::vector<RenderQueue::Item>& queue = renderQueue->Items();
+			glm::mat4 viewMatrix = snapshot.viewMatrix;
+
+			// Libraries may have changed the state between frames. The depth buffer is only
+			// cleared where depth can be written, which the last frame's overlays turned off.
+			GLState& state = GLState::Get();
+			state.Invalidate();
+			state.DepthMask(true);
+			const glm::vec3& viewPosition = snapshot.viewPosition;
+			const glm::mat4& viewProjInv = snapshot.viewProjInv;
+
+			// Upload the frame's uniform blocks at once: the camera, the lights, and the model
+			// matrices of each batch of draws. The draws and lights then only bind their block.
+			this->uniforms.Begin();
+			FrameBlock frame;
+			frame.view = viewMatrix;
+			frame.projection = this->ProjectionMatrix;
+			frame.viewProjInverse = viewProjInv;
+			frame.viewPosition = viewPosition;
+			frame.padding = 0.0f;
+			const size_t frameBlock = this->uniforms.Append(frame);
+
+			this->lightBlocks.clear();
+			for (auto litr = snapshot.pointLights.begin(); litr != snapshot.pointLights.end(); ++litr) {
+				LightBlock light = LightBlock();
+				light.color = litr->color;
+				light.position = litr->position;
+				light.radius = litr->radius;
+				this->lightBlocks.push_back(this->uniforms.Append(light));
+			}
+			for (auto litr = snapshot.spotLights.begin(); litr != snapshot.spotLights.end(); ++litr) {
+				LightBlock light = LightBlock();
+				light.color = litr->color;
+				light.position = litr->position;
+				light.direction = litr->direction;
+				light.cosInnerAngle = litr->cosInnerAngle;
+				light.cosOuterAngle = litr->cosOuterAngle;
+				this->lightBlocks.push_back(this->uniforms.Append(light));
+			}
+
+			// Draws next to each other in the queue that are instances of the first one's are
+			// batched, and drawn at once with the first one's component
+			renderQueue->Runs(MAX_INSTANCES, [&snapshot] (const RenderQueue::Item& first, const RenderQueue::Item& item) {
+				return snapshot.models[first.index].component->InstancesWith(*snapshot.models[item.index].component);
+			}, this->batches);
+			this->batchBlocks.resize(this->batches.size());
+			for (size_t b = 0; b < this->batches.size(); ++b) {
+				const RenderQueue::Run& batch = this->batches[b];
+				this->instances.resize(batch.count);
+				for (size_t i = 0; i < batch.count; ++i) {
+					const RenderSnapshot::Model& model = snapshot.models[queue[batch.begin + i].index];
+					model.component->SetModelMatrix(model.matrix);
+					this->instances[i].model = model.component->DrawMatrix(viewMatrix);
+				}
+				this->batchBlocks[b] = this->uniforms.Append(&this->instances[0], batch.count * sizeof(ObjectBlock));
+			}
+			// ObjectData is bound whole, as the shaders declare it, however many instances are drawn
+			if (!this->batchBlocks.empty()) {
+				this->uniforms.Pad(this->batchBlocks.back() + MAX_INSTANCES * sizeof(ObjectBlock));
 			}
 
-			// Setup the projection matrix
-			glm::mat4 viewProj = this->ProjectionMatrix * viewMatrix;
-
-			viewProjInv = glm::inverse(viewProj);
-
-			// Calculate frustum for culling
-			this->GetView(0)->CalculateFrustum(viewProj);
+			this->uniforms.Upload();
+			this->uniforms.Bind(FRAME_BLOCK, frameBlock, sizeof(FrameBlock));
 
 			// Clear the backbuffer and primary depth/stencil buffer
 			glClearColor(0.0f,0.0f,0.0f,1.0f);
@@ -714,31 +906,40 @@ namespace Sigma{
 				this->renderTargets[0]->BindWrite();
 			}
 
-			// Disable blending
-			glDisable(GL_BLEND);
+			// Disable blending, and test depth
+			state.Blend(false);
+			state.DepthTest(true);
+			state.DepthFunc(GL_LESS);
 
 			// Clear the GBuffer
 			glClearColor(0.0f,0.0f,0.0f,1.0f);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT); // Clear required buffers
 
-			// Loop through and draw each GL Component component.
-			for (auto eitr = this->_Components.begin(); eitr != this->_Components.end(); ++eitr) {
-				for (auto citr = eitr->second.begin(); citr != eitr->second.end(); ++citr) {
-					IGLComponent *glComp = dynamic_cast<IGLComponent *>(citr->second.get());
-
-					if(glComp && glComp->IsLightingEnabled()) {
-						glComp->GetShader()->Use();
-
-						// Set view position
-						//glUniform3f(glGetUniformBlockIndex(glComp->GetShader()->GetProgram(), "viewPosW"), viewPosition.x, viewPosition.y, viewPosition.z);
-
-						// For now, turn on ambient intensity and turn off lighting
-						glUniform1f(glGetUniformLocation(glComp->GetShader()->GetProgram(), "ambLightIntensity"), 0.05f);
-						glUniform1f(glGetUniformLocation(glComp->GetShader()->GetProgram(), "diffuseLightIntensity"), 0.0f);
-						glUniform1f(glGetUniformLocation(glComp->GetShader()->GetProgram(), "specularLightIntensity"), 0.0f);
+			// Draw each batch of lit GL components, in queue order. The pass's uniforms only need
+			// setting when the program changes.
+			std::pair<size_t, size_t> pass = BatchRange(this->batches, renderQueue->PassRange(RenderSnapshot::PASS_GBUFFER));
+			GLSLShader* lastShader = nullptr;
+			for (size_t b = pass.first; b < pass.second; ++b) {
+				const RenderQueue::Run& batch = this->batches[b];
+				IGLComponent *glComp = snapshot.models[queue[batch.begin].index].component;
+				GLSLShader* shader = glComp->GetShader().get();
+
+				this->uniforms.Bind(OBJECT_BLOCK, this->batchBlocks[b], MAX_INSTANCES * sizeof(ObjectBlock));
+				if (shader != lastShader) {
+					shader->Use();
+
+					// For now, turn on ambient intensity and turn off lighting
+					ambLightIntensityUniform.Set(*shader, 0.05f);
+					diffuseLightIntensityUniform.Set(*shader, 0.0f);
+					specularLightIntensityUniform.Set(*shader, 0.0f);
+					lastShader = shader;
+				}
 
-						glComp->Render(&viewMatrix[0][0], &this->ProjectionMatrix[0][0]);
-					}
+				if (batch.count > 1) {
+					glComp->RenderInstances(&viewMatrix[0][0], &this->ProjectionMatrix[0][0], batch.count);
+				}
+				else {
+					glComp->Render(&viewMatrix[0][0], &this->ProjectionMatrix[0][0]);
 				}
 			}
 
@@ -754,7 +955,7 @@ namespace Sigma{
 				this->renderTargets[0]->BindRead();
 			}
 
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 			glBlitFramebuffer(0, 0, this->windowWidth, this->windowHeight, 0, 0, this->windowWidth, this->windowHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 
 			if(this->renderTargets.size() > 0) {
@@ -766,8 +967,8 @@ namespace Sigma{
 			///////////////////
 
 			// Disable depth testing
-			glDepthFunc(GL_NONE);
-			glDepthMask(GL_FALSE);
+			state.DepthTest(false);
+			state.DepthMask(false);
 
 			// Bind the Geometry buffer for reading
 			if(this->renderTargets.size() > 0) {
@@ -777,7 +978,7 @@ namespace Sigma{
 			// Ambient light pass
 
 			// Ensure that blending is disabled
-			glDisable(GL_BLEND);
+			state.Blend(false);
 
 			// Currently simple constant ambient light, could use SSAO here
 			glm::vec4 ambientLight(0.1f, 0.1f, 0.1f, 1.0f);
@@ -786,95 +987,47 @@ namespace Sigma{
 			shader.Use();
 
 			// Load variables
-			glUniform4f(shader("ambientColor"), ambientLight.r, ambientLight.g, ambientLight.b, ambientLight.a);
-			glUniform1i(shader("colorBuffer"), 0);
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[0]);
+			ambientColorUniform.Set(shader, ambientLight);
+			state.BindTexture(0, GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[0]);
 
 			this->ambientQuad.Render(&viewMatrix[0][0], &this->ProjectionMatrix[0][0]);
 
-			shader.UnUse();
-
 			// Dynamic light passes
 			// Turn on additive blending
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_ONE, GL_ONE);
-
-			// Loop through each light, render a fullscreen quad if it is visible
-			for(auto eitr = this->_Components.begin(); eitr != this->_Components.end(); ++eitr) {
-				for (auto citr = eitr->second.begin(); citr != eitr->second.end(); ++citr) {
-					// Check if this component is a point light
-					PointLight *light = dynamic_cast<PointLight*>(citr->second.get());
-
-					// If it is a point light, and it intersects the frustum, then render
-					if(light && this->GetView(0)->CameraFrustum.intersectsSphere(light->position, light->radius) ) {
-
-						GLSLShader &shader = (*this->pointQuad.GetShader().get());
-						shader.Use();
-
-						// Load variables
-						glUniform3fv(shader("viewPosW"), 1, &viewPosition[0]);
-						glUniformMatrix4fv(shader("viewProjInverse"), 1, false, &viewProjInv[0][0]);
-						glUniform3fv(shader("lightPosW"), 1, &light->position[0]);
-						glUniform1f(shader("lightRadius"), light->radius);
-						glUniform4fv(shader("lightColor"), 1, &light->color[0]);
-
-						glUniform1i(shader("diffuseBuffer"), 0);
-						glUniform1i(shader("normalBuffer"), 1);
-						glUniform1i(shader("depthBuffer"), 2);
-
-						// Bind GBuffer textures
-						glActiveTexture(GL_TEXTURE0);
-						glBindTexture(GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[0]);
-						glActiveTexture(GL_TEXTURE1);
-						glBindTexture(GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[1]);
-						glActiveTexture(GL_TEXTURE2);
-						glBindTexture(GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[2]);
-
-						this->pointQuad.Render(&viewMatrix[0][0], &this->ProjectionMatrix[0][0]);
-
-						shader.UnUse();
-
-						continue;
-					}
+			state.Blend(true);
+			state.BlendFunc(GL_ONE, GL_ONE);
 
-					SpotLight *spotLight = dynamic_cast<SpotLight *>(citr->second.get());
+			// Loop through each point light in the frustum, render a fullscreen quad
+			std::vector<size_t>::const_iterator lightBlock = this->lightBlocks.begin();
+			for(auto litr = snapshot.pointLights.begin(); litr != snapshot.pointLights.end(); ++litr, ++lightBlock) {
+				GLSLShader &shader = (*this->pointQuad.GetShader().get());
+				shader.Use();
 
-					if(spotLight && spotLight->IsEnabled()) {
-						GLSLShader &shader = (*this->spotQuad.GetShader().get());
-						shader.Use();
+				// Load variables
+				this->uniforms.Bind(LIGHT_BLOCK, *lightBlock, sizeof(LightBlock));
 
-						glm::vec3 position = spotLight->transform.ExtractPosition();
-						glm::vec3 direction = spotLight->transform.GetForward();
+				// Bind GBuffer textures; after the first light they are still bound
+				state.BindTexture(0, GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[0]);
+				state.BindTexture(1, GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[1]);
+				state.BindTexture(2, GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[2]);
 
-						// Load variables
-						glUniform3fv(shader("viewPosW"), 1, &viewPosition[0]);
-						glUniformMatrix4fv(shader("viewProjInverse"), 1, false, &viewProjInv[0][0]);
-						glUniform3fv(shader("lightPosW"), 1, &position[0]);
-						glUniform3fv(shader("lightDirW"), 1, &direction[0]);
-						glUniform4fv(shader("lightColor"), 1, &spotLight->color[0]);
-						glUniform1f(shader("lightCosInnerAngle"), spotLight->cosInnerAngle);
-						glUniform1f(shader("lightCosOuterAngle"), spotLight->cosOuterAngle);
-
-						glUniform1i(shader("diffuseBuffer"), 0);
-						glUniform1i(shader("normalBuffer"), 1);
-						glUniform1i(shader("depthBuffer"), 2);
+				this->pointQuad.Render(&viewMatrix[0][0], &this->ProjectionMatrix[0][0]);
+			}
 
-						// Bind GBuffer textures
-						glActiveTexture(GL_TEXTURE0);
-						glBindTexture(GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[0]);
-						glActiveTexture(GL_TEXTURE1);
-						glBindTexture(GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[1]);
-						glActiveTexture(GL_TEXTURE2);
-						glBindTexture(GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[2]);
+			// Loop through each enabled spot light, render a fullscreen quad
+			for(auto litr = snapshot.spotLights.begin(); litr != snapshot.spotLights.end(); ++litr, ++lightBlock) {
+				GLSLShader &shader = (*this->spotQuad.GetShader().get());
+				shader.Use();
 
-						this->spotQuad.Render(&viewMatrix[0][0], &this->ProjectionMatrix[0][0]);
+				// Load variables
+				this->uniforms.Bind(LIGHT_BLOCK, *lightBlock, sizeof(LightBlock));
 
-						shader.UnUse();
+				// Bind GBuffer textures; after the first light they are still bound
+				state.BindTexture(0, GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[0]);
+				state.BindTexture(1, GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[1]);
+				state.BindTexture(2, GL_TEXTURE_2D, this->renderTargets[0]->texture_ids[2]);
 
-						continue;
-					}
-				}
+				this->spotQuad.Render(&viewMatrix[0][0], &this->ProjectionMatrix[0][0]);
 			}
 
 			// Unbind the Geometry buffer for reading
@@ -883,11 +1036,12 @@ namespace Sigma{
 			}
 
 			// Remove blending
-			glDisable(GL_BLEND);
+			state.Blend(false);
 
 			// Re-enabled depth test
-			glDepthFunc(GL_LESS);
-			glDepthMask(GL_TRUE);
+			state.DepthTest(true);
+			state.DepthFunc(GL_LESS);
+			state.DepthMask(true);
 
 			////////////////////
 			// Composite Pass //
@@ -899,19 +1053,25 @@ namespace Sigma{
 			// Draw Unlit Objects
 			///////////////////////
 
-			// Loop through and draw each GL Component component.
-			for (auto eitr = this->_Components.begin(); eitr != this->_Components.end(); ++eitr) {
-				for (auto citr = eitr->second.begin(); citr != eitr->second.end(); ++citr) {
-					IGLComponent *glComp = dynamic_cast<IGLComponent *>(citr->second.get());
-
-					if(glComp && !glComp->IsLightingEnabled()) {
-						glComp->GetShader()->Use();
-
-						// Set view position
-						glUniform3f(glGetUniformBlockIndex(glComp->GetShader()->GetProgram(), "viewPosW"), viewPosition.x, viewPosition.y, viewPosition.z);
+			// Draw each batch of unlit GL components, in queue order
+			pass = BatchRange(this->batches, renderQueue->PassRange(RenderSnapshot::PASS_UNLIT));
+			lastShader = nullptr;
+			for (size_t b = pass.first; b < pass.second; ++b) {
+				const RenderQueue::Run& batch = this->batches[b];
+				IGLComponent *glComp = snapshot.models[queue[batch.begin].index].component;
+				GLSLShader* shader = glComp->GetShader().get();
+
+				this->uniforms.Bind(OBJECT_BLOCK, this->batchBlocks[b], MAX_INSTANCES * sizeof(ObjectBlock));
+				if (shader != lastShader) {
+					shader->Use();
+					lastShader = shader;
+				}
 
-						glComp->Render(&viewMatrix[0][0], &this->ProjectionMatrix[0][0]);
-					}
+				if (batch.count > 1) {
+					glComp->RenderInstances(&viewMatrix[0][0], &this->ProjectionMatrix[0][0], batch.count);
+				}
+				else {
+					glComp->Render(&viewMatrix[0][0], &this->ProjectionMatrix[0][0]);
 				}
 			}
 
@@ -920,8 +1080,8 @@ namespace Sigma{
 			//////////////////
 
 			// Enable transparent rendering
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			state.Blend(true);
+			state.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 			for (auto citr = this->screensSpaceComp.begin(); citr != this->screensSpaceComp.end(); ++citr) {
 				citr->get()->GetShader()->Use();
@@ -929,10 +1089,10 @@ namespace Sigma{
 			}
 
 			// Remove blending
-			glDisable(GL_BLEND);
+			state.Blend(false);
 
 			// Unbind frame buffer
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			state.BindFramebuffer(GL_FRAMEBUFFER, 0);
 
 			this->deltaAccumulator = 0.0;
 			return true;
@@ -940,21 +1100,24 @@ namespace Sigma{
 		return false;
 	}
 
-	GLTransform *OpenGLSystem::GetTransformFor(const unsigned int entityID) {
-		auto entity = &(_Components[entityID]);
-
-		// for now, just returns the first component's transform
-		// bigger question: should entities be able to have multiple GLComponents?
-		for(auto compItr = entity->begin(); compItr != entity->end(); compItr++) {
-			IGLComponent *glComp = dynamic_cast<IGLComponent *>((*compItr).second.get());
-			if(glComp) {
-				GLTransform *transform = glComp->Transform();
-				return transform;
-			}
+	void OpenGLSystem::cleanupComponent(IComponent* component) {
+		// Only IGLComponents are in glComponents, so the downcast is safe
+		if (this->glComponents.contains(component)) {
+			static_cast<IGLComponent*>(component)->DeleteBuffers();
+			TransformRegistry::Unregister(component->GetEntityID(), static_cast<IGLComponent*>(component)->Transform());
+			// Snapshots may outlive the component by a frame. They may be in use, so the component
+			// is dropped from them when the next one is published, and skipped until then.
+			this->snapshots.Remove(RenderSnapshot::ModelKey(component->GetEntityID(), component->getComponentTypeID()));
 		}
+		auto view = std::find(this->views.begin(), this->views.end(), component);
+		if (view != this->views.end()) {
+			this->views.erase(view);
+		}
+	}
 
-		// no GL components
-		return 0;
+	GLTransform *OpenGLSystem::GetTransformFor(const unsigned int entityID) {
+		// The registry holds the transform of the first GL component created for the entity
+		return TransformRegistry::Get(entityID);
 	}
 
 	const int* OpenGLSystem::Start() {
@@ -993,9 +1156,8 @@ namespace Sigma{
 			glEnable(GL_MULTISAMPLE_ARB);
 		}
 #endif
-		glEnable(GL_CULL_FACE);
-		glCullFace(GL_BACK);
-		glEnable(GL_DEPTH_TEST);
+		GLState::Get().CullFace(GL_BACK);
+		GLState::Get().DepthTest(true);
 
 		// Setup a screen quad for deferred rendering
 		this->pointQuad.SetSize(1.0f, 1.0f);
@@ -1005,16 +1167,12 @@ namespace Sigma{
 		this->pointQuad.InitializeBuffers();
 		this->pointQuad.SetCullFace("none");
 
-		this->pointQuad.GetShader()->Use();
-		this->pointQuad.GetShader()->AddUniform("viewPosW");
-		this->pointQuad.GetShader()->AddUniform("viewProjInverse");
-		this->pointQuad.GetShader()->AddUniform("lightPosW");
-		this->pointQuad.GetShader()->AddUniform("lightRadius");
-		this->pointQuad.GetShader()->AddUniform("lightColor");
-		this->pointQuad.GetShader()->AddUniform("diffuseBuffer");
-		this->pointQuad.GetShader()->AddUniform("normalBuffer");
-		this->pointQuad.GetShader()->AddUniform("depthBuffer");
-		this->pointQuad.GetShader()->UnUse();
+		// The G-buffer samplers' units are part of the programs, so they are set once
+		GLSLShader& pointShader = *this->pointQuad.GetShader();
+		pointShader.Use();
+		diffuseBufferUniform.Set(pointShader, 0);
+		normalBufferUniform.Set(pointShader, 1);
+		depthBufferUniform.Set(pointShader, 2);
 
 		this->spotQuad.SetSize(1.0f, 1.0f);
 		this->spotQuad.SetPosition(0.0f, 0.0f);
@@ -1023,18 +1181,11 @@ namespace Sigma{
 		this->spotQuad.InitializeBuffers();
 		this->spotQuad.SetCullFace("none");
 
-		this->spotQuad.GetShader()->Use();
-		this->spotQuad.GetShader()->AddUniform("viewPosW");
-		this->spotQuad.GetShader()->AddUniform("viewProjInverse");
-		this->spotQuad.GetShader()->AddUniform("lightPosW");
-		this->spotQuad.GetShader()->AddUniform("lightDirW");
-		this->spotQuad.GetShader()->AddUniform("lightColor");
-		this->spotQuad.GetShader()->AddUniform("lightCosInnerAngle");
-		this->spotQuad.GetShader()->AddUniform("lightCosOuterAngle");
-		this->spotQuad.GetShader()->AddUniform("diffuseBuffer");
-		this->spotQuad.GetShader()->AddUniform("normalBuffer");
-		this->spotQuad.GetShader()->AddUniform("depthBuffer");
-		this->spotQuad.GetShader()->UnUse();
+		GLSLShader& spotShader = *this->spotQuad.GetShader();
+		spotShader.Use();
+		diffuseBufferUniform.Set(spotShader, 0);
+		normalBufferUniform.Set(spotShader, 1);
+		depthBufferUniform.Set(spotShader, 2);
 
 		this->ambientQuad.SetSize(1.0f, 1.0f);
 		this->ambientQuad.SetPosition(0.0f, 0.0f);
@@ -1043,10 +1194,9 @@ namespace Sigma{
 		this->ambientQuad.InitializeBuffers();
 		this->ambientQuad.SetCullFace("none");
 
-		this->ambientQuad.GetShader()->Use();
-		this->ambientQuad.GetShader()->AddUniform("ambientColor");
-		this->ambientQuad.GetShader()->AddUniform("colorBuffer");
-		this->ambientQuad.GetShader()->UnUse();
+		GLSLShader& ambientShader = *this->ambientQuad.GetShader();
+		ambientShader.Use();
+		colorBufferUniform.Set(ambientShader, 0);
 
 		return OpenGLVersion;
 	}
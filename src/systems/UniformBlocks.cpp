@@ -0,0 +1,90 @@
+#include "systems/UniformBlocks.h"
+#include "systems/GLState.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Sigma {
+	static_assert(sizeof(FrameBlock) == 208, "FrameBlock must match FrameData's std140 layout");
+	static_assert(sizeof(LightBlock) == 64, "LightBlock must match LightData's std140 layout");
+	static_assert(sizeof(ObjectBlock) == 64, "ObjectBlock must match ObjectData's std140 layout");
+	static_assert(sizeof(ObjectBlock) * MAX_INSTANCES <= 16384, "ObjectData must fit GL_MAX_UNIFORM_BLOCK_SIZE");
+
+	namespace {
+		struct BlockName {
+			const char* name;
+			UniformBlockBinding binding;
+		};
+		const BlockName BLOCKS[] = {
+			{ "FrameData", FRAME_BLOCK },
+			{ "LightData", LIGHT_BLOCK },
+			{ "ObjectData", OBJECT_BLOCK }
+		};
+
+		size_t AlignUp(size_t value, size_t alignment) {
+			return (value + alignment - 1) / alignment * alignment;
+		}
+	}
+
+	void BindUniformBlocks(GLuint program) {
+		for (size_t i = 0; i < sizeof(BLOCKS) / sizeof(BLOCKS[0]); ++i) {
+			GLuint index = glGetUniformBlockIndex(program, BLOCKS[i].name);
+			if (index != GL_INVALID_INDEX) {
+				glUniformBlockBinding(program, index, BLOCKS[i].binding);
+			}
+		}
+	}
+
+	UniformRing::UniformRing() : buffer(0), alignment(0), segmentSize(0), segment(0) { }
+
+	UniformRing::~UniformRing() {
+		if (this->buffer != 0) {
+			glDeleteBuffers(1, &this->buffer);
+			GLState::Get().Invalidate();
+		}
+	}
+
+	void UniformRing::Begin() {
+		if (this->alignment == 0) {
+			GLint required = 0;
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &required);
+			this->alignment = (required > 0) ? required : 256;
+		}
+		this->segment = (this->segment + 1) % SEGMENTS;
+		this->staging.clear();
+	}
+
+	size_t UniformRing::Append(const void* data, size_t size) {
+		size_t offset = AlignUp(this->staging.size(), this->alignment);
+		this->staging.resize(offset + size);
+		std::memcpy(&this->staging[offset], data, size);
+		return offset;
+	}
+
+	void UniformRing::Pad(size_t size) {
+		if (this->staging.size() < size) {
+			this->staging.resize(size);
+		}
+	}
+
+	void UniformRing::Upload() {
+		if (this->staging.empty()) {
+			return;
+		}
+		GLState& state = GLState::Get();
+		if (this->buffer == 0) {
+			glGenBuffers(1, &this->buffer);
+		}
+		state.BindBuffer(GL_UNIFORM_BUFFER, this->buffer);
+		if (this->staging.size() > this->segmentSize) {
+			// Reallocating drops the older frames' data, which the GPU keeps until it is done
+			this->segmentSize = AlignUp(std::max(this->staging.size(), 2 * this->segmentSize), this->alignment);
+			glBufferData(GL_UNIFORM_BUFFER, SEGMENTS * this->segmentSize, nullptr, GL_STREAM_DRAW);
+		}
+		glBufferSubData(GL_UNIFORM_BUFFER, this->segment * this->segmentSize, this->staging.size(), &this->staging[0]);
+	}
+
+	void UniformRing::Bind(UniformBlockBinding binding, size_t offset, size_t size) {
+		GLState::Get().BindBufferRange(GL_UNIFORM_BUFFER, binding, this->buffer, this->segment * this->segmentSize + offset, size);
+	}
+}
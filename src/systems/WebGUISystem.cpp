@@ -1,5 +1,6 @@
 #include "systems/WebGUISystem.h"
 #include "Property.h"
+#include "PropertyBindings.h"
 #include "components/WebGUIComponent.h"
 #include "systems/OpenGLSystem.h"
 
@@ -37,47 +38,51 @@ namespace Sigma {
 		return true;
 	}
 #endif
+	SystemAccess WebGUISystem::DataAccess() {
+		// Painting a view uploads its texture, so CEF's message loop needs the GL context
+		return SystemAccess().Writes(WebGUIView::getStaticComponentTypeID()).Writes("GLTexture").OnMainThread();
+	}
+
 	bool WebGUISystem::Update(const double delta) {
+		UpdateScope scope(*this); // CEF callbacks look up views while the loop runs
 #ifndef NO_CEF
 		CefDoMessageLoopWork();
 #endif
 		return true;
 	}
 
-	IComponent* WebGUISystem::createWebGUIView(const id_t entityID, const std::vector<Property> &properties) {
-		float x, y, width, height;
-		bool transparent = false;
-		std::string textureName = "";
-		std::string url;
-
-		for (auto propitr = properties.begin(); propitr != properties.end(); ++propitr) {
-			const Property*  p = &(*propitr);
-
-			if (p->GetName() == "left") {
-				x = p->Get<float>();
-			}
-			else if (p->GetName() == "top") {
-				y = p->Get<float>();
-			}
-			else if (p->GetName() == "width") {
-				width = p->Get<float>();
-			}
-			else if (p->GetName() == "height") {
-				height = p->Get<float>();
-			}
-			else if (p->GetName() == "textureName") {
-				textureName = p->Get<std::string>();
-			}
-			else if (p->GetName() == "transparent") {
-				transparent = p->Get<bool>();
-			}
-			else if (p->GetName() == "URL") {
-				url = p->Get<std::string>();
-			}
+	namespace {
+		struct WebGUIViewProperties {
+			WebGUIViewProperties() : x(0.0f), y(0.0f), width(0.0f), height(0.0f), transparent(false) { }
+			float x, y, width, height;
+			bool transparent;
+			std::string textureName;
+			std::string url;
+		};
+
+		PropertyBindings<WebGUIViewProperties> MakeWebGUIViewBindings() {
+			PropertyBindings<WebGUIViewProperties> bindings;
+			bindings.Bind("left", &WebGUIViewProperties::x)
+				.Bind("top", &WebGUIViewProperties::y)
+				.Bind("width", &WebGUIViewProperties::width)
+				.Bind("height", &WebGUIViewProperties::height)
+				.Bind("textureName", &WebGUIViewProperties::textureName)
+				.Bind("transparent", &WebGUIViewProperties::transparent)
+				.Bind("URL", &WebGUIViewProperties::url);
+			return bindings;
 		}
+	}
+
+	IComponent* WebGUISystem::createWebGUIView(const id_t entityID, const std::vector<Property> &properties) {
+		static const PropertyBindings<WebGUIViewProperties> bindings = MakeWebGUIViewBindings();
+
+		WebGUIViewProperties props;
+		bindings.Apply(props, properties);
+		const std::string& textureName = props.textureName;
+
 		WebGUIView* webview = new WebGUIView(entityID);
 #ifndef NO_CEF
-		CefString cefurl(url);
+		CefString cefurl(props.url);
 		CefURLParts parts;
 		if (!CefParseURL(cefurl, parts)) {
 			LOG_WARN << "Invalid URL";
@@ -89,7 +94,7 @@ namespace Sigma {
 		Sigma::OpenGLSystem::textures[textureName].Format(GL_BGRA);
 		Sigma::OpenGLSystem::textures[textureName].GenerateGLTexture(this->windowWidth, this->windowHeight);
 
-		webview->SetCaputeArea(x, y, width, height);
+		webview->SetCaputeArea(props.x, props.y, props.width, props.height);
 		webview->SetWindowSize(this->windowWidth, this->windowHeight);
 		webview->SetTexture(&Sigma::OpenGLSystem::textures[textureName]);
 		this->addComponent(entityID, webview);
@@ -97,11 +102,11 @@ namespace Sigma {
 #ifndef NO_CEF
 		CefWindowInfo windowInfo;
 		windowInfo.SetAsOffScreen(nullptr);
-		windowInfo.SetTransparentPainting(transparent);
+		windowInfo.SetTransparentPainting(props.transparent);
 
 		CefBrowserSettings settings;
 		CefRefPtr<Sigma::WebGUIView> client(webview);
-		CefBrowserHost::CreateBrowser(windowInfo, client.get(), url, settings, nullptr);
+		CefBrowserHost::CreateBrowser(windowInfo, client.get(), props.url, settings, nullptr);
 #endif
 		return webview;
 	}
@@ -1,6 +1,7 @@
 #include <iostream>
 
 #include "systems/OpenGLSystem.h"
+#include "systems/GLState.h"
 #include "systems/OpenALSystem.h"
 #include "systems/BulletPhysics.h"
 #include "systems/FactorySystem.h"
@@ -8,7 +9,14 @@
 #include "controllers/FPSCamera.h"
 #include "components/PhysicsController.h"
 #include "components/GLScreenQuad.h"
-#include "SCParser.h"
+#include "SceneLoader.h"
+#include "EntityManager.h"
+#include "JobSystem.h"
+#include "SystemScheduler.h"
+#include "FixedStepClock.h"
+#include "FramePacer.h"
+#include "EventBus.h"
+#include "TransformRegistry.h"
 #include "systems/WebGUISystem.h"
 #include "OS.h"
 #include "components/SpotLight.h"
@@ -50,6 +58,20 @@ int main(int argCount, char **argValues) {
 	factory.register_Factory(*app.get());
 #endif
 
+	// Worker threads the systems split their per-frame work across
+	Sigma::JobSystem jobs;
+	glsys.SetJobSystem(&jobs);
+	alsys.SetJobSystem(&jobs);
+	LOG << "Job system started with " << jobs.WorkerCount() << " workers.";
+
+	// Deleting an entity removes its components from these systems
+	Sigma::EntityManager::RegisterSystem(glsys);
+	Sigma::EntityManager::RegisterSystem(alsys);
+	Sigma::EntityManager::RegisterSystem(bphys);
+#ifndef NO_CEF
+	Sigma::EntityManager::RegisterSystem(*app.get());
+#endif
+
 	if (!glfwos.InitializeWindow(1024, 768, "Sigma test")) {
 		LOG_ERROR << "Failed creating the window or context.";
 		return -1;
@@ -109,37 +131,38 @@ int main(int argCount, char **argValues) {
 	// Load scene //
 	////////////////
 
-	// Parse the scene file to retrieve entities
-	Sigma::parser::SCParser parser;
-
-	LOG << "Parsing test.sc scene file.";
-	if (!parser.Parse("test.sc")) {
-		LOG_ERROR << "Failed to load entities from file.";
-		exit (-1);
-	}
-
-	LOG << "Generating Entities.";
-
-	// Create each entity's components
-	for (unsigned int i = 0; i < parser.EntityCount(); ++i) {
-		Sigma::parser::Entity* e = parser.GetEntity(i);
-		for (auto itr = e->components.begin(); itr != e->components.end(); ++itr) {
-
-			// Currently, physicsmover components must come after gl* components
-			if((*itr).type == "PhysicsMover") {
-				Sigma::GLTransform *transform = glsys.GetTransformFor(e->id);
-				if(transform) {
-					Property p("transform", transform);
-					itr->properties.push_back(p);
-				}
-				else {
-					assert(0 && "Invalid entity id");
-				}
+	// Load the scene file. Resources are read and decoded on worker threads while the
+	// components are created here, where the OpenGL and OpenAL contexts live.
+	Sigma::SceneLoader loader(factory);
+
+	LOG << "Loading test.sc scene file.";
+	size_t lastPercent = 0;
+	bool parsed = loader.Load("test.sc", [&] (Sigma::parser::Entity& e, Sigma::parser::Component& c) {
+		// Currently, physicsmover components must come after gl* components
+		if(c.type == "PhysicsMover") {
+			Sigma::GLTransform *transform = Sigma::TransformRegistry::Get(e.id);
+			if(transform) {
+				c.properties.push_back(Property("transform", transform));
 			}
+			else {
+				assert(0 && "Invalid entity id");
+			}
+		}
 
-			factory.create(itr->type,e->id, const_cast<std::vector<Property>&>(itr->properties));
+		Sigma::EntityManager::CreateEntity(e.id);
+		Sigma::EntityManager::AddComponent(e.id, c.type, c.properties);
+	}, [&lastPercent] (size_t created, size_t total) {
+		size_t percent = created * 100 / total;
+		if (percent / 10 != lastPercent / 10 || created == total) {
+			LOG << "Loaded " << created << " of " << total << " components (" << percent << "%).";
 		}
+		lastPercent = percent;
+	});
+	if (!parsed) {
+		LOG_ERROR << "Failed to load entities from file.";
+		exit (-1);
 	}
+	Sigma::OpenGLSystem::ReleaseDecodedImages();
 
 	//////////////////////
 	// Setup user input //
@@ -184,7 +207,7 @@ int main(int argCount, char **argValues) {
 	///////////////////
 #ifndef NO_CEF
 	Sigma::event::handler::GUIController guicon;
-	guicon.SetGUI(app->getComponent(100, Sigma::WebGUIView::getStaticComponentTypeName()));
+	guicon.SetGUI(app->getComponent(100, Sigma::WebGUIView::getStaticComponentTypeID()));
 	glfwos.RegisterKeyboardEventHandler(&guicon);
 	glfwos.RegisterMouseEventHandler(&guicon);
 #endif
@@ -195,21 +218,21 @@ int main(int argCount, char **argValues) {
 	Sigma::ALSound *als;
 	bool soundflag = false, soundrunning = false;
 	{
-		als = (Sigma::ALSound *)alsys.getComponent(200, Sigma::ALSound::getStaticComponentTypeName());
+		als = (Sigma::ALSound *)alsys.getComponent(200, Sigma::ALSound::getStaticComponentTypeID());
 		if(als) {
 			als->Play(Sigma::PLAYBACK_LOOP);
 		}
-		als = (Sigma::ALSound *)alsys.getComponent(201, Sigma::ALSound::getStaticComponentTypeName());
+		als = (Sigma::ALSound *)alsys.getComponent(201, Sigma::ALSound::getStaticComponentTypeID());
 		if(als) {
 			als->Play(Sigma::PLAYBACK_LOOP);
 		}
-		als = (Sigma::ALSound *)alsys.getComponent(202, Sigma::ALSound::getStaticComponentTypeName());
+		als = (Sigma::ALSound *)alsys.getComponent(202, Sigma::ALSound::getStaticComponentTypeID());
 		if(als) {
 			als->Play(Sigma::PLAYBACK_LOOP);
 		}
 
 		// This one must be last
-		als = (Sigma::ALSound *)alsys.getComponent(203, Sigma::ALSound::getStaticComponentTypeName());
+		als = (Sigma::ALSound *)alsys.getComponent(203, Sigma::ALSound::getStaticComponentTypeID());
 	}
 
 	enum FlashlightState {
@@ -221,11 +244,61 @@ int main(int argCount, char **argValues) {
 
 	FlashlightState fs = FL_OFF;
 
+	///////////////////////
+	// Schedule systems  //
+	///////////////////////
+
+	// Systems run in this order where the data they use overlaps, concurrently otherwise.
+	// Rendering is pipelined: it draws the snapshot of the last frame while physics moves
+	// the transforms for this one, and the snapshot is taken once physics is done.
+	glsys.SetPipelined(true);
+	// Physics steps at a fixed rate, and rendering blends between the last two steps
+	Sigma::FixedStepClock clock(60.0, 5);
+	glsys.SetClock(&clock);
+	// Systems and input talk through events, handled between frames
+	Sigma::EventBus events;
+	glsys.Subscribe(events);
+	alsys.Subscribe(events);
+
+	Sigma::SystemScheduler scheduler(jobs);
+	scheduler.Add("physics", Sigma::BulletPhysics::DataAccess(), [&bphys, &clock, &glsys, &events] (double) {
+		for (unsigned int s = 0; s < clock.Steps(); ++s) {
+			bphys.Update(clock.StepTime());
+		}
+		// The listener follows the view the physics mover controls
+		Sigma::GLTransform* view = glsys.GetView()->Transform();
+		Sigma::ListenerMovedEvent listener = { view->GetPosition(), view->GetForward(), view->GetUp() };
+		events.Publish(listener);
+	});
+#ifndef NO_CEF
+	scheduler.Add("webgui", Sigma::WebGUISystem::DataAccess(), [&app] (double delta) { app->Update(delta); });
+#endif
+	scheduler.Add("audio", Sigma::OpenALSystem::DataAccess(), [&alsys] (double) { alsys.Update(); });
+	scheduler.Add("snapshot", Sigma::OpenGLSystem::SnapshotAccess(), [&glsys] (double) { glsys.CaptureSnapshot(); });
+	scheduler.Add("render", Sigma::OpenGLSystem::DataAccess(true), [&glsys, &glfwos] (double delta) {
+		// Update the renderer and present
+		if (glsys.Update(delta)) {
+			glfwos.SwapBuffers();
+		}
+	});
+	// Sleep between frames instead of spinning, handling input as it comes in. The pacer
+	// holds the frame rate, so the renderer draws every frame.
+	Sigma::FramePacer pacer(60.0);
+	pacer.SetWaitFunction([&glfwos] (double seconds) { glfwos.WaitEvents(seconds); });
+	glsys.SetFrameRate(0.0);
+	unsigned int frames = 0;
+	double frameTime = 0.0, serialTime = 0.0;
+
 	LOG << "Main loop begins ";
 	while (!glfwos.Closing()) {
+		pacer.Wait();
+
 		// Get time in ms, store it in seconds too
 		double deltaSec = glfwos.GetDeltaTime();
 
+		// Release last frame's scratch memory
+		jobs.NewFrame();
+
 		if(!(glfwos.HasKeyboardFocusLock())) {
 			// Process input
 			if(glfwos.CheckKeyState(Sigma::event::KS_DOWN, GLFW_KEY_F)) {
@@ -239,15 +312,15 @@ int main(int argCount, char **argValues) {
 			if(glfwos.CheckKeyState(Sigma::event::KS_UP, GLFW_KEY_F)) {
 				if(fs==FL_TURNING_ON) {
 					// Enable flashlight
-					Sigma::SpotLight *spotlight = static_cast<Sigma::SpotLight *>(glsys.getComponent(151, Sigma::SpotLight::getStaticComponentTypeName()));
-					spotlight->enabled = true;
+					Sigma::SpotLightSwitchEvent on = { 151, true };
+					events.Publish(on);
 					// Rotate flashlight up
 					// Enable spotlight
 					fs=FL_ON;
 				} else if (fs==FL_TURNING_OFF) {
 					// Disable spotlight
-					Sigma::SpotLight *spotlight = static_cast<Sigma::SpotLight *>(glsys.getComponent(151, Sigma::SpotLight::getStaticComponentTypeName()));
-					spotlight->enabled = false;
+					Sigma::SpotLightSwitchEvent off = { 151, false };
+					events.Publish(off);
 					// Rotate flashlight down
 					// Disable flashlight
 					fs=FL_OFF;
@@ -283,19 +356,29 @@ int main(int argCount, char **argValues) {
 		// Update subsystems //
 		///////////////////////
 
-		// Pass in delta time in seconds
-		bphys.Update(deltaSec);
-#ifndef NO_CEF
-		app->Update(deltaSec);
-#endif
-
-
-		// Update the renderer and present
-		if (glsys.Update(deltaSec)) {
-			glfwos.SwapBuffers();
-
-			alsys.Update();
-			alsys.UpdateTransform(*glsys.GetView()->Transform());
+		// Pass in delta time in seconds. Physics, audio and the snapshot run on workers
+		// while CEF and rendering run here.
+		clock.Advance(deltaSec);
+		scheduler.Update(deltaSec);
+		glsys.PublishSnapshot();
+		// Between frames no system runs, so the events can change any of them
+		events.Dispatch();
+
+		frameTime += scheduler.FrameTime();
+		for (auto titr = scheduler.Timings().begin(); titr != scheduler.Timings().end(); ++titr) {
+			serialTime += titr->seconds;
+		}
+		if (++frames == 1000) {
+			LOG_DEBUG << "System updates took " << 1000.0 * frameTime / frames << "ms per frame, "
+				<< 1000.0 * serialTime / frames << "ms one after another; idle "
+				<< static_cast<int>(100.0 * pacer.IdleFraction()) << "% of the time";
+			Sigma::GLState& state = Sigma::GLState::Get();
+			LOG_DEBUG << "GL state calls: " << state.Issued() / frames << " issued and "
+				<< state.Avoided() / frames << " avoided per frame";
+			state.ResetCounters();
+			frames = 0;
+			frameTime = serialTime = 0.0;
+			pacer.ResetStats();
 		}
 
 		glfwos.OSMessageLoop();
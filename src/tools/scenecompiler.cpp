@@ -0,0 +1,17 @@
+// Compiles an SC scene into a binary SCB scene that SCParser can load straight from a mapping.
+// Usage: scenecompiler <in.sc> <out.scb>
+#include <iostream>
+#include "SCBWriter.h"
+
+int main(int argCount, char **argValues) {
+	if (argCount != 3) {
+		std::cerr << "Usage: " << argValues[0] << " <in.sc> <out.scb>" << std::endl;
+		return 1;
+	}
+
+	if (!Sigma::parser::SCBWriter::Compile(argValues[1], argValues[2])) {
+		std::cerr << "Failed to compile " << argValues[1] << std::endl;
+		return 1;
+	}
+	return 0;
+}
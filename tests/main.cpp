@@ -1,10 +1,27 @@
 #include "gtest/gtest.h"
 #include "tests/EntityManagerTest.h"
 #include "tests/PropertyTest.h"
+#include "tests/ComponentStoreTest.h"
+#include "tests/ComponentPoolTest.h"
+#include "tests/PropertyBindingsTest.h"
+#include "tests/SCParserTest.h"
+#include "tests/SceneLoaderTest.h"
+#include "tests/JobSystemTest.h"
+#include "tests/SystemSchedulerTest.h"
+#include "tests/FixedStepClockTest.h"
+#include "tests/FramePacerTest.h"
+#include "tests/TransformHierarchyTest.h"
+#include "tests/TransformStoreTest.h"
+#include "tests/TransformRegistryTest.h"
+#include "tests/EventBusTest.h"
+#include "tests/RenderQueueTest.h"
+#include "tests/SnapshotPairTest.h"
 
 int main(int argc, char **argv) {
 	::testing::InitGoogleTest(&argc, argv);
 	int ret = RUN_ALL_TESTS();
+#ifdef _WIN32
 	system("Pause");
+#endif
 	return ret;
 }
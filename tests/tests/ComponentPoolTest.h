@@ -0,0 +1,63 @@
+#pragma once
+
+#include "IComponent.h"
+#include "ComponentPool.h"
+
+namespace {
+	class PoolTestComponent : public Sigma::IComponent {
+	public:
+		SET_COMPONENT_TYPENAME("PoolTestComponent");
+		PoolTestComponent(const Sigma::id_t id) : IComponent(id), value(0) {}
+		double value;
+	};
+
+	// test that components of one type are allocated next to each other
+	TEST(ComponentPoolTest, ComponentPoolAdjacent) {
+		PoolTestComponent* first = new PoolTestComponent(1);
+		PoolTestComponent* second = new PoolTestComponent(2);
+		Sigma::ComponentPool& pool = Sigma::ComponentPool::Get(PoolTestComponent::getStaticComponentTypeID(), sizeof(PoolTestComponent));
+		EXPECT_EQ(2u, pool.LiveCount());
+		EXPECT_EQ(pool.BlockSize(), static_cast<size_t>(reinterpret_cast<char*>(second) - reinterpret_cast<char*>(first)));
+		delete first;
+		delete second;
+	}
+
+	// test that freed blocks are reused and that the slabs but the first go away with the last component
+	TEST(ComponentPoolTest, ComponentPoolBulkRelease) {
+		Sigma::ComponentPool& pool = Sigma::ComponentPool::Get(PoolTestComponent::getStaticComponentTypeID(), sizeof(PoolTestComponent));
+		std::vector<PoolTestComponent*> components;
+		for (Sigma::id_t i = 0; i < 1000; ++i) {
+			components.push_back(new PoolTestComponent(i));
+		}
+		EXPECT_EQ(1000u, pool.LiveCount());
+		PoolTestComponent* reused = components.back();
+		delete components.back();
+		components.pop_back();
+		components.push_back(new PoolTestComponent(999));
+		EXPECT_EQ(reused, components.back());
+		for (auto itr = components.begin(); itr != components.end(); ++itr) {
+			delete *itr;
+		}
+		EXPECT_EQ(0u, pool.LiveCount());
+		EXPECT_EQ(1u, pool.SlabCount());
+		PoolTestComponent* first = new PoolTestComponent(1);
+		PoolTestComponent* second = new PoolTestComponent(2);
+		EXPECT_EQ(pool.BlockSize(), static_cast<size_t>(reinterpret_cast<char*>(second) - reinterpret_cast<char*>(first)));
+		delete first;
+		delete second;
+	}
+
+	// test that a component created and destroyed over and over keeps reusing one block
+	TEST(ComponentPoolTest, ComponentPoolChurn) {
+		Sigma::ComponentPool& pool = Sigma::ComponentPool::Get(PoolTestComponent::getStaticComponentTypeID(), sizeof(PoolTestComponent));
+		PoolTestComponent* first = new PoolTestComponent(1);
+		delete first;
+		for (int i = 0; i < 100; ++i) {
+			PoolTestComponent* component = new PoolTestComponent(1);
+			EXPECT_EQ(first, component);
+			delete component;
+		}
+		EXPECT_EQ(0u, pool.LiveCount());
+		EXPECT_EQ(1u, pool.SlabCount());
+	}
+}  // namespace
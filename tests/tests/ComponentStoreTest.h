@@ -0,0 +1,229 @@
+#pragma once
+
+#include "ISystem.h"
+
+namespace {
+	class StoreTestComponent : public Sigma::IComponent {
+	public:
+		SET_COMPONENT_TYPENAME("StoreTestComponent");
+		StoreTestComponent(const Sigma::id_t id) : IComponent(id) {}
+	};
+
+	// test lookup of present and missing entities
+	TEST(ComponentStoreTest, ComponentStoreInsertGet) {
+		Sigma::ComponentStore<Sigma::IComponent> store;
+		StoreTestComponent* c = new StoreTestComponent(5);
+		EXPECT_EQ(c, store.insert(5, std::unique_ptr<Sigma::IComponent>(c)));
+		EXPECT_EQ(c, store.get(5));
+		EXPECT_EQ(nullptr, store.get(6)) << "Entity 6 has no component";
+		EXPECT_EQ(nullptr, store.get(5000000)) << "Entity past the paged range has no component";
+		ASSERT_EQ(1u, store.size());
+		EXPECT_EQ(5u, store.entityAt(0));
+	}
+
+	// test that components are packed and pointers stay valid while the store grows
+	TEST(ComponentStoreTest, ComponentStoreDenseIteration) {
+		Sigma::ComponentStore<Sigma::IComponent> store;
+		Sigma::IComponent* first = store.insert(3000000000u, std::unique_ptr<Sigma::IComponent>(new StoreTestComponent(0)));
+		for (Sigma::id_t i = 1; i < 2000; ++i) {
+			store.insert(i * 7, std::unique_ptr<Sigma::IComponent>(new StoreTestComponent(i * 7)));
+		}
+		EXPECT_EQ(first, store.get(3000000000u));
+		EXPECT_EQ(2000u, store.size());
+		size_t count = 0;
+		for (auto itr = store.begin(); itr != store.end(); ++itr) {
+			++count;
+		}
+		EXPECT_EQ(2000u, count);
+	}
+
+	// test that adding a second component of a type replaces the first
+	TEST(ComponentStoreTest, ComponentStoreReplace) {
+		Sigma::ComponentStore<Sigma::IComponent> store;
+		store.insert(1, std::unique_ptr<Sigma::IComponent>(new StoreTestComponent(1)));
+		StoreTestComponent* c = new StoreTestComponent(1);
+		store.insert(1, std::unique_ptr<Sigma::IComponent>(c));
+		EXPECT_EQ(1u, store.size());
+		EXPECT_EQ(c, store.get(1));
+	}
+
+	// test that removal swaps the last component into the hole and keeps lookups right
+	TEST(ComponentStoreTest, ComponentStoreRemove) {
+		Sigma::ComponentStore<Sigma::IComponent> store;
+		for (Sigma::id_t i = 0; i < 4; ++i) {
+			store.insert(i, std::unique_ptr<Sigma::IComponent>(new StoreTestComponent(i)));
+		}
+		Sigma::IComponent* last = store.get(3);
+		std::unique_ptr<Sigma::IComponent> removed = store.remove(1);
+		ASSERT_TRUE(removed != nullptr);
+		EXPECT_EQ(1u, removed->GetEntityID());
+		EXPECT_EQ(nullptr, store.get(1));
+		EXPECT_TRUE(store.remove(1) == nullptr) << "Entity 1 has no component left";
+		EXPECT_EQ(3u, store.size());
+		EXPECT_EQ(last, store.get(3));
+		EXPECT_EQ(3u, store.entityAt(1));
+		store.remove(3);
+		store.remove(0);
+		store.remove(2);
+		EXPECT_TRUE(store.empty());
+	}
+
+	// test that a component is only found with the generation of the entity it was stored for
+	TEST(ComponentStoreTest, ComponentStoreGenerations) {
+		Sigma::ComponentStore<Sigma::IComponent> store;
+		Sigma::id_t oldID = Sigma::MakeEntityID(7, 0);
+		Sigma::id_t newID = Sigma::MakeEntityID(7, 1);
+		store.insert(oldID, std::unique_ptr<Sigma::IComponent>(new StoreTestComponent(oldID)));
+		EXPECT_EQ(nullptr, store.get(newID));
+		EXPECT_TRUE(store.remove(newID) == nullptr);
+		store.remove(oldID);
+		StoreTestComponent* c = new StoreTestComponent(newID);
+		store.insert(newID, std::unique_ptr<Sigma::IComponent>(c));
+		EXPECT_EQ(c, store.get(newID));
+		EXPECT_EQ(nullptr, store.get(oldID));
+	}
+
+	// test that type IDs are fixed at compile time and the name is kept for lookups by string
+	TEST(ComponentStoreTest, ComponentTypeID) {
+		static_assert(StoreTestComponent::getStaticComponentTypeID() == Sigma::ComponentTypeHash("StoreTestComponent"), "type ID must be a compile time constant");
+		StoreTestComponent c(1);
+		EXPECT_EQ(StoreTestComponent::getStaticComponentTypeID(), c.getComponentTypeID());
+		EXPECT_STREQ("StoreTestComponent", c.getComponentTypeName());
+		EXPECT_NE(Sigma::ComponentTypeHash("GLMesh"), Sigma::ComponentTypeHash("GLSprite"));
+	}
+
+	// test that removal from a bucket swaps the last component into the hole
+	TEST(ComponentStoreTest, ComponentBucketAddRemove) {
+		StoreTestComponent a(1), b(2), c(3);
+		Sigma::ComponentBucket<StoreTestComponent> bucket;
+		bucket.add(&a);
+		bucket.add(&b);
+		bucket.add(&c);
+		bucket.add(&a);
+		EXPECT_EQ(3u, bucket.size()) << "Adding twice keeps one entry";
+		bucket.remove(&a);
+		ASSERT_EQ(2u, bucket.size());
+		EXPECT_EQ(&c, *bucket.begin());
+		EXPECT_FALSE(bucket.contains(&a));
+		bucket.remove(&a);
+		bucket.remove(&c);
+		bucket.remove(&b);
+		EXPECT_TRUE(bucket.empty());
+	}
+
+	class BucketTestSystem : public Sigma::ISystem<Sigma::IComponent> {
+	public:
+		BucketTestSystem() { this->RegisterBucket(&this->tests); }
+		void add(Sigma::id_t id, StoreTestComponent* c) {
+			this->addComponent(id, c);
+			this->tests.add(c);
+		}
+		// Removes every component of the given entity from inside an update pass
+		void update(Sigma::id_t remove) {
+			UpdateScope scope(*this);
+			size_t cleaned = this->cleanedUp.size();
+			for (auto citr = this->tests.begin(); citr != this->tests.end(); ++citr) {
+				if (static_cast<Sigma::id_t>((*citr)->GetEntityID()) == remove) {
+					this->removeEntity(remove);
+				}
+				// Still there until the pass ends
+				EXPECT_TRUE(this->tests.contains(*citr));
+			}
+			EXPECT_EQ(cleaned, this->cleanedUp.size());
+		}
+		// Deletes an entity and gives its index to a new one from inside an update pass
+		void reuse(Sigma::id_t oldID, Sigma::id_t newID, StoreTestComponent* c) {
+			UpdateScope scope(*this);
+			Sigma::IComponent* old = this->getComponent(oldID, StoreTestComponent::getStaticComponentTypeID());
+			this->removeEntity(oldID);
+			add(newID, c);
+			// Neither the removal nor the replacement happens until the pass ends
+			EXPECT_EQ(old, this->getComponent(oldID, StoreTestComponent::getStaticComponentTypeID()));
+			EXPECT_EQ(nullptr, this->getComponent(newID, StoreTestComponent::getStaticComponentTypeID()));
+			EXPECT_TRUE(this->cleanedUp.empty());
+		}
+		// Replaces the component of an entity from inside an update pass
+		void replace(Sigma::id_t id, StoreTestComponent* c) {
+			UpdateScope scope(*this);
+			Sigma::IComponent* old = this->getComponent(id, StoreTestComponent::getStaticComponentTypeID());
+			this->addComponent(id, c);
+			EXPECT_EQ(old, this->getComponent(id, StoreTestComponent::getStaticComponentTypeID()));
+			EXPECT_TRUE(this->tests.contains(old));
+			EXPECT_TRUE(this->cleanedUp.empty());
+			this->tests.add(c);
+		}
+		Sigma::ComponentBucket<StoreTestComponent> tests;
+		std::vector<Sigma::id_t> cleanedUp;
+	protected:
+		void cleanupComponent(Sigma::IComponent* c) override {
+			EXPECT_TRUE(this->tests.contains(c)) << "Cleanup runs before the component leaves its buckets";
+			this->cleanedUp.push_back(c->GetEntityID());
+		}
+	};
+
+	// test that a system drops a replaced component from its buckets
+	TEST(ComponentStoreTest, ComponentBucketReplace) {
+		BucketTestSystem system;
+		system.add(1, new StoreTestComponent(1));
+		StoreTestComponent* c = new StoreTestComponent(1);
+		system.add(1, c);
+		ASSERT_EQ(1u, system.tests.size());
+		EXPECT_EQ(c, *system.tests.begin());
+		EXPECT_EQ(c, system.getComponent(1, StoreTestComponent::getStaticComponentTypeID()));
+		ASSERT_EQ(1u, system.cleanedUp.size()) << "The replaced component should be cleaned up";
+	}
+
+	// test that a component of a deleted entity is cleaned up when its index is reused during an update
+	TEST(ComponentStoreTest, ComponentSystemReuseIndex) {
+		BucketTestSystem system;
+		Sigma::id_t oldID = Sigma::MakeEntityID(4, 0);
+		Sigma::id_t newID = Sigma::MakeEntityID(4, 1);
+		Sigma::IComponent::ComponentID type = StoreTestComponent::getStaticComponentTypeID();
+		StoreTestComponent* old = new StoreTestComponent(oldID);
+		system.add(oldID, old);
+		StoreTestComponent* c = new StoreTestComponent(newID);
+		system.reuse(oldID, newID, c);
+		EXPECT_EQ(c, system.getComponent(newID, type));
+		EXPECT_EQ(nullptr, system.getComponent(oldID, type));
+		ASSERT_EQ(1u, system.tests.size());
+		EXPECT_EQ(c, *system.tests.begin());
+		ASSERT_EQ(1u, system.cleanedUp.size()) << "The component of the deleted entity should be cleaned up once";
+		EXPECT_EQ(oldID, system.cleanedUp[0]);
+		EXPECT_EQ(1u, system.removeEntity(newID));
+	}
+
+	// test that replacing a component during an update is deferred until the update ends
+	TEST(ComponentStoreTest, ComponentSystemReplaceDeferred) {
+		BucketTestSystem system;
+		StoreTestComponent* old = new StoreTestComponent(1);
+		system.add(1, old);
+		StoreTestComponent* c = new StoreTestComponent(1);
+		system.replace(1, c);
+		EXPECT_EQ(c, system.getComponent(1, StoreTestComponent::getStaticComponentTypeID()));
+		ASSERT_EQ(1u, system.tests.size());
+		EXPECT_EQ(c, *system.tests.begin());
+		ASSERT_EQ(1u, system.cleanedUp.size()) << "The replaced component should be cleaned up after the update";
+	}
+
+	// test that removal cleans up and unlinks the component, and is deferred during an update
+	TEST(ComponentStoreTest, ComponentSystemRemove) {
+		BucketTestSystem system;
+		for (Sigma::id_t i = 1; i <= 3; ++i) {
+			system.add(i, new StoreTestComponent(i));
+		}
+		Sigma::IComponent::ComponentID type = StoreTestComponent::getStaticComponentTypeID();
+		EXPECT_TRUE(system.removeComponent(2, type));
+		EXPECT_FALSE(system.removeComponent(2, type));
+		EXPECT_EQ(nullptr, system.getComponent(2, type));
+		EXPECT_EQ(2u, system.tests.size());
+		ASSERT_EQ(1u, system.cleanedUp.size());
+		EXPECT_EQ(2u, system.cleanedUp[0]);
+
+		system.update(3);
+		EXPECT_EQ(nullptr, system.getComponent(3, type)) << "Deferred removal should run after the update";
+		EXPECT_EQ(1u, system.tests.size());
+		ASSERT_EQ(2u, system.cleanedUp.size());
+		EXPECT_EQ(3u, system.cleanedUp[1]);
+		EXPECT_EQ(0u, system.removeEntity(3));
+	}
+}  // namespace
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "EntityManager.h"
+#include "ISystem.h"
 #include <string>
 
 using Sigma::EntityManager;
@@ -39,4 +40,79 @@ namespace {
         EXPECT_THROW(EntityManager::AddComponent(0, "", std::vector<Property>()), Sigma::NoSuchEntityException);
         EXPECT_THROW(EntityManager::UseContext(1000), Sigma::NoSuchContextException);
 	}
+
+	class EntityTestComponent : public Sigma::IComponent {
+	public:
+		SET_COMPONENT_TYPENAME("EntityTestComponent");
+		EntityTestComponent(const Sigma::id_t id) : IComponent(id) {}
+	};
+
+	class EntityTestSystem : public Sigma::ISystem<Sigma::IComponent> {
+	public:
+		size_t count() const {
+			auto store = this->_Stores.find(EntityTestComponent::getStaticComponentTypeID());
+			return (store != this->_Stores.end()) ? store->second.size() : 0;
+		}
+	};
+
+	// test that deleted IDs go stale when their slot is reused, and that deletion empties the systems
+	TEST(EntityManagerTest, EntityManagerGenerations) {
+        EntityManager::UseContext(EntityManager::CreateContext());
+        EntityTestSystem system;
+        EntityManager::RegisterSystem(system);
+
+        Sigma::id_t first = EntityManager::CreateEntity();
+        Sigma::id_t second = EntityManager::CreateEntity();
+        EXPECT_NE(first, second);
+        EXPECT_EQ(2u, EntityManager::Entities().size());
+        system.addComponent(first, new EntityTestComponent(first));
+        system.addComponent(second, new EntityTestComponent(second));
+
+        EXPECT_TRUE(EntityManager::DeleteEntity(first));
+        EXPECT_EQ(1u, system.count()) << "Deleting an entity should remove its components";
+        EXPECT_EQ(nullptr, system.getComponent(first, EntityTestComponent::getStaticComponentTypeID()));
+        EXPECT_EQ(1u, EntityManager::Entities().size());
+        EXPECT_EQ(second, EntityManager::Entities()[0]);
+
+        Sigma::id_t reused = EntityManager::CreateEntity();
+        EXPECT_EQ(Sigma::EntityIndex(first), Sigma::EntityIndex(reused)) << "Deleted slots should be reused";
+        EXPECT_NE(first, reused);
+        EXPECT_TRUE(EntityManager::EntityExists(reused));
+        EXPECT_FALSE(EntityManager::EntityExists(first)) << "The old ID should be stale";
+        EXPECT_FALSE(EntityManager::DeleteEntity(first));
+        EXPECT_TRUE(EntityManager::EntityExists(second));
+
+        EntityManager::UnregisterSystem(system);
+        EXPECT_TRUE(EntityManager::DeleteEntity(second));
+        EXPECT_EQ(1u, system.count()) << "Unregistered systems should keep their components";
+	}
+
+	// test that creating an entity with a given ID can't bring back deleted IDs or lose free slots
+	TEST(EntityManagerTest, EntityManagerCreateWithID) {
+        EntityManager::UseContext(EntityManager::CreateContext());
+
+        Sigma::id_t deleted = EntityManager::CreateEntity();
+        EXPECT_TRUE(EntityManager::DeleteEntity(deleted));
+        EXPECT_FALSE(EntityManager::CreateEntity(deleted));
+        EXPECT_FALSE(EntityManager::EntityExists(deleted)) << "A deleted ID should stay deleted";
+
+        Sigma::id_t next = Sigma::MakeEntityID(Sigma::EntityIndex(deleted), Sigma::EntityGeneration(deleted) + 1);
+        EXPECT_FALSE(EntityManager::CreateEntity(next));
+        EXPECT_TRUE(EntityManager::EntityExists(next)) << "The slot's next generation should be created";
+        EXPECT_TRUE(EntityManager::CreateEntity(next));
+
+        Sigma::id_t stale = Sigma::MakeEntityID(Sigma::EntityIndex(next), Sigma::EntityGeneration(next) + 5);
+        EXPECT_FALSE(EntityManager::CreateEntity(stale));
+        EXPECT_FALSE(EntityManager::EntityExists(stale));
+        EXPECT_TRUE(EntityManager::EntityExists(next));
+
+        // The slots below a far ID are free, and are handed out before new ones
+        const Sigma::id_t far = 5000;
+        EXPECT_FALSE(EntityManager::CreateEntity(far));
+        for (int i = 0; i < 100; ++i) {
+            Sigma::id_t created = EntityManager::CreateEntity();
+            EXPECT_LT(Sigma::EntityIndex(created), far);
+            EXPECT_NE(Sigma::EntityIndex(next), Sigma::EntityIndex(created));
+        }
+	}
 }  // namespace
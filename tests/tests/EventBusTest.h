@@ -0,0 +1,121 @@
+#pragma once
+
+#include "EventBus.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	struct CountEvent {
+		SET_EVENT_TYPENAME("CountEvent");
+		int producer;
+		int count;
+	};
+
+	struct NameEvent {
+		SET_EVENT_TYPENAME("NameEvent");
+		std::string name;
+	};
+
+	// too big for a pooled node
+	struct BlobEvent {
+		SET_EVENT_TYPENAME("BlobEvent");
+		char data[4096];
+	};
+
+	// test that events reach the handlers of their type, in the order each thread published them
+	TEST(EventBusTest, EventBusThreads) {
+		Sigma::EventBus bus;
+		const int producers = 4, events = 10000;
+		std::vector<int> next(producers, 0);
+		bool ordered = true;
+		bus.Subscribe<CountEvent>([&] (const CountEvent& e) {
+			ordered = ordered && e.count == next[e.producer];
+			++next[e.producer];
+		});
+		std::vector<std::string> names;
+		bus.Subscribe<NameEvent>([&names] (const NameEvent& e) { names.push_back(e.name); });
+
+		std::vector<std::thread> threads;
+		for (int p = 0; p < producers; ++p) {
+			threads.push_back(std::thread([&bus, p, events] () {
+				for (int i = 0; i < events; ++i) {
+					CountEvent e = { p, i };
+					bus.Publish(e);
+				}
+			}));
+		}
+		// Drain while they publish
+		size_t handled = 0;
+		for (int d = 0; d < 100; ++d) {
+			handled += bus.Dispatch();
+		}
+		for (auto titr = threads.begin(); titr != threads.end(); ++titr) {
+			titr->join();
+		}
+		NameEvent name = { "done" };
+		bus.Publish(name);
+		handled += bus.Dispatch();
+
+		EXPECT_TRUE(ordered) << "A thread's events should arrive in order";
+		EXPECT_EQ(static_cast<size_t>(producers * events + 1), handled);
+		for (int p = 0; p < producers; ++p) {
+			EXPECT_EQ(events, next[p]);
+		}
+		ASSERT_EQ(1u, names.size());
+		EXPECT_EQ("done", names[0]);
+		EXPECT_EQ(0u, bus.Dispatch());
+	}
+
+	// test that events published by a handler wait for the next dispatch
+	TEST(EventBusTest, EventBusReentrant) {
+		Sigma::EventBus bus;
+		int handled = 0;
+		bus.Subscribe<CountEvent>([&bus, &handled] (const CountEvent& e) {
+			++handled;
+			if (e.count < 3) {
+				CountEvent again = { e.producer, e.count + 1 };
+				bus.Publish(again);
+			}
+		});
+		CountEvent first = { 0, 0 };
+		bus.Publish(first);
+		EXPECT_EQ(1u, bus.Dispatch());
+		EXPECT_EQ(1u, bus.Dispatch());
+		EXPECT_EQ(2u, bus.Dispatch() + bus.Dispatch());
+		EXPECT_EQ(0u, bus.Dispatch());
+		EXPECT_EQ(4, handled);
+
+		// undispatched events are freed with the bus
+		bus.Publish(first);
+	}
+
+	// test that an event's type ID is the hash of its name, the same in every module
+	TEST(EventBusTest, EventBusTypeID) {
+		EXPECT_EQ(Sigma::ComponentTypeHash("CountEvent"), CountEvent::getStaticEventTypeID());
+		EXPECT_NE(CountEvent::getStaticEventTypeID(), NameEvent::getStaticEventTypeID());
+		EXPECT_STREQ("NameEvent", NameEvent::getStaticEventTypeName());
+	}
+
+	// test that nodes handed back by dispatch are reused, and events too big to pool still get through
+	TEST(EventBusTest, EventBusPooled) {
+		Sigma::EventBus bus;
+		std::string last;
+		size_t blobs = 0;
+		bus.Subscribe<NameEvent>([&last] (const NameEvent& e) { last = e.name; });
+		bus.Subscribe<BlobEvent>([&blobs] (const BlobEvent& e) { blobs += (e.data[0] == 'x' && e.data[4095] == 'y') ? 1 : 0; });
+		for (int round = 0; round < 100; ++round) {
+			for (int i = 0; i < 10; ++i) {
+				NameEvent name = { std::to_string(round * 10 + i) };
+				bus.Publish(name);
+			}
+			BlobEvent blob;
+			blob.data[0] = 'x';
+			blob.data[4095] = 'y';
+			bus.Publish(blob);
+			EXPECT_EQ(11u, bus.Dispatch());
+			EXPECT_EQ(std::to_string(round * 10 + 9), last);
+		}
+		EXPECT_EQ(100u, blobs);
+	}
+}  // namespace
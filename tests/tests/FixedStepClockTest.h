@@ -0,0 +1,33 @@
+#pragma once
+
+#include "FixedStepClock.h"
+
+namespace {
+	// test that frames are turned into whole steps and the remainder into alpha
+	TEST(FixedStepClockTest, FixedStepClockSteps) {
+		Sigma::FixedStepClock clock(100.0, 5);
+		EXPECT_DOUBLE_EQ(0.01, clock.StepTime());
+		EXPECT_EQ(0u, clock.Advance(0.005));
+		EXPECT_NEAR(0.5f, clock.Alpha(), 1e-4f);
+		EXPECT_EQ(1u, clock.Advance(0.0075)) << "Leftover time carries into the next frame";
+		EXPECT_NEAR(0.25f, clock.Alpha(), 1e-4f);
+		EXPECT_EQ(3u, clock.Advance(0.03));
+		EXPECT_EQ(3u, clock.Steps());
+		EXPECT_EQ(4u, clock.TotalSteps());
+		EXPECT_EQ(0u, clock.Advance(-1.0)) << "Time never runs backwards";
+		EXPECT_DOUBLE_EQ(0.0, clock.DroppedTime());
+	}
+
+	// test that a long frame runs at most the maximum number of steps and drops the rest
+	TEST(FixedStepClockTest, FixedStepClockCatchUp) {
+		Sigma::FixedStepClock clock(100.0, 5);
+		EXPECT_EQ(5u, clock.Advance(1.0025));
+		EXPECT_NEAR(0.25f, clock.Alpha(), 1e-3f);
+		EXPECT_NEAR(0.95, clock.DroppedTime(), 1e-6);
+		EXPECT_EQ(0u, clock.Advance(0.0)) << "Dropped time shouldn't be simulated later";
+
+		clock.SetRate(50.0);
+		EXPECT_DOUBLE_EQ(0.02, clock.StepTime());
+		EXPECT_EQ(1u, clock.Advance(0.02));
+	}
+}  // namespace
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "FramePacer.h"
+#include <chrono>
+#include <thread>
+
+namespace {
+	// A simulated clock: waits move it on by the time asked for, and each reading by a few
+	// microseconds, so spinning ends. The tests then don't depend on how loaded the machine is.
+	class FramePacerTestClock {
+	public:
+		FramePacerTestClock() : time(Sigma::FramePacer::Clock::time_point()) { }
+
+		void Attach(Sigma::FramePacer& pacer) {
+			pacer.SetClock([this] () {
+				this->time += std::chrono::microseconds(5);
+				return this->time;
+			});
+		}
+		void Advance(double seconds) {
+			this->time += std::chrono::duration_cast<Sigma::FramePacer::Clock::duration>(std::chrono::duration<double>(seconds));
+		}
+		double Seconds() const { return std::chrono::duration<double>(this->time.time_since_epoch()).count(); }
+	private:
+		Sigma::FramePacer::Clock::time_point time;
+	};
+
+	// test that frames are spaced by the rate and the time in between counts as idle
+	TEST(FramePacerTest, FramePacerRate) {
+		Sigma::FramePacer pacer(200.0);
+		FramePacerTestClock clock;
+		clock.Attach(pacer);
+		int waits = 0;
+		pacer.SetWaitFunction([&waits, &clock] (double seconds) {
+			++waits;
+			clock.Advance(seconds);
+		});
+		pacer.Wait();
+		pacer.ResetStats();
+		double start = clock.Seconds();
+		for (int frame = 0; frame < 10; ++frame) {
+			pacer.Wait();
+			clock.Advance(0.001); // the frame's work
+		}
+		double elapsed = clock.Seconds() - start;
+		EXPECT_GE(elapsed, 0.045) << "10 frames at 200fps take 50ms";
+		EXPECT_LE(elapsed, 0.056);
+		EXPECT_GE(waits, 10) << "Most of the time should be slept through the wait function";
+		EXPECT_GT(pacer.IdleFraction(), 0.7) << "A loop working 1ms of every 5ms is idle most of the time";
+		EXPECT_GT(pacer.LastIdle(), 0.003);
+		EXPECT_LE(pacer.IdleTime(), pacer.ElapsedTime());
+	}
+
+	// test that an unlimited pacer never waits, and a late frame doesn't cause a burst
+	TEST(FramePacerTest, FramePacerLate) {
+		Sigma::FramePacer pacer(0.0);
+		FramePacerTestClock clock;
+		clock.Attach(pacer);
+		pacer.SetWaitFunction([&clock] (double seconds) { clock.Advance(seconds); });
+		pacer.Wait();
+		EXPECT_EQ(0.0, pacer.LastIdle());
+
+		pacer.SetRate(100.0);
+		pacer.Wait();
+		clock.Advance(0.05); // a frame running five frames late
+		pacer.Wait();
+		EXPECT_EQ(0.0, pacer.LastIdle());
+		pacer.Wait();
+		EXPECT_GT(pacer.LastIdle(), 0.009) << "The next frame should be a whole frame later, not caught up";
+	}
+
+	// test that the steady clock paces too, with bounds loose enough for a loaded machine
+	TEST(FramePacerTest, FramePacerSteadyClock) {
+		Sigma::FramePacer pacer(200.0);
+		pacer.Wait();
+		auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < 4; ++frame) {
+			pacer.Wait();
+		}
+		std::this_thread::yield();
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		EXPECT_GE(elapsed, 0.015) << "4 frames at 200fps take 20ms";
+	}
+}  // namespace
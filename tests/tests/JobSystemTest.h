@@ -0,0 +1,123 @@
+#pragma once
+
+#include "JobSystem.h"
+#include <atomic>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace {
+	// test that every index of the range is visited exactly once
+	TEST(JobSystemTest, JobSystemParallelFor) {
+		Sigma::JobSystem jobs(3);
+		EXPECT_EQ(3u, jobs.WorkerCount());
+		std::vector<std::atomic<int>> visits(10000);
+		for (auto vitr = visits.begin(); vitr != visits.end(); ++vitr) {
+			*vitr = 0;
+		}
+		jobs.ParallelFor(0, visits.size(), 0, [&visits] (size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				++visits[i];
+			}
+		});
+		for (size_t i = 0; i < visits.size(); ++i) {
+			ASSERT_EQ(1, visits[i]) << "Index " << i;
+		}
+		jobs.ParallelFor(5, 5, 1, [] (size_t, size_t) { FAIL() << "Empty range"; });
+	}
+
+	// test that tasks wait for their predecessors, and jobs can start more jobs
+	TEST(JobSystemTest, JobSystemTaskGraph) {
+		Sigma::JobSystem jobs(3);
+		std::atomic<int> step(0);
+		std::atomic<int> inner(0);
+		int physics = -1, audio = -1, render = -1;
+		Sigma::TaskGraph graph;
+		auto p = graph.Add([&] () {
+			physics = step++;
+			jobs.ParallelFor(0, 100, 10, [&inner] (size_t begin, size_t end) { inner += static_cast<int>(end - begin); });
+		});
+		auto a = graph.Add([&] () { audio = step++; });
+		auto r = graph.Add([&] () { render = step++; });
+		graph.Precede(p, r);
+		graph.Precede(a, r);
+		jobs.Run(graph);
+		EXPECT_EQ(2, render) << "Render should run last";
+		EXPECT_NE(physics, audio);
+		EXPECT_EQ(100, inner);
+
+		// Graphs can be run again
+		jobs.Run(graph);
+		EXPECT_EQ(5, render);
+
+		graph.Precede(r, p);
+		EXPECT_THROW(jobs.Run(graph), std::invalid_argument);
+	}
+
+	// test that an exception in a job reaches the caller once the other jobs are done
+	TEST(JobSystemTest, JobSystemExceptions) {
+		Sigma::JobSystem jobs(2);
+		std::atomic<int> ran(0);
+		std::vector<Sigma::JobSystem::Job> work;
+		for (int i = 0; i < 8; ++i) {
+			work.push_back([&ran, i] () {
+				++ran;
+				if (i == 3) {
+					throw std::runtime_error("job failed");
+				}
+			});
+		}
+		EXPECT_THROW(jobs.Run(work), std::runtime_error);
+		EXPECT_EQ(8, ran);
+
+		Sigma::TaskGraph graph;
+		bool after = false;
+		graph.Precede(graph.Add([] () { throw std::runtime_error("task failed"); }), graph.Add([&after] () { after = true; }));
+		EXPECT_THROW(jobs.Run(graph), std::runtime_error);
+		EXPECT_TRUE(after) << "Tasks after a failed one should still run";
+	}
+
+	// test that submitted jobs run on a worker and report their exception to the callback
+	TEST(JobSystemTest, JobSystemSubmit) {
+		Sigma::JobSystem jobs(2);
+		std::mutex mutex;
+		std::condition_variable finished;
+		int done = 0;
+		std::thread::id ranOn;
+		std::exception_ptr error;
+		jobs.Submit([&ranOn] () { ranOn = std::this_thread::get_id(); }, [&] (std::exception_ptr) {
+			std::lock_guard<std::mutex> lock(mutex);
+			++done;
+			finished.notify_one();
+		});
+		jobs.Submit([] () { throw std::runtime_error("job failed"); }, [&] (std::exception_ptr e) {
+			std::lock_guard<std::mutex> lock(mutex);
+			error = e;
+			++done;
+			finished.notify_one();
+		});
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [&done] () { return done == 2; });
+		EXPECT_NE(std::this_thread::get_id(), ranOn);
+		EXPECT_THROW(std::rethrow_exception(error), std::runtime_error);
+	}
+
+	// test alignment, growth past the first block and reset of the frame allocator
+	TEST(JobSystemTest, FrameAllocatorReset) {
+		Sigma::FrameAllocator frame(256);
+		char* c = static_cast<char*>(frame.Allocate(1, 1));
+		double* d = frame.Allocate<double>(4);
+		EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(d) % std::alignment_of<double>::value);
+		EXPECT_EQ(0.0, d[3]) << "Arrays are value-initialized";
+		EXPECT_NE(static_cast<void*>(c), static_cast<void*>(d));
+		void* big = frame.Allocate(1000, 64);
+		EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(big) % 64);
+		EXPECT_GT(frame.Capacity(), 1000u);
+		size_t grown = frame.Capacity();
+		frame.Reset();
+		EXPECT_EQ(0u, frame.Used());
+		EXPECT_EQ(grown, frame.Capacity()) << "Reset keeps the memory in one block";
+		void* first = frame.Allocate(1, 1);
+		frame.Reset();
+		EXPECT_EQ(first, frame.Allocate(1, 1)) << "Reset starts over at the first byte";
+	}
+}  // namespace
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "PropertyBindings.h"
+#include <string>
+#include <vector>
+
+namespace {
+	struct BindingsTestTarget {
+		BindingsTestTarget() : count(0), enabled(false) { }
+		Sigma::PlacementProperties placement;
+		std::string name;
+		int count;
+		bool enabled;
+	};
+
+	// test that names are interned to stable IDs
+	TEST(PropertyBindingsTest, PropertyInternName) {
+		unsigned int id = Property::InternName("bindingsTestName");
+		EXPECT_EQ(id, Property::InternName("bindingsTestName"));
+		EXPECT_NE(id, Property::InternName("bindingsTestOtherName"));
+		EXPECT_EQ(id, Property("bindingsTestName", 1).GetNameID());
+	}
+
+	// test members, setters, placement and unbound properties in one pass
+	TEST(PropertyBindingsTest, PropertyBindingsApply) {
+		Sigma::PropertyBindings<BindingsTestTarget> bindings;
+		Sigma::BindPlacement(bindings, &BindingsTestTarget::placement);
+		bindings.Bind("name", &BindingsTestTarget::name)
+			.Bind("enabled", &BindingsTestTarget::enabled)
+			.Bind("increment", [] (BindingsTestTarget& t, const Property& p) { t.count += p.Get<int>(); });
+
+		std::vector<Property> properties;
+		properties.push_back(Property("x", 1.0f));
+		properties.push_back(Property("scale", 2.0f));
+		properties.push_back(Property("name", std::string("test")));
+		properties.push_back(Property("increment", 2));
+		properties.push_back(Property("unbound", 5));
+		properties.push_back(Property("increment", 3));
+		properties.push_back(Property("enabled", true));
+
+		BindingsTestTarget target;
+		bindings.Apply(target, properties);
+		EXPECT_EQ(1.0f, target.placement.x);
+		EXPECT_EQ(0.0f, target.placement.y);
+		EXPECT_EQ(2.0f, target.placement.scale);
+		EXPECT_EQ("test", target.name);
+		EXPECT_EQ(5, target.count);
+		EXPECT_TRUE(target.enabled);
+	}
+
+	// test that a property of the wrong type is skipped rather than reinterpreted, and the rest still applied
+	TEST(PropertyBindingsTest, PropertyBindingsWrongType) {
+		Sigma::PropertyBindings<BindingsTestTarget> bindings;
+		bindings.Bind("name", &BindingsTestTarget::name)
+			.Bind("count", &BindingsTestTarget::count);
+		std::vector<Property> properties;
+		properties.push_back(Property("name", 1.0f));
+		properties.push_back(Property("count", 4));
+		BindingsTestTarget target;
+		target.name = "default";
+		EXPECT_NO_THROW(bindings.Apply(target, properties));
+		EXPECT_EQ("default", target.name);
+		EXPECT_EQ(4, target.count);
+	}
+}  // namespace
@@ -2,6 +2,7 @@
 
 #include "Property.h"
 #include <string>
+#include <vector>
 
 namespace {
 	// Basic move and copy tests with POD int
@@ -100,4 +101,41 @@ namespace {
 		EXPECT_ANY_THROW(p2.Get<std::vector<int>*>()->push_back(10));
 		delete testINT;
 	}
+
+	// Strings short enough to be stored inline and long ones on the heap
+	TEST(PropertyTest, PropertyCopyMoveString) {
+		const std::string shortValue = "short";
+		const std::string longValue = "models/a/long/path/to/some/mesh.obj";
+		Property s("PropertyTestName", shortValue);
+		Property l("PropertyTestName", longValue.c_str());
+		Property copied_S(s), copied_L(l);
+		EXPECT_EQ(shortValue, copied_S.Get<std::string>());
+		EXPECT_EQ(longValue, copied_L.Get<std::string>());
+		Property moved_L = std::move(l);
+		EXPECT_EQ(longValue, moved_L.Get<std::string>());
+		copied_S = moved_L;
+		EXPECT_EQ(longValue, copied_S.Get<std::string>());
+		EXPECT_EQ(Property::STRING, copied_S.GetType());
+	}
+
+	// Scalars are checked too, no silent reinterpretation
+	TEST(PropertyTest, PropertyGetDifferentScalarType) {
+		Property p("PropertyTestName", 10.0f);
+		EXPECT_EQ(10.0f, p.Get<float>());
+		EXPECT_THROW(p.Get<int>(), std::bad_cast);
+		EXPECT_THROW(p.Get<std::string>(), std::bad_cast);
+	}
+
+	// Objects on the heap and pointers are checked against the type they were set with
+	TEST(PropertyTest, PropertyGetDifferentObjectType) {
+		std::vector<int> values(3, 7);
+		Property o("PropertyTestName", values);
+		EXPECT_EQ(values, o.Get<std::vector<int>>());
+		EXPECT_THROW(o.Get<std::vector<float>>(), std::bad_cast);
+		int target = 10;
+		Property p("PropertyTestName", &target);
+		EXPECT_EQ(&target, p.Get<int*>());
+		EXPECT_THROW(p.Get<float*>(), std::bad_cast);
+		EXPECT_THROW(p.Get<int>(), std::bad_cast);
+	}
 }  // namespace
\ No newline at end of file
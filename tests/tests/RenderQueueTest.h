@@ -0,0 +1,88 @@
+#pragma once
+
+#include "RenderQueue.h"
+
+namespace {
+	// test that keys order by pass, then state, then depth front to back
+	TEST(RenderQueueTest, RenderQueueKeyOrder) {
+		using Sigma::RenderQueue;
+		EXPECT_LT(RenderQueue::MakeKey(0, 9, 9, 9, 100.0f), RenderQueue::MakeKey(1, 1, 1, 1, 1.0f)) << "The pass comes first";
+		EXPECT_LT(RenderQueue::MakeKey(0, 1, 9, 9, 100.0f), RenderQueue::MakeKey(0, 2, 1, 1, 1.0f)) << "Then the shader";
+		EXPECT_LT(RenderQueue::MakeKey(0, 1, 1, 9, 100.0f), RenderQueue::MakeKey(0, 1, 2, 1, 1.0f)) << "Then the material";
+		EXPECT_LT(RenderQueue::MakeKey(0, 1, 1, 1, 100.0f), RenderQueue::MakeKey(0, 1, 1, 2, 1.0f)) << "Then the vertex array";
+		EXPECT_LT(RenderQueue::MakeKey(0, 1, 1, 1, 1.0f), RenderQueue::MakeKey(0, 1, 1, 1, 2.0f)) << "Then closest first";
+		EXPECT_EQ(RenderQueue::MakeKey(0, 1, 1, 1, 0.0f), RenderQueue::MakeKey(0, 1, 1, 1, -5.0f)) << "Behind the camera is depth 0";
+
+		uint64_t key = RenderQueue::MakeKey(3, 1, 2, 4, 10.0f);
+		EXPECT_EQ(3u, RenderQueue::Pass(key));
+		EXPECT_EQ(RenderQueue::State(key), RenderQueue::State(RenderQueue::MakeKey(3, 1, 2, 4, 20.0f))) << "The depth isn't state";
+	}
+
+	// test that sorting groups the draws, ties keep their order, and passes are found
+	TEST(RenderQueueTest, RenderQueueSortAndPasses) {
+		using Sigma::RenderQueue;
+		RenderQueue queue;
+		queue.Submit(RenderQueue::MakeKey(1, 1, 0, 1, 5.0f), 0);
+		queue.Submit(RenderQueue::MakeKey(0, 2, 0, 1, 5.0f), 1);
+		queue.Submit(RenderQueue::MakeKey(0, 1, 0, 1, 5.0f), 2);
+		queue.Submit(RenderQueue::MakeKey(0, 2, 0, 1, 5.0f), 3);
+		queue.Submit(RenderQueue::MakeKey(0, 1, 0, 1, 1.0f), 4);
+		queue.Sort();
+
+		const uint32_t expected[] = { 4, 2, 1, 3, 0 };
+		ASSERT_EQ(5u, queue.size());
+		for (size_t i = 0; i < queue.size(); ++i) {
+			EXPECT_EQ(expected[i], queue.Items()[i].index) << "at position " << i;
+		}
+
+		EXPECT_EQ(std::make_pair(size_t(0), size_t(4)), queue.PassRange(0));
+		EXPECT_EQ(std::make_pair(size_t(4), size_t(5)), queue.PassRange(1));
+		EXPECT_EQ(std::make_pair(size_t(5), size_t(5)), queue.PassRange(2)) << "An empty pass is an empty range";
+
+		// the draws after a removed one move down, keeping their place in the queue
+		queue.Remove(2);
+		const uint32_t shifted[] = { 3, 1, 2, 0 };
+		ASSERT_EQ(4u, queue.size());
+		for (size_t i = 0; i < queue.size(); ++i) {
+			EXPECT_EQ(shifted[i], queue.Items()[i].index) << "at position " << i;
+		}
+
+		queue.Clear();
+		EXPECT_TRUE(queue.empty());
+	}
+
+	// test that runs join the draws the predicate allows, within a pass and up to the maximum
+	TEST(RenderQueueTest, RenderQueueRuns) {
+		using Sigma::RenderQueue;
+		RenderQueue queue;
+		queue.Submit(RenderQueue::MakeKey(0, 1, 0, 1, 1.0f), 0);
+		queue.Submit(RenderQueue::MakeKey(0, 1, 0, 1, 2.0f), 1);
+		queue.Submit(RenderQueue::MakeKey(0, 1, 0, 1, 3.0f), 2);
+		queue.Submit(RenderQueue::MakeKey(0, 1, 0, 2, 1.0f), 3);
+		queue.Submit(RenderQueue::MakeKey(1, 1, 0, 2, 1.0f), 4);
+		queue.Sort();
+
+		// draws of the same vertex array can share a run
+		auto sameVao = [] (const RenderQueue::Item& a, const RenderQueue::Item& b) {
+			return RenderQueue::State(a.key) == RenderQueue::State(b.key);
+		};
+		std::vector<RenderQueue::Run> runs;
+		queue.Runs(10, sameVao, runs);
+		ASSERT_EQ(3u, runs.size());
+		EXPECT_EQ(0u, runs[0].begin);
+		EXPECT_EQ(3u, runs[0].count);
+		EXPECT_EQ(3u, runs[1].begin);
+		EXPECT_EQ(1u, runs[1].count) << "A run stays in its pass";
+		EXPECT_EQ(4u, runs[2].begin);
+		EXPECT_EQ(1u, runs[2].count);
+
+		queue.Runs(2, sameVao, runs);
+		ASSERT_EQ(4u, runs.size()) << "The runs are cleared, and split at the maximum";
+		EXPECT_EQ(2u, runs[0].count);
+		EXPECT_EQ(2u, runs[1].begin);
+		EXPECT_EQ(1u, runs[1].count);
+
+		queue.Runs(10, [] (const RenderQueue::Item&, const RenderQueue::Item&) { return false; }, runs);
+		EXPECT_EQ(queue.size(), runs.size()) << "Without a match, each draw is its own run";
+	}
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "SCParser.h"
+#include "SCBWriter.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+	// Writes a scene file for a test and removes it afterwards
+	class SCParserTest : public ::testing::Test {
+	protected:
+		SCParserTest() : fname("sc_parser_test.sc"), binaryName("sc_parser_test.scb") { }
+		~SCParserTest() {
+			remove(this->fname.c_str());
+			remove(this->binaryName.c_str());
+		}
+		void Write(const std::string& contents) {
+			std::ofstream out(this->fname, std::ios::out | std::ios::binary);
+			out << contents;
+		}
+		std::string fname;
+		std::string binaryName;
+	};
+
+	// test that entities, components and every property type are parsed
+	TEST_F(SCParserTest, SCParserParse) {
+		Write("@first\r\n#7\r\n&GLMesh\r\n>x=-1.5f\r\n>meshFile=models/a mesh.objs\r\n>lightEnabled=1b\r\n>count=42i  \r\n#9\r\n\r\n"
+			"&PointLight\n>radius=2.5e2f\n// a comment\n@second // trailing comment\n#8\n&GLView\n>y=0.001f");
+		Sigma::parser::SCParser parser;
+		ASSERT_TRUE(parser.Parse(this->fname));
+		ASSERT_EQ(2u, parser.EntityCount());
+
+		Sigma::parser::Entity* e = parser.GetEntity(0);
+		EXPECT_EQ("first", e->name);
+		EXPECT_EQ(7, e->id);
+		ASSERT_EQ(2u, e->components.size());
+		const std::vector<Property>& mesh = e->components[0].properties;
+		EXPECT_EQ("GLMesh", e->components[0].type);
+		ASSERT_EQ(5u, mesh.size());
+		EXPECT_EQ("x", mesh[0].GetName());
+		EXPECT_FLOAT_EQ(-1.5f, mesh[0].Get<float>());
+		EXPECT_EQ("models/a mesh.obj", mesh[1].Get<std::string>());
+		EXPECT_TRUE(mesh[2].Get<bool>());
+		EXPECT_EQ(42, mesh[3].Get<int>());
+		EXPECT_EQ("id", mesh[4].GetName());
+		EXPECT_EQ(9, mesh[4].Get<int>());
+		EXPECT_EQ("PointLight", e->components[1].type);
+		EXPECT_FLOAT_EQ(250.0f, e->components[1].properties[0].Get<float>());
+
+		e = parser.GetEntity(1);
+		EXPECT_EQ("second", e->name);
+		EXPECT_EQ(8, e->id);
+		ASSERT_EQ(1u, e->components.size());
+		EXPECT_FLOAT_EQ(0.001f, e->components[0].properties[0].Get<float>());
+	}
+
+	// test that bools are read as numbers, as the stream based parser read them
+	TEST_F(SCParserTest, SCParserBool) {
+		Write("@first\n&GLMesh\n>a=1b\n>b=0b\n>c=2b\n>d=trueb\n>e=falseb\n");
+		Sigma::parser::SCParser parser;
+		ASSERT_TRUE(parser.Parse(this->fname));
+		ASSERT_EQ(1u, parser.EntityCount());
+		const std::vector<Property>& props = parser.GetEntity(0)->components[0].properties;
+		ASSERT_EQ(5u, props.size());
+		EXPECT_TRUE(props[0].Get<bool>());
+		EXPECT_FALSE(props[1].Get<bool>());
+		EXPECT_TRUE(props[2].Get<bool>()) << "Any number but 0 is true";
+		EXPECT_FALSE(props[3].Get<bool>()) << "Words aren't numbers";
+		EXPECT_FALSE(props[4].Get<bool>());
+	}
+
+	// test that entities are streamed in order through the callback
+	TEST_F(SCParserTest, SCParserStream) {
+		std::string scene;
+		for (int i = 0; i < 100; ++i) {
+			scene += "@e\n#" + std::to_string(i) + "\n&GLIcoSphere\n>scale=" + std::to_string(i) + ".5f\n\n";
+		}
+		Write(scene);
+		Sigma::parser::SCParser parser;
+		int count = 0;
+		bool parsed = parser.Parse(this->fname, [&] (Sigma::parser::Entity& e) {
+			EXPECT_EQ(count, e.id);
+			ASSERT_EQ(1u, e.components.size());
+			ASSERT_EQ(1u, e.components[0].properties.size());
+			EXPECT_FLOAT_EQ(count + 0.5f, e.components[0].properties[0].Get<float>());
+			++count;
+		});
+		EXPECT_TRUE(parsed);
+		EXPECT_EQ(100, count);
+		EXPECT_EQ(0u, parser.EntityCount());
+	}
+
+	// test that a compiled scene loads the same entities as its source
+	TEST_F(SCParserTest, SCParserCompiled) {
+		Write("@first\n#7\n&GLMesh\n>x=-1.5f\n>meshFile=models/a mesh.objs\n>lightEnabled=1b\n>count=42i\n#9\n"
+			"&GLMesh\n>meshFile=models/a mesh.objs\n\n@second\n#8\n&GLView\n>y=0.001f\n\n@empty\n");
+		ASSERT_TRUE(Sigma::parser::SCBWriter::Compile(this->fname, this->binaryName));
+
+		Sigma::parser::SCParser text, binary;
+		ASSERT_TRUE(text.Parse(this->fname));
+		ASSERT_TRUE(binary.Parse(this->binaryName));
+		ASSERT_EQ(3u, binary.EntityCount());
+		ASSERT_EQ(text.EntityCount(), binary.EntityCount());
+		for (unsigned int i = 0; i < text.EntityCount(); ++i) {
+			Sigma::parser::Entity* expected = text.GetEntity(i);
+			Sigma::parser::Entity* e = binary.GetEntity(i);
+			EXPECT_EQ(expected->name, e->name);
+			EXPECT_EQ(expected->id, e->id);
+			ASSERT_EQ(expected->components.size(), e->components.size());
+			for (size_t c = 0; c < e->components.size(); ++c) {
+				EXPECT_EQ(expected->components[c].type, e->components[c].type);
+				EXPECT_EQ(Sigma::ComponentTypeHash(e->components[c].type.c_str()), e->components[c].typeID);
+				const std::vector<Property>& expectedProps = expected->components[c].properties;
+				const std::vector<Property>& props = e->components[c].properties;
+				ASSERT_EQ(expectedProps.size(), props.size());
+				for (size_t p = 0; p < props.size(); ++p) {
+					EXPECT_EQ(expectedProps[p].GetName(), props[p].GetName());
+					EXPECT_EQ(expectedProps[p].GetNameID(), props[p].GetNameID());
+					ASSERT_EQ(expectedProps[p].GetType(), props[p].GetType());
+				}
+			}
+		}
+		const std::vector<Property>& mesh = binary.GetEntity(0)->components[0].properties;
+		EXPECT_FLOAT_EQ(-1.5f, mesh[0].Get<float>());
+		EXPECT_EQ("models/a mesh.obj", mesh[1].Get<std::string>());
+		EXPECT_TRUE(mesh[2].Get<bool>());
+		EXPECT_EQ(42, mesh[3].Get<int>());
+		EXPECT_EQ(9, mesh[4].Get<int>());
+		EXPECT_EQ(mesh[1].GetNameID(), binary.GetEntity(0)->components[1].properties[0].GetNameID());
+		EXPECT_EQ(Property::InternName("meshFile"), text.GetEntity(0)->components[1].properties[0].GetNameID());
+		EXPECT_EQ(Property::InternName("id"), text.GetEntity(0)->components[0].properties[4].GetNameID());
+	}
+
+	// test that negative ints, big ints, false and long strings survive compiling
+	TEST_F(SCParserTest, SCParserCompiledValues) {
+		Write("@e\n#-3\n&T\n>a=-70000i\n>b=2147483647i\n>c=0b\n>d=" + std::string(300, 'x') + "s\n");
+		ASSERT_TRUE(Sigma::parser::SCBWriter::Compile(this->fname, this->binaryName));
+
+		Sigma::parser::SCParser parser;
+		ASSERT_TRUE(parser.Parse(this->binaryName));
+		ASSERT_EQ(1u, parser.EntityCount());
+		EXPECT_EQ(-3, parser.GetEntity(0)->id);
+		const std::vector<Property>& props = parser.GetEntity(0)->components[0].properties;
+		ASSERT_EQ(4u, props.size());
+		EXPECT_EQ(-70000, props[0].Get<int>());
+		EXPECT_EQ(2147483647, props[1].Get<int>());
+		EXPECT_FALSE(props[2].Get<bool>());
+		EXPECT_EQ(std::string(300, 'x'), props[3].Get<std::string>());
+	}
+
+	// test that truncated compiled scenes are rejected rather than read past their end
+	TEST_F(SCParserTest, SCParserCompiledTruncated) {
+		Write("@first\n#7\n&GLMesh\n>meshFile=models/a mesh.objs\n>count=42i\n");
+		ASSERT_TRUE(Sigma::parser::SCBWriter::Compile(this->fname, this->binaryName));
+		std::string compiled;
+		{
+			std::ifstream in(this->binaryName, std::ios::in | std::ios::binary);
+			compiled.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+		}
+		for (size_t length = 4; length < compiled.size(); length += 3) {
+			this->fname = this->binaryName;
+			Write(compiled.substr(0, length));
+			Sigma::parser::SCParser parser;
+			EXPECT_FALSE(parser.Parse(this->binaryName));
+		}
+	}
+
+	TEST_F(SCParserTest, SCParserMissingFile) {
+		Sigma::parser::SCParser parser;
+		EXPECT_FALSE(parser.Parse("no_such_file.sc"));
+	}
+}  // namespace
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "SceneLoader.h"
+#include "resources/ResourceCache.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <set>
+
+namespace {
+	// Records which components were preloaded and created, and on which threads
+	class LoaderTestFactory : public Sigma::IFactory {
+	public:
+		std::map<std::string, FactoryFunction> getFactoryFunctions() {
+			std::map<std::string, FactoryFunction> retval;
+			retval["LoaderTest"] = [this] (const id_t, const std::vector<Property>& properties) -> Sigma::IComponent* {
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->created.push_back(properties[0].Get<int>());
+				if (this->preloaded.count(properties[0].Get<int>()) == 0) {
+					++this->createdEarly;
+				}
+				return nullptr;
+			};
+			return retval;
+		}
+
+		std::map<std::string, PreloadFunction> getPreloadFunctions() {
+			std::map<std::string, PreloadFunction> retval;
+			retval["LoaderTest"] = [this] (const std::vector<Property>& properties) {
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->preloaded.insert(properties[0].Get<int>());
+				this->preloadThreads.insert(std::this_thread::get_id());
+			};
+			return retval;
+		}
+
+		LoaderTestFactory() : createdEarly(0) { }
+
+		std::mutex mutex;
+		std::vector<int> created;
+		std::set<int> preloaded;
+		std::set<std::thread::id> preloadThreads;
+		int createdEarly; // created before their preload ran
+	};
+
+	// test that components are preloaded on workers and created in scene order on the calling thread
+	TEST(SceneLoaderTest, SceneLoaderLoad) {
+		const char* fname = "scene_loader_test.sc";
+		{
+			std::ofstream out(fname, std::ios::out | std::ios::binary);
+			for (int i = 0; i < 50; ++i) {
+				out << "@e\n#" << i << "\n&LoaderTest\n>index=" << i * 2 << "i\n&LoaderTest\n>index=" << i * 2 + 1 << "i\n\n";
+			}
+		}
+
+		LoaderTestFactory testFactory;
+		Sigma::FactorySystem& factory = Sigma::FactorySystem::getInstance();
+		factory.register_Factory(testFactory);
+
+		Sigma::SceneLoader loader(factory, 4);
+		std::thread::id loadingThread = std::this_thread::get_id();
+		std::vector<int> createdIDs;
+		size_t progressCalls = 0;
+		bool loaded = loader.Load(fname, [&] (Sigma::parser::Entity& e, Sigma::parser::Component& c) {
+			EXPECT_EQ(loadingThread, std::this_thread::get_id());
+			createdIDs.push_back(e.id);
+			factory.create(c.type, e.id, c.properties);
+		}, [&] (size_t created, size_t total) {
+			EXPECT_EQ(++progressCalls, created);
+			EXPECT_EQ(100u, total);
+		});
+		remove(fname);
+
+		ASSERT_TRUE(loaded);
+		EXPECT_EQ(100u, progressCalls);
+		ASSERT_EQ(100u, testFactory.created.size());
+		for (int i = 0; i < 100; ++i) {
+			EXPECT_EQ(i, testFactory.created[i]);
+			EXPECT_EQ(i / 2, createdIDs[i]);
+		}
+		EXPECT_EQ(100u, testFactory.preloaded.size());
+		EXPECT_EQ(0, testFactory.createdEarly);
+		EXPECT_EQ(0u, testFactory.preloadThreads.count(loadingThread));
+	}
+
+	TEST(SceneLoaderTest, SceneLoaderMissingFile) {
+		Sigma::SceneLoader loader(Sigma::FactorySystem::getInstance(), 2);
+		EXPECT_FALSE(loader.Load("no_such_scene.sc"));
+	}
+
+	// test that concurrent loads of a resource load it once, and that failures are cached
+	TEST(SceneLoaderTest, ResourceCacheLoadOnce) {
+		Sigma::resource::ResourceCache<std::string> cache;
+		std::atomic<int> loads(0);
+		auto load = [&loads] (const std::string& name, std::string& resource) {
+			++loads;
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			resource = name + " loaded";
+			return name != "missing";
+		};
+
+		std::vector<std::thread> threads;
+		std::vector<std::shared_ptr<std::string>> handles(8);
+		for (int i = 0; i < 8; ++i) {
+			threads.push_back(std::thread([&, i] () { handles[i] = cache.Load("a", load); }));
+		}
+		for (auto titr = threads.begin(); titr != threads.end(); ++titr) {
+			titr->join();
+		}
+		EXPECT_EQ(1, loads);
+		ASSERT_TRUE(handles[0] != nullptr);
+		EXPECT_EQ("a loaded", *handles[0]);
+		for (int i = 1; i < 8; ++i) {
+			EXPECT_EQ(handles[0], handles[i]);
+		}
+
+		EXPECT_TRUE(cache.Load("missing", load) == nullptr);
+		EXPECT_TRUE(cache.Load("missing", load) == nullptr);
+		EXPECT_EQ(2, loads);
+
+		cache.Remove("a");
+		EXPECT_EQ("a loaded", *cache.Load("a", load));
+		EXPECT_EQ(3, loads);
+		EXPECT_EQ("a loaded", *handles[0]);
+	}
+}  // namespace
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "SnapshotPair.h"
+#include <vector>
+#include <utility>
+
+namespace {
+	// A model whose state is a single number, blended linearly
+	struct SnapshotTestModel {
+		const int* key;
+		float previous;
+		float current;
+		float matrix;
+	};
+
+	struct SnapshotTestSnapshot {
+		void Remove(const int* key) {
+			for (auto mitr = this->models.begin(); mitr != this->models.end(); ++mitr) {
+				if (mitr->key == key) {
+					this->models.erase(mitr);
+					return;
+				}
+			}
+		}
+		std::vector<SnapshotTestModel> models;
+	};
+
+	typedef Sigma::SnapshotPair<SnapshotTestSnapshot, const int*> SnapshotTestPair;
+
+	float SnapshotTestLerp(const float& from, const float& to, float alpha) {
+		return from + (to - from) * alpha;
+	}
+
+	// Captures the current states into the pending snapshot, as OpenGLSystem::CaptureSnapshot does
+	void SnapshotTestCapture(SnapshotTestPair& pair, const std::vector<std::pair<const int*, float>>& states, bool stepped, float alpha) {
+		SnapshotTestSnapshot& snapshot = pair.Pending();
+		snapshot.models.resize(states.size());
+		for (size_t i = 0; i < states.size(); ++i) {
+			snapshot.models[i].key = states[i].first;
+			snapshot.models[i].current = states[i].second;
+		}
+		Sigma::BlendModels(snapshot.models.data(), 0, snapshot.models.size(), pair.Published().models, stepped, alpha, SnapshotTestLerp);
+	}
+
+	// test that captured models blend between their last two steps once published
+	TEST(SnapshotPairTest, SnapshotPairBlend) {
+		int a = 0, b = 0;
+		SnapshotTestPair pair;
+		std::vector<std::pair<const int*, float>> states;
+		states.push_back(std::make_pair(&a, 0.0f));
+		states.push_back(std::make_pair(&b, 10.0f));
+
+		SnapshotTestCapture(pair, states, true, 0.5f);
+		EXPECT_TRUE(pair.Published().models.empty()) << "Capturing shouldn't touch the published snapshot";
+		pair.Publish();
+		ASSERT_EQ(2u, pair.Published().models.size());
+		EXPECT_FLOAT_EQ(0.0f, pair.Published().models[0].matrix) << "New models aren't blended";
+		EXPECT_FLOAT_EQ(10.0f, pair.Published().models[1].matrix);
+
+		states[0].second = 2.0f;
+		states[1].second = 20.0f;
+		SnapshotTestCapture(pair, states, true, 0.25f);
+		pair.Publish();
+		EXPECT_FLOAT_EQ(0.5f, pair.Published().models[0].matrix);
+		EXPECT_FLOAT_EQ(12.5f, pair.Published().models[1].matrix);
+
+		// Without a step in between the blend moves on from the same previous states
+		SnapshotTestCapture(pair, states, false, 0.75f);
+		pair.Publish();
+		EXPECT_FLOAT_EQ(0.0f, pair.Published().models[0].previous);
+		EXPECT_FLOAT_EQ(1.5f, pair.Published().models[0].matrix);
+		EXPECT_FLOAT_EQ(17.5f, pair.Published().models[1].matrix);
+
+		// Models that changed places aren't blended for a frame
+		std::swap(states[0], states[1]);
+		SnapshotTestCapture(pair, states, true, 0.5f);
+		pair.Publish();
+		EXPECT_FLOAT_EQ(20.0f, pair.Published().models[0].matrix);
+		EXPECT_FLOAT_EQ(2.0f, pair.Published().models[1].matrix);
+	}
+
+	// test that removed models stay in both snapshots until the next publish
+	TEST(SnapshotPairTest, SnapshotPairRemove) {
+		int a = 0, b = 0;
+		SnapshotTestPair pair;
+		std::vector<std::pair<const int*, float>> states;
+		states.push_back(std::make_pair(&a, 1.0f));
+		states.push_back(std::make_pair(&b, 2.0f));
+		SnapshotTestCapture(pair, states, true, 1.0f);
+		pair.Publish();
+		SnapshotTestCapture(pair, states, true, 1.0f);
+
+		pair.Remove(&a);
+		EXPECT_TRUE(pair.HasRemovals());
+		EXPECT_TRUE(pair.IsRemoved(&a));
+		EXPECT_FALSE(pair.IsRemoved(&b));
+		EXPECT_EQ(2u, pair.Published().models.size()) << "The published snapshot may still be drawn";
+		EXPECT_EQ(2u, pair.Pending().models.size()) << "The pending snapshot may still be captured into";
+
+		pair.Publish();
+		EXPECT_FALSE(pair.HasRemovals());
+		ASSERT_EQ(1u, pair.Published().models.size());
+		EXPECT_EQ(&b, pair.Published().models[0].key);
+		ASSERT_EQ(1u, pair.Pending().models.size());
+		EXPECT_EQ(&b, pair.Pending().models[0].key);
+	}
+
+	// test that an item captured after a removal survives the publish, as long as its key differs
+	TEST(SnapshotPairTest, SnapshotPairRemoveThenAdd) {
+		int a = 0, b = 0, c = 0;
+		SnapshotTestPair pair;
+		std::vector<std::pair<const int*, float>> states;
+		states.push_back(std::make_pair(&a, 1.0f));
+		states.push_back(std::make_pair(&b, 2.0f));
+		SnapshotTestCapture(pair, states, true, 1.0f);
+		pair.Publish();
+
+		// a goes and c comes in its place before the next capture
+		pair.Remove(&a);
+		states[0] = std::make_pair(&c, 3.0f);
+		SnapshotTestCapture(pair, states, true, 1.0f);
+		EXPECT_TRUE(pair.IsRemoved(&a));
+		EXPECT_FALSE(pair.IsRemoved(&c));
+		pair.Publish();
+		ASSERT_EQ(2u, pair.Published().models.size());
+		EXPECT_EQ(&c, pair.Published().models[0].key);
+		EXPECT_FLOAT_EQ(3.0f, pair.Published().models[0].matrix) << "A new item isn't blended with the one it replaced";
+	}
+}  // namespace
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "SystemScheduler.h"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+	// test which updates conflict
+	TEST(SystemSchedulerTest, SystemAccessConflicts) {
+		Sigma::SystemAccess physics = Sigma::SystemAccess().Writes("GLTransform");
+		Sigma::SystemAccess render = Sigma::SystemAccess().Reads("GLTransform").OnMainThread();
+		Sigma::SystemAccess audio = Sigma::SystemAccess().Reads("GLTransform").Writes("ALSound");
+		EXPECT_TRUE(physics.ConflictsWith(render));
+		EXPECT_TRUE(render.ConflictsWith(physics));
+		EXPECT_FALSE(render.ConflictsWith(audio)) << "Readers can share data";
+		EXPECT_FALSE(Sigma::SystemAccess().ConflictsWith(physics));
+	}
+
+	// test that conflicting updates run in order, main thread updates on the caller, and the rest on workers
+	TEST(SystemSchedulerTest, SystemSchedulerOrder) {
+		Sigma::JobSystem jobs(2);
+		Sigma::SystemScheduler scheduler(jobs);
+		std::atomic<int> step(0);
+		int physics = -1, audio = -1, render = -1;
+		std::thread::id physicsThread, renderThread;
+		scheduler.Add("physics", Sigma::SystemAccess().Writes("GLTransform"), [&] (double) {
+			physicsThread = std::this_thread::get_id();
+			physics = step++;
+		});
+		scheduler.Add("audio", Sigma::SystemAccess().Writes("ALSound"), [&] (double) { audio = step++; });
+		scheduler.Add("render", Sigma::SystemAccess().Reads("GLTransform").OnMainThread(), [&] (double delta) {
+			EXPECT_EQ(0.5, delta);
+			renderThread = std::this_thread::get_id();
+			render = step++;
+		});
+
+		for (int frame = 0; frame < 10; ++frame) {
+			step = 0;
+			physics = audio = render = -1;
+			scheduler.Update(0.5);
+			EXPECT_LT(physics, render) << "Render should wait for physics";
+			EXPECT_NE(-1, audio);
+			EXPECT_EQ(std::this_thread::get_id(), renderThread);
+			EXPECT_NE(std::this_thread::get_id(), physicsThread);
+		}
+		ASSERT_EQ(3u, scheduler.Timings().size());
+		EXPECT_EQ("audio", scheduler.Timings()[1].name);
+		EXPECT_GE(scheduler.FrameTime(), scheduler.Timings()[2].seconds);
+	}
+
+	// test that an exception in an update reaches the caller once the other updates are done
+	TEST(SystemSchedulerTest, SystemSchedulerExceptions) {
+		Sigma::JobSystem jobs(2);
+		Sigma::SystemScheduler scheduler(jobs);
+		bool render = false;
+		scheduler.Add("physics", Sigma::SystemAccess().Writes("GLTransform"), [] (double) { throw std::runtime_error("update failed"); });
+		scheduler.Add("render", Sigma::SystemAccess().Reads("GLTransform").OnMainThread(), [&render] (double) { render = true; });
+		EXPECT_THROW(scheduler.Update(0.0), std::runtime_error);
+		EXPECT_TRUE(render) << "Updates after a failed one should still run";
+		render = false;
+		EXPECT_THROW(scheduler.Update(0.0), std::runtime_error) << "The scheduler should be usable after an exception";
+		EXPECT_TRUE(render);
+	}
+}  // namespace
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "TransformHierarchy.h"
+#include <algorithm>
+
+namespace {
+	using Sigma::TransformHierarchy;
+
+	// test that transforms are placed at their depth, with their ancestors, whatever order they are added in
+	TEST(TransformHierarchyTest, TransformHierarchyDepths) {
+		// 0 and 4 are roots: 0 <- 1 <- 2 <- 3 and 4 <- 5, 6 is not added
+		const uint32_t parents[] = { TransformHierarchy::NONE, 0, 1, 2, TransformHierarchy::NONE, 4, 2 };
+		auto parentOf = [&parents] (uint32_t index) { return parents[index]; };
+
+		TransformHierarchy hierarchy;
+		hierarchy.Clear(7);
+		hierarchy.Add(3, parentOf);
+		hierarchy.Add(5, parentOf);
+		hierarchy.Add(2, parentOf);
+		hierarchy.Add(3, parentOf);
+
+		ASSERT_EQ(4u, hierarchy.Depth());
+		std::vector<uint32_t> roots = hierarchy.Level(0);
+		std::sort(roots.begin(), roots.end());
+		EXPECT_EQ(std::vector<uint32_t>({ 0, 4 }), roots) << "Ancestors are added with their children";
+		std::vector<uint32_t> second = hierarchy.Level(1);
+		std::sort(second.begin(), second.end());
+		EXPECT_EQ(std::vector<uint32_t>({ 1, 5 }), second);
+		EXPECT_EQ(std::vector<uint32_t>({ 2 }), hierarchy.Level(2)) << "A transform is only added once";
+		EXPECT_EQ(std::vector<uint32_t>({ 3 }), hierarchy.Level(3));
+
+		hierarchy.Clear(7);
+		EXPECT_EQ(0u, hierarchy.Depth());
+		hierarchy.Add(6, parentOf);
+		EXPECT_EQ(4u, hierarchy.Depth()) << "Clearing forgets the depths";
+	}
+
+	// test that a cycle of parents ends, and that updates run parents first
+	TEST(TransformHierarchyTest, TransformHierarchyUpdateOrder) {
+		// 0 <- 1 <- 2, and 3 <- 4 <- 3 is a cycle
+		const uint32_t parents[] = { TransformHierarchy::NONE, 0, 1, 4, 3 };
+		auto parentOf = [&parents] (uint32_t index) { return parents[index]; };
+
+		TransformHierarchy hierarchy;
+		hierarchy.Clear(5);
+		for (uint32_t i = 0; i < 5; ++i) {
+			hierarchy.Add(i, parentOf);
+		}
+
+		std::vector<uint32_t> order;
+		hierarchy.Update(nullptr, 1, [&order] (uint32_t index) { order.push_back(index); });
+		ASSERT_EQ(5u, order.size()) << "Every transform is updated once";
+		auto position = [&order] (uint32_t index) { return std::find(order.begin(), order.end(), index) - order.begin(); };
+		EXPECT_LT(position(0), position(1));
+		EXPECT_LT(position(1), position(2));
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "TransformRegistry.h"
+
+namespace {
+	// the registry only compares and returns the pointers, so any address stands in for a transform
+	char transforms[3];
+	Sigma::GLTransform* FakeTransform(int i) { return reinterpret_cast<Sigma::GLTransform*>(&transforms[i]); }
+
+	// test that the first transform registered for an entity is found until it is unregistered
+	TEST(TransformRegistryTest, TransformRegistryLookup) {
+		Sigma::TransformRegistry::Clear();
+		EXPECT_EQ(nullptr, Sigma::TransformRegistry::Get(7));
+
+		EXPECT_TRUE(Sigma::TransformRegistry::Register(7, FakeTransform(0)));
+		EXPECT_FALSE(Sigma::TransformRegistry::Register(7, FakeTransform(1))) << "The first transform registered stays";
+		EXPECT_TRUE(Sigma::TransformRegistry::Register(5000, FakeTransform(2)));
+		EXPECT_EQ(FakeTransform(0), Sigma::TransformRegistry::Get(7));
+		EXPECT_EQ(FakeTransform(2), Sigma::TransformRegistry::Get(5000));
+		EXPECT_EQ(nullptr, Sigma::TransformRegistry::Get(8));
+
+		Sigma::TransformRegistry::Unregister(7, FakeTransform(1));
+		EXPECT_EQ(FakeTransform(0), Sigma::TransformRegistry::Get(7)) << "Only the registered transform unregisters";
+		Sigma::TransformRegistry::Unregister(7, FakeTransform(0));
+		EXPECT_EQ(nullptr, Sigma::TransformRegistry::Get(7));
+		Sigma::TransformRegistry::Clear();
+	}
+
+	// test that an ID from a deleted entity doesn't find the transform of the entity reusing its slot
+	TEST(TransformRegistryTest, TransformRegistryGenerations) {
+		Sigma::TransformRegistry::Clear();
+		Sigma::id_t oldID = Sigma::MakeEntityID(42, 1);
+		Sigma::id_t newID = Sigma::MakeEntityID(42, 2);
+		EXPECT_TRUE(Sigma::TransformRegistry::Register(oldID, FakeTransform(0)));
+		EXPECT_TRUE(Sigma::TransformRegistry::Register(newID, FakeTransform(1))) << "A stale generation is replaced";
+		EXPECT_EQ(nullptr, Sigma::TransformRegistry::Get(oldID));
+		EXPECT_EQ(FakeTransform(1), Sigma::TransformRegistry::Get(newID));
+		Sigma::TransformRegistry::Clear();
+	}
+}  // namespace
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "TransformStore.h"
+#include <cmath>
+#include <memory>
+
+namespace {
+	// test that the SSE kernel composes the same matrices as the scalar one, including the odd slots at the end
+	TEST(TransformStoreTest, TransformStoreComposeSIMD) {
+		std::unique_ptr<Sigma::TransformStore::Page> simd(new Sigma::TransformStore::Page());
+		std::unique_ptr<Sigma::TransformStore::Page> scalar(new Sigma::TransformStore::Page());
+		const size_t count = 23;
+		for (size_t i = 0; i < count; ++i) {
+			float x = std::sin(i * 0.7f), y = std::cos(i * 1.3f), z = std::sin(i * 2.1f), w = 1.0f + i * 0.1f;
+			float length = std::sqrt(x * x + y * y + z * z + w * w);
+			simd->qx[i] = x / length;
+			simd->qy[i] = y / length;
+			simd->qz[i] = z / length;
+			simd->qw[i] = w / length;
+			simd->px[i] = i * 1.0f;
+			simd->py[i] = i * -2.0f;
+			simd->pz[i] = i * 0.5f;
+			simd->sx[i] = 1.0f + i;
+			simd->sy[i] = 2.0f;
+			simd->sz[i] = 0.5f;
+			simd->flags[i] = (i % 5 == 3) ? 0 : Sigma::TransformStore::LOCAL_DIRTY;
+		}
+		simd->qx[0] = simd->qy[0] = simd->qz[0] = 0.0f;
+		simd->qw[0] = 1.0f;
+		*scalar = *simd;
+
+		Sigma::TransformStore::ComposeLocal(*simd, 0, count, true);
+		Sigma::TransformStore::ComposeLocal(*scalar, 0, count, false);
+		for (size_t i = 0; i < count; ++i) {
+			for (int e = 0; e < 16; ++e) {
+				EXPECT_NEAR(scalar->local[i][e], simd->local[i][e], 1e-5f) << "slot " << i << " element " << e;
+			}
+			EXPECT_EQ(scalar->flags[i], simd->flags[i]);
+		}
+		EXPECT_EQ(0.0f, simd->local[3][15]) << "Clean slots shouldn't be composed";
+		EXPECT_EQ(1.0f, simd->local[4][15]);
+
+		// the identity orientation with a translation and scale
+		const float* m = scalar->local[0];
+		EXPECT_FLOAT_EQ(1.0f, m[0]);
+		EXPECT_FLOAT_EQ(2.0f, m[5]);
+		EXPECT_FLOAT_EQ(0.5f, m[10]);
+		EXPECT_FLOAT_EQ(0.0f, m[12]);
+		EXPECT_FLOAT_EQ(1.0f, m[15]);
+	}
+
+	// test that children follow their parents, whatever order their slots are in
+	TEST(TransformStoreTest, TransformStoreHierarchy) {
+		Sigma::TransformStore store;
+		Sigma::TransformStore::Handle child = store.Create();
+		Sigma::TransformStore::Handle parent = store.Create();
+		store.SetParent(child, parent);
+		store.SetPosition(parent, 10.0f, 0.0f, 0.0f);
+		store.SetScale(parent, 2.0f, 2.0f, 2.0f);
+		store.SetPosition(child, 1.0f, 2.0f, 3.0f);
+
+		store.Update(nullptr);
+		const float* world = store.PageOf(child).world[Sigma::TransformStore::Slot(child)];
+		EXPECT_FLOAT_EQ(12.0f, world[12]);
+		EXPECT_FLOAT_EQ(4.0f, world[13]);
+		EXPECT_FLOAT_EQ(6.0f, world[14]);
+
+		store.SetPosition(parent, 0.0f, 0.0f, 0.0f);
+		EXPECT_FLOAT_EQ(2.0f, store.GetWorldMatrix(child)[12]) << "Reading a child updates its parent first";
+
+		// a quarter turn about y
+		store.SetOrientation(parent, 0.0f, std::sqrt(0.5f), 0.0f, std::sqrt(0.5f));
+		store.Update(nullptr);
+		EXPECT_NEAR(6.0f, world[12], 1e-5f);
+		EXPECT_NEAR(-2.0f, world[14], 1e-5f);
+	}
+
+	// test that destroyed handles are invalid even once their slot is reused, and orphans become roots
+	TEST(TransformStoreTest, TransformStoreHandles) {
+		Sigma::TransformStore store;
+		Sigma::TransformStore::Handle parent = store.Create();
+		Sigma::TransformStore::Handle child = store.Create();
+		store.SetParent(child, parent);
+		store.SetPosition(parent, 5.0f, 0.0f, 0.0f);
+		EXPECT_FLOAT_EQ(5.0f, store.GetWorldMatrix(child)[12]);
+		EXPECT_EQ(2u, store.Size());
+
+		store.Destroy(parent);
+		EXPECT_FALSE(store.Valid(parent));
+		EXPECT_EQ(1u, store.Size());
+		Sigma::TransformStore::Handle reused = store.Create();
+		EXPECT_NE(parent, reused);
+		EXPECT_EQ(Sigma::TransformStore::Slot(parent), Sigma::TransformStore::Slot(reused));
+		EXPECT_TRUE(store.Valid(reused));
+		EXPECT_FALSE(store.Valid(parent));
+		EXPECT_FALSE(store.Valid(Sigma::TransformStore::NONE));
+
+		store.SetPosition(reused, 7.0f, 0.0f, 0.0f);
+		store.Update(nullptr);
+		EXPECT_FLOAT_EQ(0.0f, store.GetWorldMatrix(child)[12]) << "The new transform in the slot isn't the child's parent";
+	}
+}  // namespace